@@ -6,12 +6,28 @@
  * providing HTTP communication capabilities using the WinHTTP API.
  */
 
+// winsock2.h must precede windows.h, which Network.hpp includes; WINHTTP_CONNECTION_INFO needs it
+#include <winsock2.h>
+
 #include "Network.hpp"
+#include "NetworkBudget.hpp"
+#include "NetworkCoalescing.hpp"
+#include "NetworkHar.hpp"
+#include "NetworkLimiter.hpp"
+#include "NetworkLoadBalancer.hpp"
+#include "NetworkMetrics.hpp"
+#include "NetworkProxy.hpp"
+#include "NetworkReplay.hpp"
+#include "NetworkScheduler.hpp"
+#include "NetworkTimer.hpp"
+#include "NetworkTracing.hpp"
+#include "NetworkUnixSocket.hpp"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
 #include <winhttp.h>
+#include <wincrypt.h>
 #include <mutex>
 #include <map>
 #include <string>
@@ -20,23 +36,395 @@
 #include <chrono>
 
 #pragma comment(lib, "winhttp.lib")
+#pragma comment(lib, "crypt32.lib")
 
 // Define HTTP/2 flag if not available in older Windows SDK
 #ifndef WINHTTP_FLAG_HTTP2
 #define WINHTTP_FLAG_HTTP2 0x00000020
 #endif
 
+// HTTP/2 negotiation and trailers, for SDKs that predate them
+#ifndef WINHTTP_OPTION_ENABLE_HTTP_PROTOCOL
+#define WINHTTP_OPTION_ENABLE_HTTP_PROTOCOL 133
+#endif
+#ifndef WINHTTP_PROTOCOL_FLAG_HTTP2
+#define WINHTTP_PROTOCOL_FLAG_HTTP2 0x1
+#endif
+#ifndef WINHTTP_QUERY_FLAG_TRAILERS
+#define WINHTTP_QUERY_FLAG_TRAILERS 0x02000000
+#endif
+#ifndef WINHTTP_OPTION_HTTP_PROTOCOL_USED
+#define WINHTTP_OPTION_HTTP_PROTOCOL_USED 134
+#endif
+
 // Define TLS 1.2 flag if not available
 #ifndef WINHTTP_FLAG_SECURE_PROTOCOL_TLS1_2
 #define WINHTTP_FLAG_SECURE_PROTOCOL_TLS1_2 0x00000800
 #endif
 
+// Response memory reserved at admission, and the step the reservation grows by while reading
+static const size_t kResponseReservation = 64 * 1024;
+
+// Largest body preallocated from Content-Length; a longer body grows as it arrives, so a
+// server announcing an absurd length cannot make the reservation itself throw
+static const size_t kMaxBodyPreallocation = 16 * 1024 * 1024;
+
+// Streamed request bodies are sent in chunks of this size, which is also all they reserve of the budget
+static const size_t kUploadChunkSize = 64 * 1024;
+
+// Largest response head (or chunk-size line) accepted over a Unix socket
+static const size_t kMaxResponseHead = 64 * 1024;
+
 // Initialize static members
 HINTERNET Network::hSession = NULL;
 std::mutex Network::sessionMutex;
-std::mutex Network::requestMutex;
 std::mutex Network::rateLimitMutex;
 std::map<std::string, Network::RateLimitInfo> Network::rateLimitMap;
+std::mutex Network::certificateCacheMutex;
+std::map<std::string, Network::CertificateCacheEntry> Network::certificateCache;
+
+// Verified certificates are re-checked at least this often, so OCSP answers
+// (which carry no nextUpdate we can read back) do not go stale
+static const std::chrono::hours kCertificateCacheTtl(1);
+static const size_t kMaxCertificateCacheEntries = 256;
+
+std::map<std::string, Network::RedirectCacheEntry> Network::redirectCache;
+std::list<std::string> Network::redirectCacheOrder;
+std::mutex Network::redirectCacheMutex;
+std::list<std::string> Network::credentialHeaders;
+std::mutex Network::credentialHeadersMutex;
+
+static const char* const kCredentialHeaders[] = {
+    "Authorization", "Proxy-Authorization", "Cookie", "Set-Cookie", "X-API-Key", "Api-Key", "X-Auth-Token"
+};
+
+// Permanent redirects without a Cache-Control max-age are kept this long
+static const std::chrono::hours kRedirectCacheTtl(24);
+static const size_t kMaxRedirectCacheEntries = 256;
+
+// Redirect bodies up to this size are drained so their connection stays reusable; larger ones close it
+static const size_t kMaxRedirectDrain = 64 * 1024;
+
+/**
+ * @brief Converts a FILETIME to a system_clock time point
+ */
+static std::chrono::system_clock::time_point FileTimeToTimePoint(const FILETIME& fileTime) {
+    const ULONGLONG epochOffset = 116444736000000000ULL;  // 1601-01-01 to 1970-01-01 in 100ns ticks
+    ULONGLONG ticks = (static_cast<ULONGLONG>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime;
+    if (ticks <= epochOffset) {
+        return std::chrono::system_clock::time_point();
+    }
+    auto sinceEpoch = std::chrono::microseconds((ticks - epochOffset) / 10);
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceEpoch));
+}
+
+/**
+ * @brief Per-request state passed to WinHTTP as the request context
+ */
+struct Network::RequestContext {
+    NetworkResponse& response;                                  ///< Response being filled in
+    NetworkBudget::Reservation budget;                          ///< Memory held against the in-flight budget
+    uint64_t requestBytes = 0;                                  ///< Request body size; streamed bodies count what was sent
+    bool misdirected = false;                                   ///< A coalesced attempt was refused; resend on the host's own connection
+    bool followRedirects = false;                               ///< Perform will follow a redirect response, so its body is drained
+    std::string verifyHost;                                     ///< Host the server certificate must be valid for
+    int verifyPort = 0;                                         ///< Port of verifyHost
+    bool verifyCoalesced = false;                               ///< Connected as another host's origin; the connection must also serve verifyHost
+    bool verifyRevocation = false;                              ///< Verify the certificate, revocation included, before anything is sent
+    bool connectionVerified = false;                            ///< The current connection passed VerifyConnection
+    bool requestClosed = false;                                 ///< VerifyConnection failed and RecordPhase closed the request handle
+    std::string verifyError;                                    ///< Why VerifyConnection failed
+#if NETWORK_ENABLE_TRACING
+    TraceHook* traceHook = nullptr;                             ///< Installed hook, if any
+    RequestTrace trace;                                         ///< Hook state for this request
+#endif
+
+    explicit RequestContext(NetworkResponse& target) : response(target) {}
+
+    /**
+     * @brief Reports a phase boundary to the trace hook
+     */
+    void Trace(TracePhase phase, std::chrono::steady_clock::time_point at) {
+#if NETWORK_ENABLE_TRACING
+        if (traceHook) {
+            traceHook->OnPhase(trace, phase, at);
+        }
+#else
+        (void)phase;
+        (void)at;
+#endif
+    }
+};
+
+/**
+ * @brief WinHTTP status callback that stamps request phases
+ *
+ * The session is synchronous, so WinHTTP invokes this on the requesting thread.
+ * The context value is the RequestContext of the request being sent; each
+ * notification costs one clock read.
+ *
+ * SENDING_REQUEST arrives once the connection (and its TLS handshake) is up but
+ * before the request line is written, so the connection is verified there, once
+ * per connection. A connection that fails is never written to: the request
+ * handle is closed, which makes the pending WinHTTP call fail.
+ */
+void CALLBACK Network::RecordPhase(HINTERNET hInternet, DWORD_PTR contextValue, DWORD status, LPVOID, DWORD) {
+    // Pooled connections outlive their requests, so count them regardless of context
+    if (status == WINHTTP_CALLBACK_STATUS_CONNECTED_TO_SERVER) {
+        NetworkMetrics::ConnectionOpened();
+    }
+    else if (status == WINHTTP_CALLBACK_STATUS_CONNECTION_CLOSED) {
+        NetworkMetrics::ConnectionClosed();
+    }
+
+    auto* context = reinterpret_cast<RequestContext*>(contextValue);
+    if (!context) {
+        return;
+    }
+
+    auto& timings = context->response.timings;
+    auto now = std::chrono::steady_clock::now();
+    switch (status) {
+        case WINHTTP_CALLBACK_STATUS_RESOLVING_NAME:
+            timings.dns_start = now;
+            context->Trace(TracePhase::DnsStart, now);
+            break;
+        case WINHTTP_CALLBACK_STATUS_NAME_RESOLVED:
+            timings.dns_end = now;
+            context->Trace(TracePhase::DnsEnd, now);
+            break;
+        case WINHTTP_CALLBACK_STATUS_CONNECTING_TO_SERVER:
+            timings.connect_start = now;
+            context->Trace(TracePhase::ConnectStart, now);
+            break;
+        case WINHTTP_CALLBACK_STATUS_CONNECTED_TO_SERVER:
+            timings.connect_end = now;
+            context->Trace(TracePhase::ConnectEnd, now);
+            context->connectionVerified = false;
+            break;
+        case WINHTTP_CALLBACK_STATUS_SENDING_REQUEST:
+            if (!context->connectionVerified) {
+                if (!VerifyConnection(hInternet, *context)) {
+                    context->requestClosed = true;
+                    WinHttpCloseHandle(hInternet);
+                    return;
+                }
+                context->connectionVerified = true;
+            }
+            // Streamed bodies send in several writes; the phase starts with the first
+            if (timings.send_start == std::chrono::steady_clock::time_point()) {
+                timings.send_start = now;
+                context->Trace(TracePhase::SendStart, now);
+            }
+            break;
+        case WINHTTP_CALLBACK_STATUS_REQUEST_SENT:
+            timings.request_sent = now;
+            break;
+        case WINHTTP_CALLBACK_STATUS_RESPONSE_RECEIVED:
+            if (timings.first_byte == std::chrono::steady_clock::time_point()) {
+                timings.first_byte = now;
+                context->Trace(TracePhase::FirstByte, now);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static bool EqualsIgnoreCase(const std::string& a, const std::string& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+/**
+ * @brief Case-insensitive header lookup
+ */
+static std::string HeaderValue(const std::map<std::string, std::string>& headers, const std::string& name) {
+    for (const auto& [key, value] : headers) {
+        if (EqualsIgnoreCase(key, name)) {
+            return value;
+        }
+    }
+    return std::string();
+}
+
+static bool IsRedirectStatus(int statusCode) {
+    return statusCode == 301 || statusCode == 302 || statusCode == 303 || statusCode == 307 || statusCode == 308;
+}
+
+/**
+ * @brief Whether a response is a redirect Perform is going to follow
+ */
+static bool WillFollowRedirect(const Network::NetworkResponse& response, bool followRedirects) {
+    return followRedirects && IsRedirectStatus(response.status_code) && !HeaderValue(response.headers, "Location").empty();
+}
+
+/**
+ * @brief Applies "." and ".." segments of a path (RFC 3986 section 5.2.4)
+ */
+static std::string RemoveDotSegments(const std::string& path) {
+    std::vector<std::string> segments;
+    size_t start = 1;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        std::string segment = path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        bool last = end == std::string::npos;
+        if (segment == "..") {
+            if (!segments.empty()) {
+                segments.pop_back();
+            }
+            if (last) {
+                segments.push_back("");
+            }
+        }
+        else if (segment == ".") {
+            if (last) {
+                segments.push_back("");
+            }
+        }
+        else {
+            segments.push_back(segment);
+        }
+        start = last ? path.size() + 1 : end + 1;
+    }
+    std::string result;
+    for (const auto& segment : segments) {
+        result += "/" + segment;
+    }
+    return result.empty() ? "/" : result;
+}
+
+/**
+ * @brief Resolves a Location header against the URL that returned it
+ *
+ * Absolute, scheme-relative, absolute-path and relative references are
+ * accepted; the fragment is dropped. Absolute locations must be http or
+ * https, so a server cannot redirect a request onto a local Unix socket.
+ *
+ * @return The absolute URL, or an empty string if there is none to follow
+ */
+static std::string ResolveLocation(const std::string& base, std::string location) {
+    while (!location.empty() && std::isspace(static_cast<unsigned char>(location.back()))) {
+        location.pop_back();
+    }
+    location.erase(0, location.find_first_not_of(" \t"));
+    size_t fragment = location.find('#');
+    if (fragment != std::string::npos) {
+        location.erase(fragment);
+    }
+    if (location.empty()) {
+        return std::string();
+    }
+
+    size_t schemeEnd = location.find("://");
+    if (schemeEnd != std::string::npos && schemeEnd < location.find_first_of("/?")) {
+        std::string scheme = location.substr(0, schemeEnd);
+        std::transform(scheme.begin(), scheme.end(), scheme.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (scheme != "http" && scheme != "https") {
+            return std::string();
+        }
+        return scheme + location.substr(schemeEnd);
+    }
+
+    size_t authorityStart = base.find("://");
+    if (authorityStart == std::string::npos) {
+        return std::string();
+    }
+    std::string protocol = base.substr(0, authorityStart);
+    if (location.compare(0, 2, "//") == 0) {
+        return protocol == "http" || protocol == "https" ? protocol + ":" + location : std::string();
+    }
+
+    size_t pathStart = base.find('/', authorityStart + 3);
+    std::string origin = base.substr(0, pathStart);
+    std::string basePath = pathStart == std::string::npos ? "/" : base.substr(pathStart);
+    basePath.erase(std::min(basePath.find('?'), basePath.size()));
+    if (location[0] == '?') {
+        return origin + basePath + location;
+    }
+
+    std::string query;
+    size_t queryStart = location.find('?');
+    if (queryStart != std::string::npos) {
+        query = location.substr(queryStart);
+        location.erase(queryStart);
+    }
+    std::string path = location[0] == '/' ? location : basePath.substr(0, basePath.rfind('/') + 1) + location;
+    return origin + RemoveDotSegments(path) + query;
+}
+
+/**
+ * @brief Reads and drops a small response body, so WinHTTP can pool the connection
+ * @return false if the body could not be read to the end (a read failed, or it is larger
+ *         than kMaxRedirectDrain); closing the handle then closes the connection too
+ */
+static bool DrainResponseBody(HINTERNET hRequest) {
+    char buffer[4096];
+    size_t drained = 0;
+    while (drained < kMaxRedirectDrain) {
+        DWORD bytesAvailable = 0;
+        if (!WinHttpQueryDataAvailable(hRequest, &bytesAvailable)) {
+            return false;
+        }
+        if (bytesAvailable == 0) {
+            return true;
+        }
+        DWORD bytesRead = 0;
+        if (!WinHttpReadData(hRequest, buffer, std::min<DWORD>(bytesAvailable, sizeof(buffer)), &bytesRead) || bytesRead == 0) {
+            return false;
+        }
+        drained += bytesRead;
+    }
+    return false;
+}
+
+/**
+ * @brief Case-insensitive header lookup, lowercased
+ */
+static std::string LowercaseHeader(const std::map<std::string, std::string>& headers, const std::string& name) {
+    std::string lower = HeaderValue(headers, name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lower;
+}
+
+/**
+ * @brief Parses a chunk-size line: hex digits, optionally followed by chunk extensions
+ * @return false unless the line starts with at least one hex digit and the size fits in 64 bits
+ */
+static bool ParseChunkSize(const std::string& line, uint64_t& size) {
+    size = 0;
+    size_t digits = 0;
+    for (; digits < line.size() && std::isxdigit(static_cast<unsigned char>(line[digits])); digits++) {
+        if (size > (UINT64_MAX >> 4)) {
+            return false;
+        }
+        char c = static_cast<char>(std::tolower(static_cast<unsigned char>(line[digits])));
+        size = (size << 4) | static_cast<uint64_t>(c <= '9' ? c - '0' : c - 'a' + 10);
+    }
+    size_t rest = line.find_first_not_of(" \t", digits);
+    return digits > 0 && (rest == std::string::npos || line[rest] == ';');
+}
+
+/**
+ * @brief Parses a Content-Length value: decimal digits only, surrounding whitespace aside
+ * @return false if the value is empty, not a number or does not fit in 64 bits
+ */
+static bool ParseContentLength(const std::string& value, uint64_t& length) {
+    length = 0;
+    size_t first = value.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return false;
+    }
+    for (char c : value.substr(first, value.find_last_not_of(" \t") - first + 1)) {
+        if (c < '0' || c > '9' || length > (UINT64_MAX - 9) / 10) {
+            return false;
+        }
+        length = length * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return true;
+}
 
 /**
  * @brief Initializes the WinHTTP API
@@ -58,7 +446,7 @@ bool Network::Initialize() {
         WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
         WINHTTP_NO_PROXY_NAME,
         WINHTTP_NO_PROXY_BYPASS,
-        WINHTTP_FLAG_ASYNC  // Enable async for connection pooling
+        0  // Synchronous; connection pooling is per session either way
     );
 
     if (!hSession) {
@@ -79,6 +467,18 @@ bool Network::Initialize() {
 
     WinHttpSetTimeouts(hSession, resolveTimeout, connectTimeout, sendTimeout, receiveTimeout);
 
+    // Stamp request phases for NetworkResponse::timings
+    WinHttpSetStatusCallback(
+        hSession,
+        RecordPhase,
+        WINHTTP_CALLBACK_FLAG_RESOLVE_NAME |
+        WINHTTP_CALLBACK_FLAG_CONNECT_TO_SERVER |
+        WINHTTP_CALLBACK_FLAG_SEND_REQUEST |
+        WINHTTP_CALLBACK_FLAG_RECEIVE_RESPONSE |
+        WINHTTP_CALLBACK_FLAG_CLOSE_CONNECTION,
+        0
+    );
+
     return true;
 }
 
@@ -88,6 +488,10 @@ bool Network::Initialize() {
  * This method closes the WinHTTP handle and sets it to NULL.
  */
 void Network::Cleanup() {
+    // Stop background work (health probes) before the session goes away
+    NetworkTimer::Shutdown();
+    NetworkUnixSocket::CloseIdle();
+
     std::lock_guard<std::mutex> lock(sessionMutex);
     
     if (hSession) {
@@ -143,6 +547,280 @@ bool Network::ApplyRateLimit(const std::string& host, int rateLimit) {
     return true;
 }
 
+/**
+ * @brief Clears the verified certificate cache
+ */
+void Network::ClearCertificateCache() {
+    std::lock_guard<std::mutex> lock(certificateCacheMutex);
+    certificateCache.clear();
+}
+
+/**
+ * @brief Clears the permanent redirect cache
+ */
+void Network::ClearRedirectCache() {
+    std::lock_guard<std::mutex> lock(redirectCacheMutex);
+    redirectCache.clear();
+    redirectCacheOrder.clear();
+}
+
+void Network::AddCredentialHeader(const std::string& name) {
+    std::lock_guard<std::mutex> lock(credentialHeadersMutex);
+    bool known = std::any_of(credentialHeaders.begin(), credentialHeaders.end(),
+                             [&name](const std::string& header) { return EqualsIgnoreCase(header, name); });
+    if (!known && !name.empty()) {
+        credentialHeaders.push_back(name);
+    }
+}
+
+bool Network::IsCredentialHeader(const std::string& name, const std::string& value, const RequestConfig& config) {
+    if (std::any_of(std::begin(kCredentialHeaders), std::end(kCredentialHeaders),
+                    [&name](const char* header) { return EqualsIgnoreCase(name, header); }) ||
+        (!config.api_key.empty() && value.find(config.api_key) != std::string::npos) ||
+        (!config.oauth_token.empty() && value.find(config.oauth_token) != std::string::npos)) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(credentialHeadersMutex);
+    return std::any_of(credentialHeaders.begin(), credentialHeaders.end(),
+                       [&name](const std::string& header) { return EqualsIgnoreCase(name, header); });
+}
+
+bool Network::LookupRedirect(const std::string& url, std::string& location, int& statusCode) {
+    std::lock_guard<std::mutex> lock(redirectCacheMutex);
+    auto it = redirectCache.find(url);
+    if (it == redirectCache.end()) {
+        return false;
+    }
+    if (it->second.expires <= std::chrono::steady_clock::now()) {
+        redirectCacheOrder.erase(it->second.order);
+        redirectCache.erase(it);
+        return false;
+    }
+    redirectCacheOrder.splice(redirectCacheOrder.begin(), redirectCacheOrder, it->second.order);
+    location = it->second.location;
+    statusCode = it->second.status_code;
+    return true;
+}
+
+/**
+ * @brief Caches a 301/308 for the time its Cache-Control allows
+ *
+ * Permanent redirects are cacheable by default (RFC 9111 section 4.2.2);
+ * no-store and no-cache keep them out, and max-age bounds their lifetime.
+ * The least recently used entry makes room once the cache is full.
+ */
+void Network::CacheRedirect(const std::string& url, const std::string& location, int statusCode,
+                            const std::map<std::string, std::string>& headers) {
+    auto ttl = std::chrono::duration_cast<std::chrono::seconds>(kRedirectCacheTtl);
+    std::string cacheControl = LowercaseHeader(headers, "Cache-Control");
+    if (cacheControl.find("no-store") != std::string::npos || cacheControl.find("no-cache") != std::string::npos) {
+        return;
+    }
+    size_t maxAge = cacheControl.find("max-age=");
+    if (maxAge != std::string::npos) {
+        ttl = std::min(ttl, std::chrono::seconds(std::strtoll(cacheControl.c_str() + maxAge + 8, nullptr, 10)));
+        if (ttl.count() <= 0) {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(redirectCacheMutex);
+    auto it = redirectCache.find(url);
+    if (it == redirectCache.end()) {
+        if (redirectCache.size() >= kMaxRedirectCacheEntries) {
+            redirectCache.erase(redirectCacheOrder.back());
+            redirectCacheOrder.pop_back();
+        }
+        redirectCacheOrder.push_front(url);
+        it = redirectCache.emplace(url, RedirectCacheEntry()).first;
+        it->second.order = redirectCacheOrder.begin();
+    }
+    else {
+        redirectCacheOrder.splice(redirectCacheOrder.begin(), redirectCacheOrder, it->second.order);
+    }
+    it->second.location = location;
+    it->second.status_code = statusCode;
+    it->second.expires = std::chrono::steady_clock::now() + ttl;
+}
+
+/**
+ * @brief DNS names in the subjectAltName of a request's server certificate
+ */
+static std::vector<std::string> CertificateNames(HINTERNET hRequest) {
+    std::vector<std::string> names;
+    PCCERT_CONTEXT cert = nullptr;
+    DWORD certSize = sizeof(cert);
+    if (!WinHttpQueryOption(hRequest, WINHTTP_OPTION_SERVER_CERT_CONTEXT, &cert, &certSize) || !cert) {
+        return names;
+    }
+
+    PCERT_EXTENSION extension = CertFindExtension(szOID_SUBJECT_ALT_NAME2,
+                                                  cert->pCertInfo->cExtension, cert->pCertInfo->rgExtension);
+    PCERT_ALT_NAME_INFO altNames = nullptr;
+    DWORD altNamesSize = 0;
+    if (extension && CryptDecodeObjectEx(X509_ASN_ENCODING, X509_ALTERNATE_NAME,
+                                         extension->Value.pbData, extension->Value.cbData,
+                                         CRYPT_DECODE_ALLOC_FLAG, NULL, &altNames, &altNamesSize)) {
+        for (DWORD i = 0; i < altNames->cAltEntry; i++) {
+            if (altNames->rgAltEntry[i].dwAltNameChoice != CERT_ALT_NAME_DNS_NAME) {
+                continue;
+            }
+            std::string name;
+            for (const wchar_t* c = altNames->rgAltEntry[i].pwszDNSName; *c; c++) {
+                name += static_cast<char>(*c);  // DNS names are ASCII (IDNs appear as A-labels)
+            }
+            names.push_back(name);
+        }
+        LocalFree(altNames);
+    }
+    CertFreeCertificateContext(cert);
+    return names;
+}
+
+/**
+ * @brief Verifies the server certificate of a request, including revocation
+ *
+ * WinHTTP validates the chain on every handshake but only checks revocation when
+ * asked to, and then it rebuilds the chain and refetches CRL/OCSP data per connection.
+ * This method runs the revocation-checking chain build once per (host, leaf certificate)
+ * and caches the result until the certificate expires, the CRL's nextUpdate passes
+ * or the cache TTL elapses, whichever comes first.
+ *
+ * @param hRequest Request handle whose TLS handshake has completed
+ * @param host Host name the certificate must be valid for
+ * @param error Output error message if verification fails
+ * @return true if the certificate is valid, false otherwise
+ */
+bool Network::VerifyServerCertificate(HINTERNET hRequest, const std::string& host, std::string& error) {
+    PCCERT_CONTEXT cert = nullptr;
+    DWORD certSize = sizeof(cert);
+    if (!WinHttpQueryOption(hRequest, WINHTTP_OPTION_SERVER_CERT_CONTEXT, &cert, &certSize) || !cert) {
+        error = "Failed to read server certificate";
+        return false;
+    }
+
+    BYTE hash[32];
+    DWORD hashSize = sizeof(hash);
+    if (!CertGetCertificateContextProperty(cert, CERT_SHA256_HASH_PROP_ID, hash, &hashSize)) {
+        CertFreeCertificateContext(cert);
+        error = "Failed to fingerprint server certificate";
+        return false;
+    }
+
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string key = host + "|";
+    for (DWORD i = 0; i < hashSize; i++) {
+        key += hexDigits[hash[i] >> 4];
+        key += hexDigits[hash[i] & 0x0f];
+    }
+
+    auto now = std::chrono::system_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(certificateCacheMutex);
+        auto it = certificateCache.find(key);
+        if (it != certificateCache.end() && it->second.expires > now) {
+            CertFreeCertificateContext(cert);
+            return true;  // Verified recently, skip path building
+        }
+    }
+
+    // Build the chain with revocation checking
+    CERT_CHAIN_PARA chainPara = {};
+    chainPara.cbSize = sizeof(chainPara);
+    PCCERT_CHAIN_CONTEXT chain = nullptr;
+    if (!CertGetCertificateChain(NULL, cert, NULL, cert->hCertStore, &chainPara,
+            CERT_CHAIN_REVOCATION_CHECK_CHAIN_EXCLUDE_ROOT, NULL, &chain)) {
+        CertFreeCertificateContext(cert);
+        error = "Failed to build certificate chain";
+        return false;
+    }
+
+    std::wstring whost(host.begin(), host.end());
+    SSL_EXTRA_CERT_CHAIN_POLICY_PARA sslPara = {};
+    sslPara.cbSize = sizeof(sslPara);
+    sslPara.dwAuthType = AUTHTYPE_SERVER;
+    sslPara.pwszServerName = &whost[0];
+
+    CERT_CHAIN_POLICY_PARA policyPara = {};
+    policyPara.cbSize = sizeof(policyPara);
+    policyPara.pvExtraPolicyPara = &sslPara;
+
+    CERT_CHAIN_POLICY_STATUS policyStatus = {};
+    policyStatus.cbSize = sizeof(policyStatus);
+
+    bool valid = CertVerifyCertificateChainPolicy(CERT_CHAIN_POLICY_SSL, chain, &policyPara, &policyStatus)
+        && policyStatus.dwError == 0;
+
+    if (!valid) {
+        char errorMsg[256];
+        sprintf_s(errorMsg, "Certificate verification failed with error code: 0x%08lx", policyStatus.dwError);
+        error = errorMsg;
+    }
+    else {
+        // Expire with the certificate or the earliest CRL in the chain
+        auto expires = std::min(now + kCertificateCacheTtl, FileTimeToTimePoint(cert->pCertInfo->NotAfter));
+        if (chain->cChain > 0) {
+            PCERT_SIMPLE_CHAIN simpleChain = chain->rgpChain[0];
+            for (DWORD i = 0; i < simpleChain->cElement; i++) {
+                PCERT_REVOCATION_INFO revocation = simpleChain->rgpElement[i]->pRevocationInfo;
+                if (revocation && revocation->pCrlInfo && revocation->pCrlInfo->pBaseCrlContext) {
+                    const FILETIME& nextUpdate = revocation->pCrlInfo->pBaseCrlContext->pCrlInfo->NextUpdate;
+                    if (nextUpdate.dwHighDateTime || nextUpdate.dwLowDateTime) {
+                        expires = std::min(expires, FileTimeToTimePoint(nextUpdate));
+                    }
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(certificateCacheMutex);
+        if (certificateCache.size() >= kMaxCertificateCacheEntries) {
+            for (auto it = certificateCache.begin(); it != certificateCache.end();) {
+                it = (it->second.expires <= now) ? certificateCache.erase(it) : std::next(it);
+            }
+            if (certificateCache.size() >= kMaxCertificateCacheEntries) {
+                certificateCache.erase(certificateCache.begin());
+            }
+        }
+        certificateCache[key] = { expires };
+    }
+
+    CertFreeCertificateChain(chain);
+    CertFreeCertificateContext(cert);
+    return valid;
+}
+
+/**
+ * @brief Verifies a request's connection before the request is written to it
+ *
+ * Called from RecordPhase on SENDING_REQUEST, so that a server that fails
+ * never sees the request headers, credentials or body.
+ *
+ * @param hRequest Request handle whose connection is established
+ * @param context The request context naming the checks to run
+ * @return true if the request may be sent; otherwise context.verifyError says why
+ */
+bool Network::VerifyConnection(HINTERNET hRequest, RequestContext& context) {
+    // RFC 9113 section 9.1.1: WinHTTP may have picked another pooled connection or opened a
+    // new one, so check the peer address as well as the certificate of the one it picked
+    if (context.verifyCoalesced) {
+        WINHTTP_CONNECTION_INFO info = {};
+        info.cbSize = sizeof(info);
+        DWORD infoSize = sizeof(info);
+        if (!WinHttpQueryOption(hRequest, WINHTTP_OPTION_CONNECTION_INFO, &info, &infoSize) ||
+            !NetworkCoalescing::Admits(context.verifyHost, context.verifyPort,
+                                       reinterpret_cast<const sockaddr*>(&info.RemoteAddress), CertificateNames(hRequest))) {
+            NetworkCoalescing::Forget(context.verifyHost, context.verifyPort);
+            context.misdirected = true;
+            context.verifyError = "Coalesced connection does not serve host: " + context.verifyHost;
+            return false;
+        }
+    }
+    if (context.verifyRevocation && !VerifyServerCertificate(hRequest, context.verifyHost, context.verifyError)) {
+        return false;
+    }
+    return true;
+}
+
 /**
  * @brief Sends an HTTP request
  * 
@@ -161,41 +839,393 @@ Network::NetworkResponse Network::Request(
     const std::optional<std::string>& payload,
     const RequestConfig& config
 ) {
-    std::lock_guard<std::mutex> lock(requestMutex);
+    return Perform(method, url, payload, nullptr, config);
+}
+
+/**
+ * @brief Sends an HTTP request with a streamed body
+ *
+ * The body is pulled from the source in chunks while the request is sent, so
+ * uploads of any size hold only one chunk in memory and against the budget.
+ *
+ * @param method The HTTP method to use (e.g. POST, PUT)
+ * @param url The URL to send the request to
+ * @param body The source of the request body
+ * @param config The request configuration
+ * @return The response from the server
+ */
+Network::NetworkResponse Network::Request(
+    Method method,
+    const std::string& url,
+    BodySource& body,
+    const RequestConfig& config
+) {
+    return Perform(method, url, std::nullopt, &body, config);
+}
+
+/**
+ * @brief Runs a request through scheduling, admission, routing and sending
+ *
+ * Redirects are followed here rather than by WinHTTP: each hop is routed,
+ * limited and recorded like a request of its own, and hops answered by the
+ * permanent redirect cache skip the server altogether. The memory
+ * reservation is held across the whole chain. The scheduling slot is taken
+ * per hop, once the hop has passed admission and the adaptive limiter, so a
+ * request waiting on a throttled host never holds a slot that requests to
+ * other hosts could use.
+ *
+ * @param method The HTTP method to use
+ * @param url The URL to send the request to
+ * @param payload The in-memory payload (optional)
+ * @param body The streamed body (optional, exclusive with payload)
+ * @param config The request configuration
+ * @return The response from the server
+ */
+Network::NetworkResponse Network::Perform(
+    Method method,
+    const std::string& url,
+    const std::optional<std::string>& payload,
+    BodySource* body,
+    const RequestConfig& config
+) {
+    auto start = std::chrono::steady_clock::now();
+    NetworkMetrics::InFlight inFlight;
     NetworkResponse response;
+    response.timings.start = start;
     
     // Parse URL
     std::string protocol, host, path;
     int port;
+    RequestContext context(response);
+    context.requestBytes = payload ? payload->size() : (body ? body->Size().value_or(0) : 0);
+    const RequestConfig* effectiveConfig = &config;
+
+#if NETWORK_ENABLE_TRACING
+    // Hooks may add propagation headers, so they work on a copy of the config
+    std::shared_ptr<TraceHook> traceHook = NetworkTracing::GetHook();
+    RequestConfig tracedConfig;
+    if (traceHook) {
+        tracedConfig = config;
+        context.traceHook = traceHook.get();
+        traceHook->OnRequestStart(context.trace, method, url, tracedConfig.additional_headers);
+        effectiveConfig = &tracedConfig;
+    }
+#endif
+
     if (!ParseUrl(url, protocol, host, path, port)) {
         response.success = false;
         response.error_message = "Invalid URL";
+        response.error_type = ErrorType::InvalidUrl;
+    }
+    else if (!NetworkReplay::IsReplaying() && !NetworkBudget::Admit(
+                 (payload ? payload->size() : (body ? kUploadChunkSize : 0)) +
+                 (config.max_body_bytes ? std::min(config.max_body_bytes, kResponseReservation) : kResponseReservation),
+                 context.budget)) {
+        response.success = false;
+        response.error_message = "Memory budget exhausted";
+        response.error_type = ErrorType::ResourceLimit;
+    }
+    else {
+        // Each hop of a redirect chain is a request of its own: routed, limited, recorded
+        static const std::optional<std::string> noPayload;
+        std::string target = url;
+        Method hopMethod = method;
+        const std::optional<std::string>* hopPayload = &payload;
+        BodySource* hopBody = body;
+        const RequestConfig* hopConfig = effectiveConfig;
+        RequestConfig redirectedConfig;  // Copy of the config once a redirect has to drop headers
+        bool bodyConsumed = false;
+        int redirects = 0;
+
+        // Moves to the next hop; false (with an error) if the redirect cannot be followed
+        auto redirect = [&](const std::string& location, int statusCode) {
+            // 303, and 301/302 answering a POST, are followed with a GET without body
+            bool toGet = statusCode == 303 || ((statusCode == 301 || statusCode == 302) && hopMethod == Method::HTTP_POST);
+            if (!toGet && hopBody && bodyConsumed) {
+                response.error_message = "Redirect requires resending a streamed request body";
+                return false;
+            }
+            std::string fromProtocol, fromHost, fromPath, toProtocol, toHost, toPath;
+            int fromPort = 0, toPort = 0;
+            ParseUrl(target, fromProtocol, fromHost, fromPath, fromPort);
+            bool crossOrigin = !ParseUrl(location, toProtocol, toHost, toPath, toPort) ||
+                               fromProtocol != toProtocol || fromPort != toPort || !EqualsIgnoreCase(fromHost, toHost);
+
+            if (toGet || crossOrigin) {
+                if (hopConfig != &redirectedConfig) {
+                    redirectedConfig = *hopConfig;
+                    hopConfig = &redirectedConfig;
+                }
+                // Body headers go with the body; credentials stay with the origin they were meant for
+                std::vector<const char*> dropped;
+                if (toGet) {
+                    dropped.insert(dropped.end(), { "Content-Type", "Content-Length", "Content-Encoding" });
+                }
+                auto& headers = redirectedConfig.additional_headers;
+                for (auto it = headers.begin(); it != headers.end();) {
+                    bool drop = std::any_of(dropped.begin(), dropped.end(),
+                                            [&it](const char* name) { return EqualsIgnoreCase(it->first, name); }) ||
+                                (crossOrigin && IsCredentialHeader(it->first, it->second, redirectedConfig));
+                    it = drop ? headers.erase(it) : std::next(it);
+                }
+            }
+            if (toGet) {
+                hopMethod = Method::HTTP_GET;
+                hopPayload = &noPayload;
+                hopBody = nullptr;
+            }
+            target = location;
+            redirects++;
+            return true;
+        };
+
+        for (;;) {
+            // Permanent redirects seen before are taken without asking the server again
+            std::string location;
+            int cachedStatus = 0;
+            if (hopConfig->follow_redirects && redirects < hopConfig->max_redirects &&
+                LookupRedirect(target, location, cachedStatus)) {
+                if (redirect(location, cachedStatus)) {
+                    continue;
+                }
+                response.success = false;
+                response.error_type = ErrorType::Other;
+                break;
+            }
+
+            if (!ParseUrl(target, protocol, host, path, port)) {
+                response.success = false;
+                response.error_message = "Invalid redirect location";
+                response.error_type = ErrorType::InvalidUrl;
+                break;
+            }
+            context.requestBytes = *hopPayload ? (*hopPayload)->size() : (hopBody ? hopBody->Size().value_or(0) : 0);
+            context.misdirected = false;
+            context.followRedirects = hopConfig->follow_redirects && redirects < hopConfig->max_redirects;
+
+            if (NetworkReplay::IsReplaying()) {
+                NetworkReplay::Replay(hopMethod, target, response);
+            }
+            else {
+                // Requests addressed to a registered service go to one of its endpoints
+                NetworkLoadBalancer::Lease lease;
+                if (NetworkLoadBalancer::HasServices()) {
+                    lease = NetworkLoadBalancer::Acquire(host, hopConfig->routing_key);
+                    if (lease) {
+                        protocol = lease.Protocol();
+                        host = lease.Host();
+                        port = lease.Port();
+                        path = lease.BasePath() + path;
+                    }
+                }
+
+                // Adaptive per-host concurrency limit, applied to the endpoint actually contacted
+                NetworkLimiter::Permit permit;
+                if (NetworkLimiter::IsEnabled() && !NetworkLimiter::Acquire(host, port, permit)) {
+                    response.success = false;
+                    response.error_message = "Concurrency limit reached for host";
+                    response.error_type = ErrorType::ResourceLimit;
+                }
+                else {
+                    NetworkScheduler::Slot slot(*hopConfig);
+                    if (response.timings.dequeued == std::chrono::steady_clock::time_point()) {
+                        response.timings.dequeued = std::chrono::steady_clock::now();
+                    }
+                    SendRequest(context, hopMethod, protocol, host, path, port, *hopPayload, hopBody, *hopConfig);
+                    bodyConsumed = hopBody != nullptr;
+                    permit.Complete(response);
+                }
+                if (lease) {
+                    lease.Complete(response);
+                }
+                if (NetworkReplay::IsRecording()) {
+                    NetworkReplay::Record(hopMethod, target, static_cast<size_t>(context.requestBytes), response);
+                }
+            }
+
+            int statusCode = response.status_code;
+            if (!hopConfig->follow_redirects || !IsRedirectStatus(statusCode)) {
+                break;
+            }
+            location = ResolveLocation(target, HeaderValue(response.headers, "Location"));
+            if (location.empty()) {
+                break;  // No Location, or one this library cannot request
+            }
+            if (redirects >= hopConfig->max_redirects) {
+                response.error_message = "Too many redirects (max_redirects is " + std::to_string(hopConfig->max_redirects) + ")";
+                response.error_type = ErrorType::Other;
+                break;
+            }
+            if (statusCode == 301 || statusCode == 308) {
+                CacheRedirect(target, location, statusCode, response.headers);
+            }
+            if (!redirect(location, statusCode)) {
+                response.error_type = ErrorType::Other;
+                break;
+            }
+
+            // The next hop starts from a clean response; the request's start and queueing still count
+            NetworkResponse::Timings timings;
+            timings.start = response.timings.start;
+            timings.dequeued = response.timings.dequeued;
+            response = NetworkResponse();
+            response.timings = timings;
+        }
+        response.final_url = target;
+        response.redirects = redirects;
+    }
+    // Requests that never took a slot did not queue for one
+    if (response.timings.dequeued == std::chrono::steady_clock::time_point()) {
+        response.timings.dequeued = start;
+    }
+
+    if (body) {
+        body->Done();
+    }
+
+    if (NetworkMetrics::IsEnabled()) {
+        NetworkMetrics::RecordRequest(host, method, response, static_cast<size_t>(context.requestBytes));
+    }
+
+    if (NetworkHar::IsEnabled()) {
+        NetworkHar::Capture(method, url, *effectiveConfig, static_cast<size_t>(context.requestBytes), response);
+    }
+
+#if NETWORK_ENABLE_TRACING
+    if (traceHook) {
+        traceHook->OnRequestEnd(context.trace, method, url, response);
+    }
+#endif
+
+    return response;
+}
+
+/**
+ * @brief Sends a health probe without scheduling or admission
+ *
+ * Health probes run on the shared NetworkTimer thread. Through Perform they
+ * would wait for a scheduler slot, the memory budget and the concurrency
+ * limiter whenever batch traffic saturates them, stalling every other timer
+ * task exactly when health data matters. Only the exchange itself is done
+ * here, and the body is dropped as it arrives, so nothing is reserved.
+ *
+ * @param url The probe URL
+ * @param config The request configuration
+ * @return The probe response
+ */
+Network::NetworkResponse Network::Probe(const std::string& url, const RequestConfig& config) {
+    NetworkResponse response;
+    response.timings.start = std::chrono::steady_clock::now();
+    response.timings.dequeued = response.timings.start;
+    response.final_url = url;
+
+    std::string protocol, host, path;
+    int port;
+    if (!ParseUrl(url, protocol, host, path, port)) {
+        response.error_message = "Invalid URL";
+        response.error_type = ErrorType::InvalidUrl;
         return response;
     }
 
-    // Apply rate limiting
-    if (config.rate_limit_per_minute > 0 && !ApplyRateLimit(host, config.rate_limit_per_minute)) {
-        response.success = false;
-        response.error_message = "Rate limit exceeded for host: " + host + ". Please wait before retrying.";
-        response.status_code = 429;  // HTTP 429 Too Many Requests
-        return response;
+    RequestConfig probeConfig = config;
+    probeConfig.follow_redirects = false;
+    probeConfig.on_body_data = [](const char*, size_t) { return true; };
+    RequestContext context(response);
+    SendRequest(context, Method::HTTP_GET, protocol, host, path, port, std::nullopt, nullptr, probeConfig);
+    return response;
+}
+
+/**
+ * @brief Performs the WinHTTP exchange for a parsed URL
+ * 
+ * Request() owns URL parsing and completion bookkeeping; this method does
+ * everything in between and fills in the response, returning early on failure.
+ * 
+ * @param context The request context holding the response to fill in
+ * @param method The HTTP method to use
+ * @param protocol The URL protocol (http/https)
+ * @param host The target host
+ * @param path The request path
+ * @param port The target port
+ * @param payload The payload to send with the request (optional)
+ * @param body The streamed body to send with the request (optional)
+ * @param config The request configuration
+ */
+void Network::SendRequest(
+    RequestContext& context,
+    Method method,
+    const std::string& protocol,
+    const std::string& host,
+    const std::string& path,
+    int port,
+    const std::optional<std::string>& payload,
+    BodySource* body,
+    const RequestConfig& config
+) {
+    NetworkResponse& response = context.response;
+
+    std::optional<uint64_t> bodyLength = body ? body->Size() : std::nullopt;
+
+    // Apply rate limiting; a request resent after a refused coalesced attempt was already counted
+    if (!context.misdirected) {
+        if (config.rate_limit_per_minute > 0 && !ApplyRateLimit(host, config.rate_limit_per_minute)) {
+            response.success = false;
+            response.error_message = "Rate limit exceeded for host: " + host + ". Please wait before retrying.";
+            response.status_code = 429;  // HTTP 429 Too Many Requests
+            response.error_type = ErrorType::RateLimited;
+            return;
+        }
+        response.timings.rate_limited = std::chrono::steady_clock::now();
+        context.Trace(TracePhase::RateLimited, response.timings.rate_limited);
+    }
+
+    // WinHTTP only speaks TCP; Unix socket URLs take the library's own transport
+    if (NetworkUnixSocket::IsUnixScheme(protocol)) {
+        SendUnixRequest(context, method, NetworkUnixSocket::SocketPath(host), path, payload, body, config);
+        return;
+    }
+
+    // Route through the configured proxy, or straight to hosts on its no-proxy list
+    std::optional<NetworkProxy::Route> proxyRoute;
+    if (NetworkProxy::IsEnabled()) {
+        proxyRoute = NetworkProxy::Resolve(protocol, host, port);
+        if (proxyRoute->kind == NetworkProxy::Route::Kind::Relay && proxyRoute->relay_port == 0) {
+            response.error_message = "Failed to start SOCKS5 relay";
+            response.error_type = ErrorType::Connect;
+            return;
+        }
     }
+    bool relayed = proxyRoute && proxyRoute->kind == NetworkProxy::Route::Kind::Relay;
+
+    // HTTP/2 is negotiated through ALPN, so only over TLS. Bodies of unknown size stay on
+    // HTTP/1.1: WriteRequestBody frames them with chunked encoding, which HTTP/2 forbids
+    bool http2 = config.use_http2 && protocol == "https" && !(body && !bodyLength);
+
+    // Connect as another host whose HTTP/2 connection (same address, certificate covering
+    // this host) WinHTTP already pools, so the request rides on it
+    bool coalescable = http2 && config.verify_ssl && NetworkCoalescing::IsEnabled() &&
+                       (!proxyRoute || proxyRoute->kind == NetworkProxy::Route::Kind::Direct);
+    std::string origin = coalescable && !context.misdirected ? NetworkCoalescing::Resolve(host, port) : std::string();
+    bool coalesced = !origin.empty();
 
     // Convert strings to wide strings
-    std::wstring whost(host.begin(), host.end());
+    std::wstring whost = relayed ? std::wstring(L"127.0.0.1")
+                       : coalesced ? std::wstring(origin.begin(), origin.end())
+                       : std::wstring(host.begin(), host.end());
     std::wstring wpath(path.begin(), path.end());
 
     // Create connection handle with connection pooling
     HINTERNET hConnect = WinHttpConnect(
         hSession,
         whost.c_str(),
-        static_cast<WORD>(port),
+        static_cast<WORD>(relayed ? proxyRoute->relay_port : port),
         0
     );
 
     if (!hConnect) {
         response.error_message = "Failed to connect";
-        return response;
+        response.error_type = ErrorType::Connect;
+        return;
     }
 
     // Create request handle
@@ -204,6 +1234,7 @@ Network::NetworkResponse Network::Request(
         case Method::HTTP_GET:    pwszVerb = L"GET"; break;
         case Method::HTTP_POST:   pwszVerb = L"POST"; break;
         case Method::HTTP_PUT:    pwszVerb = L"PUT"; break;
+        case Method::HTTP_PATCH:  pwszVerb = L"PATCH"; break;
         case Method::HTTP_DELETE: pwszVerb = L"DELETE"; break;
         default:                  pwszVerb = L"GET"; break;
     }
@@ -231,7 +1262,50 @@ Network::NetworkResponse Network::Request(
     if (!hRequest) {
         WinHttpCloseHandle(hConnect);
         response.error_message = "Failed to create request";
-        return response;
+        response.error_type = ErrorType::Other;
+        return;
+    }
+
+    // Redirects are followed by Perform, hop by hop, instead of inside WinHTTP
+    DWORD redirectPolicy = WINHTTP_OPTION_REDIRECT_POLICY_NEVER;
+    WinHttpSetOption(hRequest, WINHTTP_OPTION_REDIRECT_POLICY, &redirectPolicy, sizeof(redirectPolicy));
+
+    if (http2) {
+        DWORD protocols = WINHTTP_PROTOCOL_FLAG_HTTP2;
+        WinHttpSetOption(hRequest, WINHTTP_OPTION_ENABLE_HTTP_PROTOCOL, &protocols, sizeof(protocols));
+    }
+
+    if (proxyRoute) {
+        std::wstring proxyName(proxyRoute->proxy.begin(), proxyRoute->proxy.end());
+        WINHTTP_PROXY_INFO proxyInfo = {};
+        proxyInfo.dwAccessType = proxyRoute->kind == NetworkProxy::Route::Kind::Proxy
+            ? WINHTTP_ACCESS_TYPE_NAMED_PROXY : WINHTTP_ACCESS_TYPE_NO_PROXY;
+        proxyInfo.lpszProxy = proxyName.empty() ? WINHTTP_NO_PROXY_NAME : &proxyName[0];
+        WinHttpSetOption(hRequest, WINHTTP_OPTION_PROXY, &proxyInfo, sizeof(proxyInfo));
+
+        // Sent with the first request rather than after a 407 round trip
+        if (!proxyRoute->username.empty()) {
+            std::wstring username(proxyRoute->username.begin(), proxyRoute->username.end());
+            std::wstring password(proxyRoute->password.begin(), proxyRoute->password.end());
+            WinHttpSetCredentials(hRequest, WINHTTP_AUTH_TARGET_PROXY, WINHTTP_AUTH_SCHEME_BASIC,
+                                  username.c_str(), password.c_str(), NULL);
+        }
+
+        // The relay port stands in for the target, which the server must still see
+        if (relayed) {
+            std::string authority = port == 80 ? host : host + ":" + std::to_string(port);
+            std::wstring hostHeader = L"Host: " + std::wstring(authority.begin(), authority.end());
+            WinHttpAddRequestHeaders(hRequest, hostHeader.c_str(), static_cast<DWORD>(-1L),
+                                     WINHTTP_ADDREQ_FLAG_ADD | WINHTTP_ADDREQ_FLAG_REPLACE);
+        }
+    }
+
+    // The connection belongs to the origin, but the request is for this host
+    if (coalesced) {
+        std::string authority = port == INTERNET_DEFAULT_HTTPS_PORT ? host : host + ":" + std::to_string(port);
+        std::wstring hostHeader = L"Host: " + std::wstring(authority.begin(), authority.end());
+        WinHttpAddRequestHeaders(hRequest, hostHeader.c_str(), static_cast<DWORD>(-1L),
+                                 WINHTTP_ADDREQ_FLAG_ADD | WINHTTP_ADDREQ_FLAG_REPLACE);
     }
 
     // Set timeouts
@@ -250,6 +1324,15 @@ Network::NetworkResponse Network::Request(
         WinHttpSetOption(hRequest, option, &retries, sizeof(retries));
     }
 
+    // Relax certificate checks when verification is disabled
+    if (protocol == "https" && !config.verify_ssl) {
+        DWORD securityFlags = SECURITY_FLAG_IGNORE_UNKNOWN_CA |
+                              SECURITY_FLAG_IGNORE_CERT_DATE_INVALID |
+                              SECURITY_FLAG_IGNORE_CERT_CN_INVALID |
+                              SECURITY_FLAG_IGNORE_CERT_WRONG_USAGE;
+        WinHttpSetOption(hRequest, WINHTTP_OPTION_SECURITY_FLAGS, &securityFlags, sizeof(securityFlags));
+    }
+
     // Add custom headers
     std::wstring headers;
     for (const auto& [key, value] : config.additional_headers) {
@@ -257,6 +1340,24 @@ Network::NetworkResponse Network::Request(
                   std::wstring(value.begin(), value.end()) + L"\r\n";
     }
     
+    // WinHTTP takes 32-bit lengths; larger bodies announce their size in a header,
+    // and bodies of unknown size are framed by WriteRequestBody
+    DWORD totalLength = payload ? static_cast<DWORD>(payload->size()) : 0;
+    if (body && !bodyLength) {
+        headers += L"Transfer-Encoding: chunked\r\n";
+        totalLength = WINHTTP_IGNORE_REQUEST_TOTAL_LENGTH;
+    }
+    else if (bodyLength) {
+        if (*bodyLength > MAXDWORD) {
+            std::string length = std::to_string(*bodyLength);
+            headers += L"Content-Length: " + std::wstring(length.begin(), length.end()) + L"\r\n";
+            totalLength = WINHTTP_IGNORE_REQUEST_TOTAL_LENGTH;
+        }
+        else {
+            totalLength = static_cast<DWORD>(*bodyLength);
+        }
+    }
+
     if (!headers.empty()) {
         WinHttpAddRequestHeaders(
             hRequest,
@@ -266,6 +1367,14 @@ Network::NetworkResponse Network::Request(
         );
     }
 
+    // Checked by RecordPhase once the connection is up, before anything is written to it
+    context.verifyHost = host;
+    context.verifyPort = port;
+    context.verifyCoalesced = coalesced;
+    context.verifyRevocation = protocol == "https" && config.verify_ssl && config.check_revocation;
+    context.connectionVerified = false;
+    context.requestClosed = false;
+
     // Send request
     BOOL bResults = WinHttpSendRequest(
         hRequest,
@@ -273,40 +1382,84 @@ Network::NetworkResponse Network::Request(
         0,
         payload ? const_cast<LPVOID>(static_cast<LPCVOID>(payload->c_str())) : WINHTTP_NO_REQUEST_DATA,
         payload ? static_cast<DWORD>(payload->size()) : 0,
-        payload ? static_cast<DWORD>(payload->size()) : 0,
-        0
+        totalLength,
+        reinterpret_cast<DWORD_PTR>(&context)  // Context for RecordPhase
     );
+    // If WinHttpSendRequest failed, nothing of the request reached the server
+    bool requestStarted = bResults != FALSE;
+
+    if (bResults && body) {
+        auto write = [hRequest](const char* data, size_t size) {
+            DWORD bytesWritten = 0;
+            return WinHttpWriteData(hRequest, data, static_cast<DWORD>(size), &bytesWritten) != FALSE;
+        };
+        bResults = WriteRequestBody(context, write, *body, bodyLength);
+        if (!bResults && response.error_type != ErrorType::None) {
+            WinHttpCloseHandle(hRequest);
+            WinHttpCloseHandle(hConnect);
+            return;
+        }
+    }
+    // Reported once the whole body is out, not after every write
+    if (bResults && response.timings.request_sent != std::chrono::steady_clock::time_point()) {
+        context.Trace(TracePhase::RequestSent, response.timings.request_sent);
+    }
 
     if (bResults) {
         bResults = WinHttpReceiveResponse(hRequest, NULL);
     }
 
+    // The connection failed verification and RecordPhase closed the request before it was sent
+    if (!bResults && context.requestClosed) {
+        WinHttpCloseHandle(hConnect);
+        // The coalesced connection was refused before any of the request went out, streamed
+        // body included, so it can go on a connection of the host's own
+        if (coalesced && context.misdirected && !requestStarted) {
+            SendRequest(context, method, protocol, host, path, port, payload, body, config);
+            return;
+        }
+        response.success = false;
+        response.status_code = 0;
+        response.error_message = context.verifyError;
+        response.error_type = ErrorType::Tls;
+        return;
+    }
+
     if (!bResults) {
         DWORD error = GetLastError();
         switch (error) {
             case ERROR_WINHTTP_TIMEOUT:
                 response.error_message = "Request timed out";
+                response.error_type = ErrorType::Timeout;
                 break;
             case ERROR_WINHTTP_NAME_NOT_RESOLVED:
                 response.error_message = "DNS name resolution failed";
+                response.error_type = ErrorType::Dns;
                 break;
             case ERROR_WINHTTP_CANNOT_CONNECT:
                 response.error_message = "Failed to connect to server";
+                response.error_type = ErrorType::Connect;
+                break;
+            case ERROR_WINHTTP_SECURE_FAILURE:
+                response.error_message = "TLS handshake or certificate validation failed";
+                response.error_type = ErrorType::Tls;
                 break;
             case ERROR_WINHTTP_CONNECTION_ERROR:
                 response.error_message = "Connection was terminated";
+                response.error_type = ErrorType::Connection;
                 break;
             default:
                 char errorMsg[256];
                 sprintf_s(errorMsg, "Request failed with error code: %lu", error);
                 response.error_message = errorMsg;
+                response.error_type = ErrorType::Other;
         }
         response.success = false;
         response.status_code = 0;
         
         WinHttpCloseHandle(hRequest);
         WinHttpCloseHandle(hConnect);
-        return response;
+        return;
     }
 
     // Get status code
@@ -322,6 +1475,19 @@ Network::NetworkResponse Network::Request(
     );
     response.status_code = statusCode;
 
+    // 421 Misdirected Request: this server will not answer for the host on the origin's connection
+    if (statusCode == 421 && coalesced) {
+        NetworkCoalescing::Forget(host, port);
+        if (!body) {
+            WinHttpCloseHandle(hRequest);
+            WinHttpCloseHandle(hConnect);
+            response.status_code = 0;
+            context.misdirected = true;
+            SendRequest(context, method, protocol, host, path, port, payload, body, config);
+            return;
+        }
+    }
+
     // Get headers
     DWORD headerSize = 0;
     WinHttpQueryHeaders(
@@ -344,57 +1510,648 @@ Network::NetworkResponse Network::Request(
             WINHTTP_NO_HEADER_INDEX
         );
 
-        std::wstring headerStr(headerBuffer.data());
-        std::wistringstream headerStream(headerStr);
-        std::wstring line;
+        ParseResponseHeaders(std::wstring(headerBuffer.data()), response.headers);
+    }
 
-        while (std::getline(headerStream, line)) {
-            if (line.empty() || line == L"\r") continue;
-            
-            size_t colonPos = line.find(L':');
-            if (colonPos != std::wstring::npos) {
-                std::wstring key = line.substr(0, colonPos);
-                std::wstring value = line.substr(colonPos + 2); // Skip ": "
-                if (!value.empty() && value.back() == L'\r') {
-                    value.pop_back(); // Remove trailing \r
+    // Get response body; that of a redirect about to be followed is dropped, not kept or delivered.
+    // A redirect whose body could not be drained is still followed, on another connection
+    bool bodyComplete = WillFollowRedirect(response, context.followRedirects)
+        ? DrainResponseBody(hRequest) : ReadResponseBody(context, hRequest, config);
+
+    // HTTP/2 trailers (gRPC's status, for one) are kept apart from the headers until the body is read
+    if (bodyComplete && config.use_http2) {
+        DWORD trailerSize = 0;
+        WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_RAW_HEADERS_CRLF | WINHTTP_QUERY_FLAG_TRAILERS,
+                            WINHTTP_HEADER_NAME_BY_INDEX, NULL, &trailerSize, WINHTTP_NO_HEADER_INDEX);
+        if (GetLastError() == ERROR_INSUFFICIENT_BUFFER) {
+            std::vector<wchar_t> trailerBuffer(trailerSize / sizeof(wchar_t) + 1);
+            if (WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_RAW_HEADERS_CRLF | WINHTTP_QUERY_FLAG_TRAILERS,
+                                    WINHTTP_HEADER_NAME_BY_INDEX, trailerBuffer.data(), &trailerSize, WINHTTP_NO_HEADER_INDEX)) {
+                ParseResponseHeaders(std::wstring(trailerBuffer.data()), response.headers);
+            }
+        }
+    }
+    response.timings.last_byte = std::chrono::steady_clock::now();
+    context.Trace(TracePhase::LastByte, response.timings.last_byte);
+    response.timings.connection_reused = response.timings.connect_start == std::chrono::steady_clock::time_point();
+
+    // A direct HTTP/2 connection becomes an origin that other hosts can share
+    if (bodyComplete && coalescable && !coalesced && NetworkCoalescing::NeedsOrigin(host, port)) {
+        DWORD protocolUsed = 0;
+        DWORD protocolSize = sizeof(protocolUsed);
+        if (WinHttpQueryOption(hRequest, WINHTTP_OPTION_HTTP_PROTOCOL_USED, &protocolUsed, &protocolSize) &&
+            (protocolUsed & WINHTTP_PROTOCOL_FLAG_HTTP2)) {
+            NetworkCoalescing::AddOrigin(host, port, CertificateNames(hRequest));
+        }
+    }
+    response.success = bodyComplete && (statusCode >= 200 && statusCode < 300);
+    if (bodyComplete && !response.success) {
+        response.error_type = ErrorType::Http;
+    }
+    
+    // Cleanup
+    WinHttpCloseHandle(hRequest);
+    WinHttpCloseHandle(hConnect);
+
+}
+
+/**
+ * @brief Performs an HTTP/1.1 exchange over a pooled Unix domain socket
+ *
+ * The counterpart of the WinHTTP exchange for http+unix:// URLs. The request
+ * is framed here as WinHTTP would frame it; the response is parsed here, with
+ * Content-Length, chunked and close-delimited bodies. Bodies are received
+ * straight into NetworkResponse::body and accounted against the budget like
+ * WinHTTP responses, and the timings stamp the same phases (no DNS, and a
+ * connect phase only for new connections).
+ *
+ * A pooled connection the server closed after the staleness check shows up
+ * as an immediate EOF; the request is then sent once more on a new
+ * connection, unless a streamed body has already been consumed.
+ *
+ * @param context The request context holding the response to fill in
+ * @param method The HTTP method to use
+ * @param socketPath The decoded socket path
+ * @param path The request path
+ * @param payload The payload to send with the request (optional)
+ * @param body The streamed body to send with the request (optional)
+ * @param config The request configuration
+ */
+void Network::SendUnixRequest(
+    RequestContext& context,
+    Method method,
+    const std::string& socketPath,
+    const std::string& path,
+    const std::optional<std::string>& payload,
+    BodySource* body,
+    const RequestConfig& config
+) {
+    using Clock = std::chrono::steady_clock;
+    NetworkResponse& response = context.response;
+    NetworkResponse::Timings& timings = response.timings;
+    std::optional<uint64_t> bodyLength = body ? body->Size() : std::nullopt;
+    int timeoutMs = config.timeout_seconds > 0 ? config.timeout_seconds * 1000 : 0;
+
+    NetworkUnixSocket::Connection connection;
+    auto fail = [&response](const std::string& message, ErrorType type) {
+        response.success = false;
+        response.error_message = message;
+        response.error_type = type;
+        return false;
+    };
+    auto failTransfer = [&]() {
+        return connection.TimedOut() ? fail("Request timed out", ErrorType::Timeout)
+                                     : fail("Connection was terminated", ErrorType::Connection);
+    };
+
+    // Sidecars often route on Host, so a caller-supplied one replaces the default
+    std::string head = std::string(MethodName(method)) + " " + path + " HTTP/1.1\r\n";
+    bool hasHost = std::any_of(config.additional_headers.begin(), config.additional_headers.end(),
+                               [](const auto& header) { return EqualsIgnoreCase(header.first, "Host"); });
+    if (!hasHost) {
+        head += "Host: localhost\r\n";
+    }
+    for (const auto& [key, value] : config.additional_headers) {
+        head += key + ": " + value + "\r\n";
+    }
+    if (payload) {
+        head += "Content-Length: " + std::to_string(payload->size()) + "\r\n";
+    }
+    else if (body) {
+        head += bodyLength ? "Content-Length: " + std::to_string(*bodyLength) + "\r\n" : std::string("Transfer-Encoding: chunked\r\n");
+    }
+    else if (method == Method::HTTP_POST || method == Method::HTTP_PUT || method == Method::HTTP_PATCH) {
+        head += "Content-Length: 0\r\n";
+    }
+    head += "\r\n";
+
+    // Send, retrying once on a new connection if a pooled one turns out to be closed
+    std::string received;  // Response bytes not yet consumed
+    char chunk[16 * 1024];
+    for (int attempt = 0; ; attempt++) {
+        Clock::time_point connectStart = Clock::now();
+        std::string error;
+        if (!NetworkUnixSocket::Acquire(socketPath, timeoutMs, attempt == 0, connection, error)) {
+            fail(error, ErrorType::Connect);
+            return;
+        }
+        if (!connection.Reused()) {
+            timings.connect_start = connectStart;
+            timings.connect_end = Clock::now();
+            context.Trace(TracePhase::ConnectStart, timings.connect_start);
+            context.Trace(TracePhase::ConnectEnd, timings.connect_end);
+        }
+        if (timings.send_start == Clock::time_point()) {
+            timings.send_start = Clock::now();
+            context.Trace(TracePhase::SendStart, timings.send_start);
+        }
+
+        bool sent = connection.Send(head.data(), head.size()) &&
+                    (!payload || connection.Send(payload->data(), payload->size()));
+        if (sent && body) {
+            auto write = [&connection](const char* data, size_t size) { return connection.Send(data, size); };
+            sent = WriteRequestBody(context, write, *body, bodyLength);
+            if (!sent && response.error_type != ErrorType::None) {
+                return;
+            }
+        }
+
+        int count = 0;
+        if (sent) {
+            timings.request_sent = Clock::now();
+            context.Trace(TracePhase::RequestSent, timings.request_sent);
+            count = connection.Receive(chunk, sizeof(chunk));
+        }
+        if (count > 0) {
+            received.assign(chunk, count);
+            break;
+        }
+        if (attempt > 0 || !connection.Reused() || connection.TimedOut() || body) {
+            failTransfer();
+            return;
+        }
+    }
+    timings.first_byte = Clock::now();
+    context.Trace(TracePhase::FirstByte, timings.first_byte);
+
+    auto receiveMore = [&]() {
+        int count = connection.Receive(chunk, sizeof(chunk));
+        if (count <= 0) {
+            return failTransfer();
+        }
+        received.append(chunk, count);
+        return true;
+    };
+    auto readLine = [&](std::string& line) {
+        size_t lineEnd;
+        while ((lineEnd = received.find("\r\n")) == std::string::npos) {
+            if (received.size() > kMaxResponseHead) {
+                return fail("Malformed response", ErrorType::Connection);
+            }
+            if (!receiveMore()) {
+                return false;
+            }
+        }
+        line = received.substr(0, lineEnd);
+        received.erase(0, lineEnd + 2);
+        return true;
+    };
+
+    // Status line and headers, skipping interim 1xx responses
+    int statusCode = 0;
+    std::string responseHead;
+    do {
+        size_t headEnd;
+        while ((headEnd = received.find("\r\n\r\n")) == std::string::npos) {
+            if (received.size() > kMaxResponseHead) {
+                fail("Response headers too large", ErrorType::Connection);
+                return;
+            }
+            if (!receiveMore()) {
+                return;
+            }
+        }
+        responseHead = received.substr(0, headEnd + 2);
+        received.erase(0, headEnd + 4);
+        size_t statusStart = responseHead.find(' ');
+        if (responseHead.compare(0, 5, "HTTP/") != 0 || statusStart == std::string::npos) {
+            fail("Malformed response", ErrorType::Connection);
+            return;
+        }
+        statusCode = std::atoi(responseHead.c_str() + statusStart + 1);
+    } while (statusCode >= 100 && statusCode < 200 && statusCode != 101);
+
+    response.status_code = statusCode;
+    ParseResponseHeaders(std::wstring(responseHead.begin(), responseHead.end()), response.headers);
+
+    std::string connectionHeader = LowercaseHeader(response.headers, "Connection");
+    bool keepAlive = responseHead.compare(0, 8, "HTTP/1.0") == 0
+        ? connectionHeader.find("keep-alive") != std::string::npos
+        : connectionHeader.find("close") == std::string::npos;
+
+    // With on_body_data, each piece is handed over as it is read instead of kept; a redirect
+    // about to be followed is read to the end (keeping the connection) and dropped
+    uint64_t delivered = 0;
+    bool draining = WillFollowRedirect(response, context.followRedirects);
+    bool streaming = draining || config.on_body_data;
+    std::vector<char> streamBuffer;
+    auto deliver = [&](const char* data, size_t size) {
+        if (draining || size == 0) {
+            return true;
+        }
+        delivered += size;
+        if (config.max_body_bytes != 0 && delivered > config.max_body_bytes) {
+            return fail("Response body exceeds max_body_bytes", ErrorType::ResourceLimit);
+        }
+        return config.on_body_data(data, size) || fail("Response body aborted by on_body_data", ErrorType::Other);
+    };
+    // Reads one piece from the socket and hands it over: its size, 0 once the server closed, -1 on failure
+    auto receivePiece = [&](size_t capacity) {
+        streamBuffer.resize(kResponseReservation);
+        int count = connection.Receive(streamBuffer.data(), std::min(capacity, kResponseReservation));
+        if (count < 0) {
+            failTransfer();
+            return -1;
+        }
+        return deliver(streamBuffer.data(), static_cast<size_t>(count)) ? count : -1;
+    };
+
+    // Reads count body bytes: what is already buffered, then straight from the socket
+    std::string& responseBody = response.body;
+    auto readBody = [&](uint64_t count) {
+        if (streaming) {
+            size_t buffered = static_cast<size_t>(std::min<uint64_t>(received.size(), count));
+            if (!deliver(received.data(), buffered)) {
+                return false;
+            }
+            received.erase(0, buffered);
+            for (count -= buffered; count > 0; ) {
+                int piece = receivePiece(static_cast<size_t>(std::min<uint64_t>(count, kResponseReservation)));
+                if (piece <= 0) {
+                    return piece == 0 ? failTransfer() : false;
+                }
+                count -= static_cast<uint64_t>(piece);
+            }
+            return true;
+        }
+
+        size_t offset = responseBody.size();
+        if (count > SIZE_MAX - offset) {
+            return fail("Response body too large", ErrorType::ResourceLimit);
+        }
+        if (!ReserveResponseBody(context, offset + count, config.max_body_bytes)) {
+            return false;
+        }
+        size_t end = offset + static_cast<size_t>(count);
+        responseBody.reserve(std::min(end, kMaxBodyPreallocation));
+        size_t buffered = std::min(received.size(), end - offset);
+        responseBody.append(received, 0, buffered);
+        received.erase(0, buffered);
+        while (responseBody.size() < end) {
+            size_t filled = responseBody.size();
+            size_t step = std::min(end - filled, kResponseReservation);
+            responseBody.resize(filled + step);
+            int count = connection.Receive(&responseBody[filled], step);
+            responseBody.resize(filled + std::max(count, 0));
+            if (count <= 0) {
+                return failTransfer();
+            }
+        }
+        return true;
+    };
+
+    std::string transferEncoding = LowercaseHeader(response.headers, "Transfer-Encoding");
+    std::string contentLength = LowercaseHeader(response.headers, "Content-Length");
+    bool bodyComplete = true;
+    if (statusCode == 204 || statusCode == 304) {
+        // No body
+    }
+    else if (transferEncoding.find("chunked") != std::string::npos) {
+        std::string line;
+        for (;;) {
+            if (!readLine(line)) {
+                return;
+            }
+            uint64_t chunkSize = 0;
+            if (!ParseChunkSize(line, chunkSize)) {
+                fail("Malformed chunk size in response", ErrorType::Connection);
+                return;
+            }
+            if (chunkSize == 0) {
+                break;
+            }
+            if (!readBody(chunkSize)) {
+                bodyComplete = false;
+                break;
+            }
+            if (!readLine(line)) {
+                return;
+            }
+        }
+
+        // Trailer fields join the headers; the response ends with the empty line after them
+        std::string trailers;
+        while (bodyComplete) {
+            if (!readLine(line)) {
+                return;
+            }
+            if (line.empty()) {
+                break;
+            }
+            trailers += line + "\r\n";
+        }
+        ParseResponseHeaders(std::wstring(trailers.begin(), trailers.end()), response.headers);
+    }
+    else if (!contentLength.empty()) {
+        uint64_t length = 0;
+        if (!ParseContentLength(contentLength, length)) {
+            fail("Malformed Content-Length in response", ErrorType::Connection);
+            return;
+        }
+        bodyComplete = readBody(length);
+    }
+    else {
+        // Delimited by the server closing the connection
+        keepAlive = false;
+        if (streaming) {
+            bodyComplete = deliver(received.data(), received.size());
+            received.clear();
+            for (int piece = 1; bodyComplete && piece > 0; ) {
+                piece = receivePiece(kResponseReservation);
+                bodyComplete = piece >= 0;
+            }
+        }
+        else {
+            for (bool closed = false; ; ) {
+                responseBody += received;
+                received.clear();
+                size_t filled = responseBody.size();
+                if (!ReserveResponseBody(context, filled, config.max_body_bytes)) {
+                    bodyComplete = false;
+                    break;
+                }
+                if (closed) {
+                    break;
+                }
+                if (!ReserveResponseBody(context, filled + kResponseReservation, 0)) {
+                    bodyComplete = false;
+                    break;
                 }
-                
-                // Convert to narrow string
-                std::string keyStr(key.begin(), key.end());
-                std::string valueStr(value.begin(), value.end());
-                response.headers[keyStr] = valueStr;
+                responseBody.resize(filled + kResponseReservation);
+                int count = connection.Receive(&responseBody[filled], kResponseReservation);
+                responseBody.resize(filled + std::max(count, 0));
+                if (count < 0) {
+                    failTransfer();
+                    return;
+                }
+                closed = count == 0;
+            }
+        }
+    }
+    if (!bodyComplete && response.error_type != ErrorType::ResourceLimit) {
+        return;
+    }
+
+    timings.last_byte = Clock::now();
+    context.Trace(TracePhase::LastByte, timings.last_byte);
+    timings.connection_reused = connection.Reused();
+    response.success = bodyComplete && (statusCode >= 200 && statusCode < 300);
+    if (bodyComplete && !response.success) {
+        response.error_type = ErrorType::Http;
+    }
+
+    // Bytes past the response mean the framing was misread; never reuse such a connection
+    if (bodyComplete && keepAlive && received.empty()) {
+        connection.Release();
+    }
+}
+
+/**
+ * @brief Streams a request body to the connection
+ *
+ * One chunk buffer is allocated per request and refilled from the source
+ * until it reports the end of the body. Pulling only when WinHTTP has taken
+ * the previous chunk is what applies backpressure to the source.
+ *
+ * With a known length, the bytes produced must match the Content-Length
+ * already sent; a source that produces more or less fails the request instead
+ * of corrupting the connection. Without one, each read is framed as an
+ * HTTP/1.1 chunk, written together with its size line in a single call, and
+ * the body ends with the last-chunk and the source's trailers.
+ *
+ * @param context The request context holding the response
+ * @param write Sends bytes on the connection (WinHttpWriteData, or a Unix socket)
+ * @param body The source of the body
+ * @param length The size announced in Content-Length, or std::nullopt for chunked encoding
+ * @return true if the whole body was written
+ */
+bool Network::WriteRequestBody(
+    RequestContext& context,
+    const std::function<bool(const char* data, size_t size)>& write,
+    BodySource& body,
+    std::optional<uint64_t> length
+) {
+    static const size_t kChunkPrefix = 8;  // Room for the hex size line of a kUploadChunkSize chunk
+    static const char hexDigits[] = "0123456789abcdef";
+
+    NetworkResponse& response = context.response;
+    auto fail = [&response](const char* message) {
+        response.error_message = message;
+        response.error_type = ErrorType::Other;
+        return false;
+    };
+
+    bool chunked = !length;
+    uint64_t written = 0;
+
+    // In-memory bodies are sent straight from their own blocks
+    std::string_view block;
+    if (!chunked && body.NextBlock(block)) {
+        while (!block.empty()) {
+            if (block.size() > *length - written) {
+                return fail("Request body is longer than its declared size");
+            }
+            if (!write(block.data(), block.size())) {
+                return false;
+            }
+            written += block.size();
+            context.requestBytes = written;
+            body.NextBlock(block);
+        }
+        if (written != *length) {
+            return fail("Request body is shorter than its declared size");
+        }
+        return true;
+    }
+
+    std::vector<char> buffer(kChunkPrefix + kUploadChunkSize + 2);
+    char* data = buffer.data() + kChunkPrefix;
+    for (;;) {
+        size_t bytesRead = 0;
+        if (!body.Read(data, kUploadChunkSize, bytesRead)) {
+            return fail("Failed to read request body");
+        }
+        if (bytesRead == 0) {
+            break;
+        }
+        if (!chunked && bytesRead > *length - written) {
+            return fail("Request body is longer than its declared size");
+        }
+
+        if (chunked) {
+            // Size line right before the data and CRLF right after it
+            char* chunk = data - 2;
+            chunk[0] = '\r';
+            chunk[1] = '\n';
+            for (size_t remaining = bytesRead; remaining > 0; remaining >>= 4) {
+                *--chunk = hexDigits[remaining & 0xF];
+            }
+            data[bytesRead] = '\r';
+            data[bytesRead + 1] = '\n';
+            if (!write(chunk, static_cast<size_t>(data + bytesRead + 2 - chunk))) {
+                return false;
+            }
+        }
+        else if (!write(data, bytesRead)) {
+            return false;
+        }
+        written += bytesRead;
+        context.requestBytes = written;
+    }
+
+    if (chunked) {
+        std::string last = "0\r\n";
+        for (const auto& [name, value] : body.Trailers()) {
+            last += name + ": " + value + "\r\n";
+        }
+        last += "\r\n";
+        return write(last.data(), last.size());
+    }
+    if (written != *length) {
+        return fail("Request body is shorter than its declared size");
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the response body into the given string
+ *
+ * Bulk downloads used to allocate a temporary buffer per chunk and copy it into a
+ * second string. The body is now read straight into the tail of the output string,
+ * which is reserved up front from Content-Length (up to kMaxBodyPreallocation) when the server provides one, so
+ * each byte is copied exactly once out of WinHTTP.
+ *
+ * The body is accounted against the request's memory reservation, which grows
+ * as data arrives. Reading stops early, and the partial body is freed, when
+ * the body exceeds maxBodyBytes or the budget cannot cover it; a Content-Length
+ * that already exceeds either limit is rejected before any data is read.
+ *
+ * With config.on_body_data the body is handed over as each read completes,
+ * through one buffer covered by the reservation taken at admission, so a
+ * long-lived stream is delivered as it arrives and never accumulates.
+ *
+ * @param context The request context holding the response and its reservation
+ * @param hRequest The request handle to read from
+ * @param config The request configuration
+ * @return true if the whole body was read
+ */
+bool Network::ReadResponseBody(RequestContext& context, HINTERNET hRequest, const RequestConfig& config) {
+    std::string& body = context.response.body;
+    size_t maxBodyBytes = config.max_body_bytes;
+    auto truncated = [&context]() {
+        context.response.error_message = "Connection was terminated while reading the response body";
+        context.response.error_type = ErrorType::Connection;
+        return false;
+    };
+
+    if (config.on_body_data) {
+        std::vector<char> buffer(kResponseReservation);
+        uint64_t delivered = 0;
+        DWORD bytesAvailable = 0;
+        while (true) {
+            if (!WinHttpQueryDataAvailable(hRequest, &bytesAvailable)) {
+                return truncated();
+            }
+            if (bytesAvailable == 0) {
+                return true;
+            }
+            DWORD bytesRead = 0;
+            if (!WinHttpReadData(hRequest, buffer.data(), std::min<DWORD>(bytesAvailable, static_cast<DWORD>(buffer.size())), &bytesRead) ||
+                bytesRead == 0) {
+                return truncated();
             }
+            delivered += bytesRead;
+            if (maxBodyBytes != 0 && delivered > maxBodyBytes) {
+                context.response.error_message = "Response body exceeds max_body_bytes";
+                context.response.error_type = ErrorType::ResourceLimit;
+                return false;
+            }
+            if (!config.on_body_data(buffer.data(), bytesRead)) {
+                context.response.error_message = "Response body aborted by on_body_data";
+                context.response.error_type = ErrorType::Other;
+                return false;
+            }
+        }
+    }
+
+    ULONGLONG contentLength = 0;
+    DWORD size = sizeof(contentLength);
+    if (WinHttpQueryHeaders(
+            hRequest,
+            WINHTTP_QUERY_CONTENT_LENGTH | WINHTTP_QUERY_FLAG_NUMBER64,
+            WINHTTP_HEADER_NAME_BY_INDEX,
+            &contentLength,
+            &size,
+            WINHTTP_NO_HEADER_INDEX) && contentLength > 0) {
+        if (!ReserveResponseBody(context, contentLength, maxBodyBytes)) {
+            return false;
         }
+        body.reserve(static_cast<size_t>(std::min<ULONGLONG>(contentLength, kMaxBodyPreallocation)));
     }
 
-    // Get response body
-    std::string responseBody;
-    DWORD bytesAvailable;
+    DWORD bytesAvailable = 0;
     do {
         bytesAvailable = 0;
         if (!WinHttpQueryDataAvailable(hRequest, &bytesAvailable)) {
-            break;
+            return truncated();
         }
-
         if (bytesAvailable == 0) {
             break;
         }
 
-        std::vector<char> buffer(bytesAvailable);
+        size_t offset = body.size();
+        if (!ReserveResponseBody(context, offset + bytesAvailable, maxBodyBytes)) {
+            return false;
+        }
+        body.resize(offset + bytesAvailable);
+
         DWORD bytesRead = 0;
-        if (WinHttpReadData(hRequest, buffer.data(), bytesAvailable, &bytesRead)) {
-            responseBody.append(buffer.data(), bytesRead);
+        if (!WinHttpReadData(hRequest, &body[offset], bytesAvailable, &bytesRead)) {
+            body.resize(offset);
+            return truncated();
         }
+        body.resize(offset + bytesRead);
     } while (bytesAvailable > 0);
+    return true;
+}
 
-    response.body = responseBody;
-    response.success = (statusCode >= 200 && statusCode < 300);
-    
-    // Cleanup
-    WinHttpCloseHandle(hRequest);
-    WinHttpCloseHandle(hConnect);
+/**
+ * @brief Grows the request's reservation to cover a response body
+ *
+ * Reservations grow in kResponseReservation steps to limit contention on the
+ * budget, falling back to the exact shortfall when a full step does not fit.
+ *
+ * @param context The request context holding the response and its reservation
+ * @param bodySize The body size to cover
+ * @param maxBodyBytes The largest body accepted, or 0 for no limit
+ * @return true if the body may grow to bodySize
+ */
+bool Network::ReserveResponseBody(RequestContext& context, uint64_t bodySize, size_t maxBodyBytes) {
+    NetworkBudget::Reservation& budget = context.budget;
+    auto abortBody = [&](const char* message, bool overBudget) {
+        context.response.body.clear();
+        context.response.body.shrink_to_fit();
+        context.response.error_message = message;
+        context.response.error_type = ErrorType::ResourceLimit;
+        if (overBudget) {
+            NetworkBudget::CountRejection();
+        }
+        return false;
+    };
 
-    return response;
+    if (maxBodyBytes != 0 && bodySize > maxBodyBytes) {
+        return abortBody("Response body exceeds max_body_bytes", false);
+    }
+    if (bodySize > SIZE_MAX) {
+        return abortBody("Response body too large", false);
+    }
+    size_t needed = static_cast<size_t>(bodySize);
+    if (needed > budget.Size() &&
+        !budget.TryGrow(std::max(needed - budget.Size(), kResponseReservation)) &&
+        !budget.TryGrow(needed - budget.Size())) {
+        return abortBody("Memory budget exhausted", true);
+    }
+    return true;
 }
 
 /**
@@ -472,6 +2229,26 @@ Network::NetworkResponse Network::Post(
     return Request(Method::HTTP_POST, url, payload, cfg);
 }
 
+/**
+ * @brief Sends a POST request with a streamed body
+ *
+ * @param url The URL to send the request to
+ * @param body The source of the request body
+ * @param content_type The content type of the body
+ * @param config The request configuration
+ * @return The response from the server
+ */
+Network::NetworkResponse Network::Post(
+    const std::string& url,
+    BodySource& body,
+    const std::string& content_type,
+    const RequestConfig& config
+) {
+    RequestConfig cfg = config;
+    cfg.additional_headers["Content-Type"] = content_type;
+    return Request(Method::HTTP_POST, url, body, cfg);
+}
+
 /**
  * @brief Sends an asynchronous POST request
  * 
@@ -570,16 +2347,70 @@ bool Network::ParseUrl(
     // Default ports
     port = (protocol == "https") ? 443 : 80;
 
-    // Check for custom port
-    size_t port_sep = host.find(':');
+    // Check for custom port; a Unix socket host is a path, which may contain a drive colon
+    size_t port_sep = NetworkUnixSocket::IsUnixScheme(protocol) ? std::string::npos : host.find(':');
     if (port_sep != std::string::npos) {
-        port = std::stoi(host.substr(port_sep + 1));
+        std::string portText = host.substr(port_sep + 1);
+        if (portText.empty() || portText.size() > 5 ||
+            !std::all_of(portText.begin(), portText.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) {
+            return false;  // Also reached by redirect locations, which are not trusted
+        }
+        port = std::stoi(portText);
         host = host.substr(0, port_sep);
     }
 
     return true;
 }
 
+/**
+ * @brief Parses raw WinHTTP response headers into a map
+ * 
+ * The status line and blank lines are skipped; header names and values are
+ * narrowed to std::string.
+ * 
+ * @param rawHeaders The CRLF-separated raw headers
+ * @param headers The map to add the parsed headers to
+ */
+void Network::ParseResponseHeaders(const std::wstring& rawHeaders, std::map<std::string, std::string>& headers) {
+    std::wistringstream headerStream(rawHeaders);
+    std::wstring line;
+
+    while (std::getline(headerStream, line)) {
+        if (line.empty() || line == L"\r") continue;
+        
+        size_t colonPos = line.find(L':');
+        if (colonPos != std::wstring::npos) {
+            std::wstring key = line.substr(0, colonPos);
+            std::wstring value = line.substr(colonPos + 2); // Skip ": "
+            if (!value.empty() && value.back() == L'\r') {
+                value.pop_back(); // Remove trailing \r
+            }
+            
+            // Convert to narrow string
+            std::string keyStr(key.begin(), key.end());
+            std::string valueStr(value.begin(), value.end());
+            headers[keyStr] = valueStr;
+        }
+    }
+}
+
+/**
+ * @brief Returns the request-line token of an HTTP method
+ * 
+ * @param method The HTTP method
+ * @return The method name, e.g. "GET"
+ */
+const char* Network::MethodName(Method method) {
+    switch (method) {
+        case Method::HTTP_GET:    return "GET";
+        case Method::HTTP_POST:   return "POST";
+        case Method::HTTP_PUT:    return "PUT";
+        case Method::HTTP_PATCH:  return "PATCH";
+        case Method::HTTP_DELETE: return "DELETE";
+        default:                  return "GET";
+    }
+}
+
 /**
  * @brief URL-encodes a string
  * 
@@ -25,7 +25,10 @@
 #define NETWORK_HPP
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <list>
+#include <cstdint>
 #include <optional>
 #include <chrono>
 #include <functional>
@@ -37,6 +40,8 @@
 #pragma comment(lib, "wininet.lib")
 #endif
 
+class JsonDocument;
+
  /**
   * @brief Main networking class providing HTTP communication capabilities
   *
@@ -56,16 +61,42 @@ public:
         HTTP_DELETE                                             ///< HTTP DELETE method
     };
 
+    /**
+     * @brief Classes of request failure
+     */
+    enum class ErrorType {
+        None,                                                   ///< Request succeeded
+        InvalidUrl,                                             ///< URL could not be parsed
+        RateLimited,                                            ///< Rejected by the client-side rate limiter
+        Dns,                                                    ///< Name resolution failed
+        Connect,                                                ///< TCP connection could not be established
+        Tls,                                                    ///< TLS handshake or certificate validation failed
+        Timeout,                                                ///< Request timed out
+        Connection,                                             ///< Connection was reset or terminated
+        Http,                                                   ///< Server answered with a non-2xx status
+        Other,                                                  ///< Any other failure
+        ResourceLimit                                           ///< Memory budget, max_body_bytes or host concurrency limit exceeded
+    };
+
+    /**
+     * @brief Scheduling priority of a request
+     */
+    enum class Priority {
+        Interactive,                                            ///< Dispatched ahead of every Normal request
+        Normal                                                  ///< Shares slots by weighted fair queuing across flows
+    };
+
     /**
      * @brief Configuration options for HTTP requests
      */
     struct RequestConfig {
         int timeout_seconds = 30;                               ///< Request timeout in seconds
-        bool follow_redirects = true;                           ///< Whether to follow HTTP redirects
-        int max_redirects = 5;                                  ///< Maximum number of redirects to follow
+        bool follow_redirects = true;                           ///< Whether to follow HTTP redirects (301, 302, 303, 307, 308)
+        int max_redirects = 5;                                  ///< Maximum number of redirects to follow, cached ones included
         std::map<std::string, std::string> additional_headers;  ///< Custom headers
         bool verify_ssl = true;                                 ///< Enable SSL certificate verification
         bool use_tls12_or_higher = true;                        ///< Enforce TLS 1.2 or higher
+        bool check_revocation = false;                          ///< Check certificate revocation (CRL/OCSP), cached per certificate
         int max_retries = 3;                                    ///< Number of retry attempts
         int retry_delay_ms = 1000;                              ///< Delay between retries in milliseconds
         std::string api_key;                                    ///< API key for authentication
@@ -73,17 +104,131 @@ public:
         int rate_limit_per_minute = 0;                          ///< Rate limiting (0 = disabled)
         bool use_http2 = true;                                  ///< Use HTTP/2 if available
         bool async_request = false;                             ///< Make request asynchronously
+        std::string routing_key;                                ///< Consistent-hash key for load-balanced services using Maglev routing
+        Priority priority = Priority::Normal;                   ///< Scheduling class when requests queue for a slot
+        std::string flow;                                       ///< Fair-queuing flow, e.g. a tenant or job name
+        int weight = 1;                                         ///< Share of slots for the flow relative to other flows
+        size_t max_body_bytes = 0;                              ///< Abort responses with larger bodies (0 = unlimited)
+        std::function<bool(const char* data, size_t size)> on_body_data;  ///< Receives the response body as it arrives instead of NetworkResponse::body; return false to abort
     };
 
     /**
      * @brief HTTP response structure
      */
     struct NetworkResponse {
+        /**
+         * @brief Monotonic timestamps of each request phase
+         *
+         * Phases that did not happen (DNS, connect and TLS on a reused connection)
+         * keep a default-constructed time point and report a zero duration.
+         */
+        struct Timings {
+            using Clock = std::chrono::steady_clock;
+
+            Clock::time_point start;                            ///< Request entered
+            Clock::time_point dequeued;                         ///< Request slot acquired
+            Clock::time_point rate_limited;                     ///< Rate limit check passed
+            Clock::time_point dns_start;                        ///< Name resolution started
+            Clock::time_point dns_end;                          ///< Name resolved
+            Clock::time_point connect_start;                    ///< TCP connect started
+            Clock::time_point connect_end;                      ///< TCP connection established
+            Clock::time_point send_start;                       ///< Request sending started (after TLS)
+            Clock::time_point request_sent;                     ///< Request fully sent
+            Clock::time_point first_byte;                       ///< First response byte received
+            Clock::time_point last_byte;                        ///< Last body byte received
+            bool connection_reused = false;                     ///< Whether a pooled connection was used
+
+            std::chrono::nanoseconds QueueWait() const { return Between(start, dequeued); }
+            std::chrono::nanoseconds RateLimitWait() const { return Between(dequeued, rate_limited); }
+            std::chrono::nanoseconds Dns() const { return Between(dns_start, dns_end); }
+            std::chrono::nanoseconds Connect() const { return Between(connect_start, connect_end); }
+            std::chrono::nanoseconds Tls() const { return Between(connect_end, send_start); }
+            std::chrono::nanoseconds Send() const { return Between(send_start, request_sent); }
+            std::chrono::nanoseconds TimeToFirstByte() const { return Between(request_sent, first_byte); }
+            std::chrono::nanoseconds Download() const { return Between(first_byte, last_byte); }
+            std::chrono::nanoseconds Total() const { return Between(start, last_byte); }
+
+        private:
+            static std::chrono::nanoseconds Between(Clock::time_point from, Clock::time_point to) {
+                if (from == Clock::time_point() || to == Clock::time_point() || to < from) {
+                    return std::chrono::nanoseconds(0);
+                }
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from);
+            }
+        };
+
         int status_code = 0;                                    ///< HTTP status code
         std::string body;                                       ///< Response body
         std::map<std::string, std::string> headers;             ///< Response headers
         bool success = false;                                   ///< Whether request was successful
         std::string error_message;                              ///< Error message if request failed
+        ErrorType error_type = ErrorType::None;                 ///< Class of failure if request failed
+        Timings timings;                                        ///< Per-phase latency breakdown
+        std::string final_url;                                  ///< URL that produced this response, after redirects
+        int redirects = 0;                                      ///< Redirects followed, cached ones included
+        int retries = 0;                                        ///< Retries made by RetryLayer (NetworkMiddleware.hpp)
+
+        /**
+         * @brief Index the body as JSON for on-demand access (include NetworkJson.hpp and link NetworkJson.cpp)
+         *
+         * The body is not copied; the document must not outlive the response or a change to body.
+         */
+        JsonDocument json() const;
+    };
+
+    /**
+     * @brief Request body produced incrementally instead of held in one string
+     *
+     * The body is pulled in fixed-size chunks while the request is being sent,
+     * so only one chunk is in memory at a time. Sources are read once; a request
+     * that must be repeated needs a new source.
+     *
+     * Bodies of unknown size are sent with chunked transfer encoding, which
+     * also carries any trailers the source reports once it is exhausted.
+     */
+    class BodySource {
+    public:
+        virtual ~BodySource() = default;
+
+        /**
+         * @brief Total body size, sent as Content-Length
+         * @return Size in bytes, or std::nullopt to send the body chunked
+         */
+        virtual std::optional<uint64_t> Size() const = 0;
+
+        /**
+         * @brief Produce the next bytes of the body
+         * @param buffer Destination
+         * @param capacity Bytes available in buffer
+         * @param bytesRead Receives the bytes written; 0 once the body is complete
+         * @return false if the body could not be produced, which aborts the request
+         */
+        virtual bool Read(char* buffer, size_t capacity, size_t& bytesRead) = 0;
+
+        /**
+         * @brief Trailer fields sent after a chunked body
+         *
+         * Called once Read has reported the end of the body. Ignored for
+         * bodies of known size, which are not sent chunked.
+         */
+        virtual std::map<std::string, std::string> Trailers() { return {}; }
+
+        /**
+         * @brief Next block of a body already held in memory
+         *
+         * Sources that keep their body in memory override this so their
+         * blocks are sent as they are instead of being copied out with Read.
+         * Used only for bodies of known size.
+         *
+         * @param block Receives the next block; empty once the body is complete
+         * @return false if the source has no blocks to offer, in which case Read is used
+         */
+        virtual bool NextBlock(std::string_view& /*block*/) { return false; }
+
+        /**
+         * @brief Called when the request stops reading the body, whether or not it was sent completely
+         */
+        virtual void Done() {}
     };
 
     /**
@@ -97,6 +242,39 @@ public:
      */
     static void Cleanup();
 
+    /**
+     * @brief Drop all cached certificate verification results
+     */
+    static void ClearCertificateCache();
+
+    /**
+     * @brief Forget all cached permanent redirects
+     */
+    static void ClearRedirectCache();
+
+    /**
+     * @brief Treat a header as a credential, in addition to the built-in ones
+     *
+     * Credential headers are dropped when a redirect leaves the origin and
+     * redacted in HAR exports. AuthLayer registers its API-key header.
+     *
+     * @param name Header name, matched case-insensitively
+     */
+    static void AddCredentialHeader(const std::string& name);
+
+    /**
+     * @brief Whether a request or response header carries a credential
+     *
+     * True for Authorization, Proxy-Authorization, Cookie, Set-Cookie,
+     * X-API-Key, Api-Key, X-Auth-Token, headers added with AddCredentialHeader,
+     * and any header whose value carries the request's api_key or oauth_token.
+     *
+     * @param name Header name
+     * @param value Header value
+     * @param config Configuration of the request the header belongs to
+     */
+    static bool IsCredentialHeader(const std::string& name, const std::string& value, const RequestConfig& config);
+
     /**
      * @brief Make an HTTP request
      * @param method HTTP method to use
@@ -112,6 +290,21 @@ public:
         const RequestConfig& config = RequestConfig()
     );
 
+    /**
+     * @brief Make an HTTP request with a streamed body
+     * @param method HTTP method to use
+     * @param url Target URL
+     * @param body Request body, read while the request is sent
+     * @param config Request configuration
+     * @return NetworkResponse containing the response or error
+     */
+    static NetworkResponse Request(
+        Method method,
+        const std::string& url,
+        BodySource& body,
+        const RequestConfig& config = RequestConfig()
+    );
+
     /**
      * @brief Make a GET request
      * @param url Target URL
@@ -138,6 +331,21 @@ public:
         const RequestConfig& config = RequestConfig()
     );
 
+    /**
+     * @brief Make a POST request with a streamed body
+     * @param url Target URL
+     * @param body Request body, read while the request is sent
+     * @param content_type Content type of the body
+     * @param config Request configuration
+     * @return NetworkResponse containing the response or error
+     */
+    static NetworkResponse Post(
+        const std::string& url,
+        BodySource& body,
+        const std::string& content_type,
+        const RequestConfig& config = RequestConfig()
+    );
+
     /**
      * @brief Make a PUT request
      * @param url Target URL
@@ -207,6 +415,13 @@ public:
         std::function<void(NetworkResponse)> callback,
         const RequestConfig& config = RequestConfig()
     );
+    /**
+     * @brief Get the request-line token of an HTTP method
+     * @param method HTTP method
+     * @return Method name such as "GET"
+     */
+    static const char* MethodName(Method method);
+
     /**
      * @brief URL encode a string
      * @param input String to encode
@@ -221,7 +436,6 @@ public:
      */
     static std::string Base64Encode(const std::string& input);
 
-private:
     /**
      * @brief Parse a URL into its components
      * @param url URL to parse
@@ -239,9 +453,145 @@ private:
         int& port
     );
 
+    /**
+     * @brief Parse raw response headers as returned by WINHTTP_QUERY_RAW_HEADERS_CRLF
+     * @param rawHeaders Status line followed by CRLF-separated "Name: value" lines
+     * @param headers Output map the headers are added to
+     */
+    static void ParseResponseHeaders(const std::wstring& rawHeaders, std::map<std::string, std::string>& headers);
+
+private:
+    friend class NetworkLoadBalancer;                           // Sends health probes through Probe
+
+    /**
+     * @brief Per-request state shared between Request, SendRequest and RecordPhase
+     */
+    struct RequestContext;
+
+    /**
+     * @brief Send a health probe GET straight to the transport
+     *
+     * Bypasses the scheduler, the memory budget, the concurrency limiter, load
+     * balancing, redirects, replay, metrics and HAR export, so that probes on the
+     * shared timer thread never queue behind other traffic. The body is discarded.
+     *
+     * @param url Probe URL
+     * @param config Request configuration (timeout, TLS options)
+     * @return NetworkResponse with status and headers
+     */
+    static NetworkResponse Probe(const std::string& url, const RequestConfig& config);
+
+    /**
+     * @brief WinHTTP status callback stamping request phases and verifying connections before the request is sent
+     * @param hInternet Handle the notification is for
+     * @param context RequestContext pointer passed to WinHttpSendRequest
+     * @param status WINHTTP_CALLBACK_STATUS_* notification
+     * @param info Notification-specific data
+     * @param infoLength Size of info
+     */
+    static void CALLBACK RecordPhase(HINTERNET hInternet, DWORD_PTR context, DWORD status, LPVOID info, DWORD infoLength);
+
+    /**
+     * @brief Common implementation of the Request overloads
+     * @param method HTTP method to use
+     * @param url Target URL
+     * @param payload Request body held in memory, if any
+     * @param body Streamed request body, if any (exclusive with payload)
+     * @param config Request configuration
+     * @return NetworkResponse containing the response or error
+     */
+    static NetworkResponse Perform(
+        Method method,
+        const std::string& url,
+        const std::optional<std::string>& payload,
+        BodySource* body,
+        const RequestConfig& config
+    );
+
+    /**
+     * @brief Perform the WinHTTP exchange for an already parsed URL
+     * @param context Request context holding the response to fill in
+     * @param method HTTP method to use
+     * @param protocol URL protocol (http/https)
+     * @param host Target host
+     * @param path Request path
+     * @param port Target port
+     * @param payload Optional request body
+     * @param body Optional streamed request body
+     * @param config Request configuration
+     */
+    static void SendRequest(
+        RequestContext& context,
+        Method method,
+        const std::string& protocol,
+        const std::string& host,
+        const std::string& path,
+        int port,
+        const std::optional<std::string>& payload,
+        BodySource* body,
+        const RequestConfig& config
+    );
+
+    /**
+     * @brief Perform the exchange for a http+unix:// URL over a pooled Unix domain socket
+     * @param context Request context holding the response to fill in
+     * @param method HTTP method to use
+     * @param socketPath Decoded socket path
+     * @param path Request path
+     * @param payload Optional request body
+     * @param body Optional streamed request body
+     * @param config Request configuration
+     */
+    static void SendUnixRequest(
+        RequestContext& context,
+        Method method,
+        const std::string& socketPath,
+        const std::string& path,
+        const std::optional<std::string>& payload,
+        BodySource* body,
+        const RequestConfig& config
+    );
+
+    /**
+     * @brief Write a streamed request body once the request headers are out
+     * @param context Request context holding the response
+     * @param write Sends bytes on the request's connection; returns false on transport failure
+     * @param body Body to stream
+     * @param length Size announced in Content-Length, or std::nullopt to send the body chunked
+     * @return false on failure; source errors are recorded in the response, transport errors are left to the caller
+     */
+    static bool WriteRequestBody(
+        RequestContext& context,
+        const std::function<bool(const char* data, size_t size)>& write,
+        BodySource& body,
+        std::optional<uint64_t> length
+    );
+
+    /**
+     * @brief Account for a response body growing to bodySize
+     *
+     * Grows the request's memory reservation to cover the body. On failure the
+     * partial body is freed and the response error set.
+     *
+     * @param context Request context holding the response and its reservation
+     * @param bodySize Body size to cover
+     * @param maxBodyBytes Largest body accepted (0 = unlimited)
+     * @return false if the body exceeds max_body_bytes or the memory budget
+     */
+    static bool ReserveResponseBody(RequestContext& context, uint64_t bodySize, size_t maxBodyBytes);
+
+    /**
+     * @brief Read the full response body of a request into context.response.body, or pass it to config.on_body_data
+     * @param context Request context holding the response and its memory reservation
+     * @param hRequest Request handle whose response headers have been received
+     * @param config Request configuration (max_body_bytes, on_body_data)
+     * @return false if the body was aborted for exceeding max_body_bytes or the memory budget, or by on_body_data,
+     *         or if the connection failed before the body was complete
+     */
+    static bool ReadResponseBody(RequestContext& context, HINTERNET hRequest, const RequestConfig& config);
+
     static HINTERNET hSession;                                  ///< Global WinHTTP session handle
     static std::mutex sessionMutex;                             ///< Mutex for session handle access
-    static std::mutex requestMutex;                             ///< Mutex for request synchronization
 
     // Rate limiting support
     struct RateLimitInfo {
@@ -251,6 +601,63 @@ private:
     static std::map<std::string, RateLimitInfo> rateLimitMap;   ///< Rate limit tracking per host
     static std::mutex rateLimitMutex;                           ///< Mutex for rate limit map access
 
+    // Verified certificate cache
+    struct CertificateCacheEntry {
+        std::chrono::system_clock::time_point expires;          ///< Earliest of notAfter, CRL nextUpdate and the cache TTL
+    };
+    static std::map<std::string, CertificateCacheEntry> certificateCache;  ///< Keyed by host and leaf SHA-256
+    static std::mutex certificateCacheMutex;                    ///< Mutex for certificate cache access
+
+    // Permanent (301/308) redirect cache, bounded and least recently used first out
+    struct RedirectCacheEntry {
+        std::string location;                                   ///< Absolute target URL
+        int status_code = 0;                                    ///< 301 or 308
+        std::chrono::steady_clock::time_point expires;          ///< From Cache-Control max-age, or the default TTL
+        std::list<std::string>::iterator order;                 ///< Position in redirectCacheOrder
+    };
+    static std::map<std::string, RedirectCacheEntry> redirectCache;  ///< Keyed by the redirecting URL
+    static std::list<std::string> redirectCacheOrder;           ///< Cached URLs, most recently used first
+    static std::mutex redirectCacheMutex;                       ///< Mutex for redirect cache access
+
+    static std::list<std::string> credentialHeaders;            ///< Registered with AddCredentialHeader
+    static std::mutex credentialHeadersMutex;                   ///< Mutex for credentialHeaders access
+
+    /**
+     * @brief Look up a cached permanent redirect
+     * @param url URL about to be requested
+     * @param location Receives the URL it redirects to
+     * @param statusCode Receives the redirect status (301 or 308)
+     * @return true if a live entry was found
+     */
+    static bool LookupRedirect(const std::string& url, std::string& location, int& statusCode);
+
+    /**
+     * @brief Remember a permanent redirect, unless its Cache-Control forbids it
+     * @param url URL that answered with the redirect
+     * @param location Absolute URL it redirects to
+     * @param statusCode 301 or 308
+     * @param headers Response headers (Cache-Control)
+     */
+    static void CacheRedirect(const std::string& url, const std::string& location, int statusCode,
+                              const std::map<std::string, std::string>& headers);
+
+    /**
+     * @brief Verifies the server certificate chain including revocation
+     * @param hRequest Request handle whose TLS handshake has completed
+     * @param host Host name the certificate must be valid for
+     * @param error Output error message if verification fails
+     * @return true if the certificate is valid, false otherwise
+     */
+    static bool VerifyServerCertificate(HINTERNET hRequest, const std::string& host, std::string& error);
+
+    /**
+     * @brief Runs the checks a request's connection must pass before the request is sent
+     * @param hRequest Request handle whose connection is established
+     * @param context Request context naming the checks; receives the error on failure
+     * @return true if the request may be sent on this connection
+     */
+    static bool VerifyConnection(HINTERNET hRequest, RequestContext& context);
+
     /**
      * @brief Applies rate limiting for a host
      * @param host The host to rate limit
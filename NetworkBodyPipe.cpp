@@ -0,0 +1,105 @@
+/**
+ * @file NetworkBodyPipe.cpp
+ * @brief Implementation of the producer-fed request body pipe
+ */
+
+#include "NetworkBodyPipe.hpp"
+#include <algorithm>
+#include <cstring>
+
+NetworkBodyPipe::NetworkBodyPipe(size_t capacity) : ring(std::max<size_t>(capacity, 1)) {
+}
+
+NetworkBodyPipe::~NetworkBodyPipe() {
+    // A request that never ran never calls Done; release the producer here
+    Done();
+    if (producerThread.joinable()) {
+        producerThread.join();
+    }
+}
+
+void NetworkBodyPipe::Start(Producer producer) {
+    producerThread = std::thread([this, producer = std::move(producer)]() {
+        if (producer(*this)) {
+            Close();
+        }
+        else {
+            Abort();
+        }
+    });
+}
+
+/**
+ * @brief Copies into the ring as space frees up
+ *
+ * Blocks while the ring is full; that wait is the backpressure on the producer.
+ */
+bool NetworkBodyPipe::Write(const char* data, size_t size) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (size > 0) {
+        spaceAvailable.wait(lock, [this]() { return buffered < ring.size() || readerDone || aborted; });
+        if (readerDone || aborted || closed) {
+            return false;
+        }
+
+        size_t writePosition = (readPosition + buffered) % ring.size();
+        size_t length = std::min({ size, ring.size() - buffered, ring.size() - writePosition });
+        std::memcpy(ring.data() + writePosition, data, length);
+        buffered += length;
+        data += length;
+        size -= length;
+        dataAvailable.notify_one();
+    }
+    return true;
+}
+
+void NetworkBodyPipe::Close(std::map<std::string, std::string> fields) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed || aborted) {
+        return;
+    }
+    trailers = std::move(fields);
+    closed = true;
+    dataAvailable.notify_one();
+}
+
+void NetworkBodyPipe::Abort() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) {
+        return;
+    }
+    aborted = true;
+    dataAvailable.notify_one();
+    spaceAvailable.notify_one();
+}
+
+bool NetworkBodyPipe::Read(char* buffer, size_t capacity, size_t& bytesRead) {
+    bytesRead = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    dataAvailable.wait(lock, [this]() { return buffered > 0 || closed || aborted; });
+    if (aborted) {
+        return false;
+    }
+
+    // Drain what is buffered, in up to two copies around the end of the ring
+    while (bytesRead < capacity && buffered > 0) {
+        size_t length = std::min({ capacity - bytesRead, buffered, ring.size() - readPosition });
+        std::memcpy(buffer + bytesRead, ring.data() + readPosition, length);
+        readPosition = (readPosition + length) % ring.size();
+        buffered -= length;
+        bytesRead += length;
+    }
+    spaceAvailable.notify_one();
+    return true;
+}
+
+std::map<std::string, std::string> NetworkBodyPipe::Trailers() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return trailers;
+}
+
+void NetworkBodyPipe::Done() {
+    std::lock_guard<std::mutex> lock(mutex);
+    readerDone = true;
+    spaceAvailable.notify_one();
+}
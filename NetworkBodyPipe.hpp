@@ -0,0 +1,120 @@
+/**
+ * @file NetworkBodyPipe.hpp
+ * @brief Request body written by a producer while the request is being sent
+ *
+ * For bodies whose size is not known in advance: generated exports, or a
+ * stream proxied from elsewhere. A producer writes into a bounded buffer and
+ * Network reads from it, sending the body with chunked transfer encoding.
+ * Write blocks while the buffer is full, so a producer can never run further
+ * ahead of the network than the buffer's capacity, however large the body.
+ *
+ * @code
+ * NetworkBodyPipe pipe;
+ * pipe.Start([](NetworkBodyPipe& out) {
+ *     while (auto row = NextRow()) {
+ *         if (!out.Write(row->data(), row->size())) {
+ *             return false;  // The request failed; stop producing
+ *         }
+ *     }
+ *     out.Close({ { "X-Row-Count", std::to_string(count) } });
+ *     return true;
+ * });
+ * auto response = Network::Post(url, pipe, "text/csv");
+ * @endcode
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_BODY_PIPE_HPP
+#define NETWORK_BODY_PIPE_HPP
+
+#include "Network.hpp"
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Bounded single-producer pipe feeding a chunked request body
+ */
+class NetworkBodyPipe : public Network::BodySource {
+public:
+    /**
+     * @brief Producer run on the pipe's own thread; returning false aborts the request
+     */
+    using Producer = std::function<bool(NetworkBodyPipe& pipe)>;
+
+    /**
+     * @brief Create a pipe
+     * @param capacity Bytes buffered between producer and request before Write blocks
+     */
+    explicit NetworkBodyPipe(size_t capacity = 1024 * 1024);
+
+    /**
+     * @brief Waits for the producer thread, if Start was used
+     */
+    ~NetworkBodyPipe();
+
+    NetworkBodyPipe(const NetworkBodyPipe&) = delete;
+    NetworkBodyPipe& operator=(const NetworkBodyPipe&) = delete;
+
+    /**
+     * @brief Run a producer on a thread owned by the pipe
+     *
+     * The pipe is closed when the producer returns true without closing it,
+     * and aborted when it returns false.
+     *
+     * @param producer Function writing the body
+     */
+    void Start(Producer producer);
+
+    /**
+     * @brief Append to the body, blocking while the buffer is full
+     * @param data Bytes to append
+     * @param size Number of bytes
+     * @return false if the request no longer reads the body (failed, or the pipe was aborted)
+     */
+    bool Write(const char* data, size_t size);
+
+    /**
+     * @brief Append to the body
+     * @param data Bytes to append
+     * @return false if the request no longer reads the body
+     */
+    bool Write(const std::string& data) { return Write(data.data(), data.size()); }
+
+    /**
+     * @brief End the body
+     * @param trailers Trailer fields sent after the last chunk
+     */
+    void Close(std::map<std::string, std::string> trailers = {});
+
+    /**
+     * @brief Fail the request instead of ending the body
+     */
+    void Abort();
+
+    std::optional<uint64_t> Size() const override { return std::nullopt; }
+    bool Read(char* buffer, size_t capacity, size_t& bytesRead) override;
+    std::map<std::string, std::string> Trailers() override;
+    void Done() override;
+
+private:
+    std::vector<char> ring;
+    size_t readPosition = 0;
+    size_t buffered = 0;                                        // Bytes between readPosition and the write position
+    bool closed = false;
+    bool aborted = false;
+    bool readerDone = false;                                    // The request has stopped reading
+    std::map<std::string, std::string> trailers;
+    std::mutex mutex;
+    std::condition_variable dataAvailable;
+    std::condition_variable spaceAvailable;
+    std::thread producerThread;
+};
+
+#endif // NETWORK_BODY_PIPE_HPP
@@ -0,0 +1,111 @@
+/**
+ * @file NetworkBudget.cpp
+ * @brief Implementation of the in-flight memory budget
+ */
+
+#include "NetworkBudget.hpp"
+#include <algorithm>
+
+// Initialize static members
+std::atomic<size_t> NetworkBudget::limit{0};
+std::atomic<size_t> NetworkBudget::inUse{0};
+std::atomic<uint64_t> NetworkBudget::rejected{0};
+std::atomic<int64_t> NetworkBudget::maxWaitMs{0};
+std::atomic<int> NetworkBudget::waiters{0};
+std::mutex NetworkBudget::waitMutex;
+std::condition_variable NetworkBudget::budgetFreed;
+
+NetworkBudget::Reservation::Reservation(Reservation&& other) noexcept : size(other.size) {
+    other.size = 0;
+}
+
+NetworkBudget::Reservation& NetworkBudget::Reservation::operator=(Reservation&& other) noexcept {
+    if (this != &other) {
+        Release();
+        size = other.size;
+        other.size = 0;
+    }
+    return *this;
+}
+
+NetworkBudget::Reservation::~Reservation() {
+    Release();
+}
+
+bool NetworkBudget::Reservation::TryGrow(size_t bytes) {
+    if (!TryReserve(bytes)) {
+        return false;
+    }
+    size += bytes;
+    return true;
+}
+
+void NetworkBudget::Reservation::Release() {
+    if (size > 0) {
+        Return(size);
+        size = 0;
+    }
+}
+
+void NetworkBudget::SetLimit(size_t bytes) {
+    limit.store(bytes, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(waitMutex);
+    budgetFreed.notify_all();  // A larger budget may admit waiting requests
+}
+
+void NetworkBudget::SetMaxWait(std::chrono::milliseconds wait) {
+    maxWaitMs.store(std::max<int64_t>(wait.count(), 0), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Adds to the in-use count if the budget allows it; never blocks
+ */
+bool NetworkBudget::TryReserve(size_t bytes) {
+    size_t current = inUse.load();
+    for (;;) {
+        size_t budget = limit.load(std::memory_order_relaxed);
+        if (budget != 0 && current + bytes > budget) {
+            return false;
+        }
+        if (inUse.compare_exchange_weak(current, current + bytes)) {
+            return true;
+        }
+    }
+}
+
+void NetworkBudget::Return(size_t bytes) {
+    // Sequentially consistent with the waiter count, so a waiter registering now sees the freed bytes
+    inUse.fetch_sub(bytes);
+    if (waiters.load() > 0) {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        budgetFreed.notify_all();
+    }
+}
+
+/**
+ * @brief Reserves a new request's bytes, waiting up to the admission wait
+ *
+ * The common case of an unlimited or uncontended budget is a single CAS.
+ */
+bool NetworkBudget::Admit(size_t bytes, Reservation& reservation) {
+    size_t budget = limit.load(std::memory_order_relaxed);
+    if (budget != 0) {
+        bytes = std::min(bytes, budget);  // Oversized requests need the whole budget, not more
+    }
+    if (TryReserve(bytes)) {
+        reservation.size += bytes;
+        return true;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(maxWaitMs.load(std::memory_order_relaxed));
+    std::unique_lock<std::mutex> lock(waitMutex);
+    waiters.fetch_add(1);
+    bool admitted = budgetFreed.wait_until(lock, deadline, [bytes]() { return TryReserve(bytes); });
+    waiters.fetch_sub(1);
+    if (!admitted) {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    reservation.size += bytes;
+    return true;
+}
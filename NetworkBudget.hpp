@@ -0,0 +1,118 @@
+/**
+ * @file NetworkBudget.hpp
+ * @brief Library-wide memory budget for in-flight request and response buffers
+ *
+ * Every request reserves its payload size plus an initial response allowance
+ * before it is sent, and grows the reservation as its response body arrives.
+ * When the budget cannot cover a new request it waits up to the configured
+ * admission wait and then fails with ErrorType::ResourceLimit. A response
+ * that outgrows what the budget can give is aborted the same way, as is one
+ * exceeding RequestConfig::max_body_bytes.
+ *
+ * Reservations are released when Network::Request returns; the body handed to
+ * the caller is no longer counted.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_BUDGET_HPP
+#define NETWORK_BUDGET_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief Global in-flight memory budget
+ */
+class NetworkBudget {
+public:
+    /**
+     * @brief Bytes held against the budget by one request
+     */
+    class Reservation {
+    public:
+        Reservation() = default;
+        Reservation(Reservation&& other) noexcept;
+        Reservation& operator=(Reservation&& other) noexcept;
+        Reservation(const Reservation&) = delete;
+        Reservation& operator=(const Reservation&) = delete;
+        ~Reservation();
+
+        /**
+         * @brief Reserve more bytes without waiting
+         * @param bytes Additional bytes
+         * @return false if the budget cannot cover them
+         */
+        bool TryGrow(size_t bytes);
+
+        size_t Size() const { return size; }                    ///< Bytes currently reserved
+
+    private:
+        friend class NetworkBudget;
+        void Release();
+
+        size_t size = 0;
+    };
+
+    /**
+     * @brief Set the budget
+     * @param bytes Bytes all in-flight requests may hold together (0 = unlimited, the default)
+     */
+    static void SetLimit(size_t bytes);
+
+    /**
+     * @brief Current budget (0 = unlimited)
+     */
+    static size_t GetLimit() { return limit.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Set how long a request may wait for budget before failing
+     * @param wait Maximum admission wait (0 = fail immediately, the default)
+     */
+    static void SetMaxWait(std::chrono::milliseconds wait);
+
+    /**
+     * @brief Bytes currently reserved by in-flight requests
+     */
+    static size_t InUse() { return inUse.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Requests refused admission or aborted for lack of budget
+     */
+    static uint64_t Rejected() { return rejected.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Admit a request (called by Network::Request)
+     *
+     * Requests larger than the whole budget are admitted once nothing else is reserved.
+     *
+     * @param bytes Bytes to reserve
+     * @param reservation Receives the reservation
+     * @return false if the budget stayed exhausted for the admission wait
+     */
+    static bool Admit(size_t bytes, Reservation& reservation);
+
+    /**
+     * @brief Count a response aborted because its reservation could not grow
+     */
+    static void CountRejection() { rejected.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    static bool TryReserve(size_t bytes);
+    static void Return(size_t bytes);
+
+    static std::atomic<size_t> limit;
+    static std::atomic<size_t> inUse;
+    static std::atomic<uint64_t> rejected;
+    static std::atomic<int64_t> maxWaitMs;
+    static std::atomic<int> waiters;                            ///< Admissions blocked on budgetFreed
+    static std::mutex waitMutex;
+    static std::condition_variable budgetFreed;
+};
+
+#endif // NETWORK_BUDGET_HPP
@@ -0,0 +1,305 @@
+/**
+ * @file NetworkCoalescing.cpp
+ * @brief Implementation of the HTTP/2 origin registry used for connection coalescing
+ */
+
+// winsock2.h must precede windows.h
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "NetworkCoalescing.hpp"
+#include <algorithm>
+#include <cctype>
+
+#pragma comment(lib, "ws2_32.lib")
+
+// Initialize static members
+std::atomic<bool> NetworkCoalescing::enabled{false};
+std::mutex NetworkCoalescing::registryMutex;
+std::map<std::string, NetworkCoalescing::Origin> NetworkCoalescing::origins;
+std::map<std::string, NetworkCoalescing::Alias> NetworkCoalescing::aliases;
+uint64_t NetworkCoalescing::generation = 0;
+std::atomic<uint64_t> NetworkCoalescing::coalescedRequests{0};
+std::atomic<uint64_t> NetworkCoalescing::directRequests{0};
+std::atomic<uint64_t> NetworkCoalescing::misdirected{0};
+
+// Origins are relearned (addresses and certificate) after this long
+static const std::chrono::minutes kOriginTtl(5);
+// Decisions follow DNS changes after this long
+static const std::chrono::seconds kAliasTtl(60);
+// A host whose coalesced request was refused goes direct for this long
+static const std::chrono::minutes kRefusedTtl(10);
+static const size_t kMaxOrigins = 256;
+static const size_t kMaxAliases = 4096;
+
+static std::string Lowercase(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+static std::string Key(const std::string& host, int port) {
+    return Lowercase(host) + ":" + std::to_string(port);
+}
+
+/**
+ * @brief Whether two sorted address lists share an address
+ */
+static bool Intersects(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+    auto i = a.begin();
+    auto j = b.begin();
+    while (i != a.end() && j != b.end()) {
+        if (*i == *j) {
+            return true;
+        }
+        if (*i < *j) {
+            ++i;
+        }
+        else {
+            ++j;
+        }
+    }
+    return false;
+}
+
+void NetworkCoalescing::Enable() {
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void NetworkCoalescing::Disable() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    enabled.store(false, std::memory_order_relaxed);
+    origins.clear();
+    aliases.clear();
+}
+
+/**
+ * @brief Finds an origin for a host, deciding once per kAliasTtl
+ *
+ * The decision needs the host's addresses, so it resolves the host outside
+ * the lock. Until some origin is known nothing is resolved at all, and a
+ * miss is reconsidered as soon as a new origin is added.
+ */
+std::string NetworkCoalescing::Resolve(const std::string& host, int port) {
+    std::string key = Key(host, port);
+    auto now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto self = origins.find(key);
+        if (origins.empty() || (self != origins.end() && self->second.expires > now)) {
+            directRequests.fetch_add(1, std::memory_order_relaxed);
+            return "";
+        }
+        auto alias = aliases.find(key);
+        if (alias != aliases.end() && alias->second.expires > now) {
+            if (alias->second.refused || (alias->second.origin.empty() && alias->second.generation == generation)) {
+                directRequests.fetch_add(1, std::memory_order_relaxed);
+                return "";
+            }
+            auto origin = origins.find(Key(alias->second.origin, port));
+            if (!alias->second.origin.empty() && origin != origins.end() && origin->second.expires > now) {
+                coalescedRequests.fetch_add(1, std::memory_order_relaxed);
+                return alias->second.origin;
+            }
+        }
+    }
+
+    std::vector<std::string> addresses = ResolveAddresses(host, port);
+    std::string suffix = ":" + std::to_string(port);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    Alias decision;
+    decision.generation = generation;
+    decision.expires = now + kAliasTtl;
+    for (const auto& [originKey, origin] : origins) {
+        if (origin.expires > now && originKey.size() > suffix.size() &&
+            originKey.compare(originKey.size() - suffix.size(), suffix.size(), suffix) == 0 &&
+            Intersects(origin.addresses, addresses) && Covers(origin.names, host)) {
+            decision.origin = originKey.substr(0, originKey.size() - suffix.size());
+            break;
+        }
+    }
+    decision.addresses = std::move(addresses);
+    Prune(now);
+    aliases[key] = decision;
+
+    if (decision.origin.empty()) {
+        directRequests.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        coalescedRequests.fetch_add(1, std::memory_order_relaxed);
+    }
+    return decision.origin;
+}
+
+bool NetworkCoalescing::NeedsOrigin(const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto origin = origins.find(Key(host, port));
+    return origin == origins.end() || origin->second.expires <= Clock::now();
+}
+
+void NetworkCoalescing::AddOrigin(const std::string& host, int port, const std::vector<std::string>& names) {
+    std::vector<std::string> addresses = ResolveAddresses(host, port);
+    if (addresses.empty() || names.empty()) {
+        return;
+    }
+    Origin origin;
+    origin.addresses = std::move(addresses);
+    for (const auto& name : names) {
+        origin.names.push_back(Lowercase(name));
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    auto now = Clock::now();
+    origin.expires = now + kOriginTtl;
+    Prune(now);
+    std::string key = Key(host, port);
+    if (origins.size() >= kMaxOrigins && origins.find(key) == origins.end()) {
+        return;
+    }
+    origins[key] = std::move(origin);
+    generation++;
+}
+
+void NetworkCoalescing::Forget(const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto now = Clock::now();
+    std::string key = Key(host, port);
+    if (aliases.find(key) == aliases.end()) {
+        Prune(now);
+    }
+    Alias& alias = aliases[key];
+    alias.origin.clear();
+    alias.refused = true;
+    alias.expires = now + kRefusedTtl;
+    misdirected.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool NetworkCoalescing::Admits(const std::string& host, int port, const sockaddr* peer,
+                               const std::vector<std::string>& names) {
+    std::string address = AddressText(peer);
+    if (address.empty() || !Covers(names, host)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto alias = aliases.find(Key(host, port));
+    return alias != aliases.end() && !alias->second.refused &&
+           std::binary_search(alias->second.addresses.begin(), alias->second.addresses.end(), address);
+}
+
+bool NetworkCoalescing::Covers(const std::vector<std::string>& names, const std::string& host) {
+    std::string target = Lowercase(host);
+    if (!target.empty() && target.back() == '.') {
+        target.pop_back();
+    }
+    size_t firstDot = target.find('.');
+    for (const auto& entry : names) {
+        std::string name = Lowercase(entry);
+        if (name == target) {
+            return true;
+        }
+        // One leftmost label only, and never a bare top-level domain
+        if (name.size() > 2 && name.compare(0, 2, "*.") == 0 && name.find('.', 2) != std::string::npos &&
+            firstDot != std::string::npos && firstDot > 0 && target.compare(firstDot + 1, std::string::npos, name, 2) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+NetworkCoalescing::Stats NetworkCoalescing::GetStats() {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto now = Clock::now();
+        for (const auto& [key, origin] : origins) {
+            stats.origins += origin.expires > now ? 1 : 0;
+        }
+        for (const auto& [key, alias] : aliases) {
+            stats.coalesced_hosts += (alias.expires > now && !alias.origin.empty()) ? 1 : 0;
+        }
+    }
+    stats.coalesced_requests = coalescedRequests.load(std::memory_order_relaxed);
+    stats.direct_requests = directRequests.load(std::memory_order_relaxed);
+    stats.misdirected = misdirected.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * @brief Addresses of a host as sorted numeric strings
+ */
+std::vector<std::string> NetworkCoalescing::ResolveAddresses(const std::string& host, int port) {
+    static const bool winsockReady = []() {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    std::vector<std::string> addresses;
+    if (!winsockReady) {
+        return addresses;
+    }
+
+    std::string name = host;
+    if (name.size() >= 2 && name.front() == '[' && name.back() == ']') {
+        name = name.substr(1, name.size() - 2);
+    }
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* results = nullptr;
+    if (getaddrinfo(name.c_str(), std::to_string(port).c_str(), &hints, &results) != 0) {
+        return addresses;
+    }
+    for (addrinfo* result = results; result; result = result->ai_next) {
+        std::string address = AddressText(result->ai_addr);
+        if (!address.empty()) {
+            addresses.push_back(address);
+        }
+    }
+    freeaddrinfo(results);
+    std::sort(addresses.begin(), addresses.end());
+    addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+    return addresses;
+}
+
+/**
+ * @brief Numeric text of an IPv4 or IPv6 address, with IPv4-mapped IPv6 addresses as IPv4
+ */
+std::string NetworkCoalescing::AddressText(const sockaddr* address) {
+    char text[INET6_ADDRSTRLEN] = {};
+    if (!address) {
+        return "";
+    }
+    if (address->sa_family == AF_INET6) {
+        const in6_addr& ip = reinterpret_cast<const sockaddr_in6*>(address)->sin6_addr;
+        if (IN6_IS_ADDR_V4MAPPED(&ip)) {
+            return inet_ntop(AF_INET, &ip.s6_addr[12], text, sizeof(text)) ? text : "";
+        }
+        return inet_ntop(AF_INET6, &ip, text, sizeof(text)) ? text : "";
+    }
+    if (address->sa_family == AF_INET) {
+        return inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in*>(address)->sin_addr, text, sizeof(text)) ? text : "";
+    }
+    return "";
+}
+
+/**
+ * @brief Drops expired entries once the maps reach their bounds (call with registryMutex held)
+ */
+void NetworkCoalescing::Prune(Clock::time_point now) {
+    if (origins.size() >= kMaxOrigins) {
+        for (auto it = origins.begin(); it != origins.end();) {
+            it = it->second.expires <= now ? origins.erase(it) : std::next(it);
+        }
+    }
+    if (aliases.size() >= kMaxAliases) {
+        for (auto it = aliases.begin(); it != aliases.end();) {
+            it = it->second.expires <= now ? aliases.erase(it) : std::next(it);
+        }
+        if (aliases.size() >= kMaxAliases) {
+            aliases.clear();
+        }
+    }
+}
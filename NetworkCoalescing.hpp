@@ -0,0 +1,162 @@
+/**
+ * @file NetworkCoalescing.hpp
+ * @brief HTTP/2 connection coalescing across host names (RFC 9113 section 9.1.1)
+ *
+ * Host names that resolve to the same server and are covered by the same
+ * certificate (a CDN edge with a wildcard or multi-name certificate, say) can
+ * share one HTTP/2 connection instead of each paying for its own handshake.
+ *
+ * WinHTTP pools connections by the name given to WinHttpConnect. After an
+ * https request has run over HTTP/2, its host is remembered as an origin
+ * together with its addresses and the names in its certificate. A request to
+ * another host that resolves to one of those addresses and is covered by the
+ * certificate is then connected as the origin, with its own Host, and rides
+ * on the origin's pooled connection:
+ *
+ * @code
+ * NetworkCoalescing::Enable();
+ *
+ * Network::RequestConfig config;
+ * config.use_http2 = true;
+ * Network::Get("https://img.cdn.example.com/logo.png", config);   // New connection, learned as an origin
+ * Network::Get("https://js.cdn.example.com/app.js", config);      // Same address, *.cdn.example.com: reused
+ *
+ * auto stats = NetworkCoalescing::GetStats();                     // coalesced_requests == 1
+ * @endcode
+ *
+ * Only HTTP/2 requests with certificate verification on and no proxy are
+ * coalesced. WinHTTP may still pick another pooled connection or open a new
+ * one, so before anything is sent on it the connection actually used is
+ * checked: its certificate must cover the request's host and its peer must be
+ * one of the host's addresses. If not, the host is not coalesced again and
+ * the request goes out on a connection of its own. A server that answers 421
+ * (Misdirected Request) is not asked again for that host either, and the
+ * request is resent on a connection of its own unless its body was streamed.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_COALESCING_HPP
+#define NETWORK_COALESCING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct sockaddr;
+
+/**
+ * @brief Registry of HTTP/2 origins and the hosts that may share their connections
+ */
+class NetworkCoalescing {
+public:
+    /**
+     * @brief Coalescing counters
+     */
+    struct Stats {
+        size_t origins = 0;                                     ///< Hosts whose connections others may share
+        size_t coalesced_hosts = 0;                             ///< Hosts currently sent over another host's connection
+        uint64_t coalesced_requests = 0;                        ///< Requests sent over another host's connection (hits)
+        uint64_t direct_requests = 0;                           ///< Eligible requests that had no origin to share (misses)
+        uint64_t misdirected = 0;                               ///< Coalesced requests refused with 421 or by the connection check
+    };
+
+    /**
+     * @brief Start coalescing eligible requests
+     */
+    static void Enable();
+
+    /**
+     * @brief Stop coalescing and forget every origin
+     */
+    static void Disable();
+
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Origin whose connection a request may share
+     * @param host Request host
+     * @param port Request port
+     * @return Origin host to connect to, or empty to connect to host itself
+     */
+    static std::string Resolve(const std::string& host, int port);
+
+    /**
+     * @brief Whether a host should be (re)learned as an origin
+     */
+    static bool NeedsOrigin(const std::string& host, int port);
+
+    /**
+     * @brief Remember a host whose HTTP/2 connection others may share
+     * @param host Host connected to directly
+     * @param port Port connected to
+     * @param names DNS names in the host's certificate
+     */
+    static void AddOrigin(const std::string& host, int port, const std::vector<std::string>& names);
+
+    /**
+     * @brief Stop coalescing a host, after the server refused a coalesced request
+     */
+    static void Forget(const std::string& host, int port);
+
+    /**
+     * @brief Whether a coalesced request may be sent on the connection WinHTTP gave it
+     *
+     * The connection's certificate must cover the host, and its peer must be
+     * one of the addresses the host resolved to when it was coalesced.
+     *
+     * @param host Request host
+     * @param port Request port
+     * @param peer Remote address of the connection
+     * @param names DNS names in the connection's certificate
+     */
+    static bool Admits(const std::string& host, int port, const sockaddr* peer, const std::vector<std::string>& names);
+
+    /**
+     * @brief Whether certificate names cover a host
+     *
+     * Names match case-insensitively; a wildcard matches exactly one leftmost
+     * label ("*.example.com" covers "a.example.com", not "example.com" or
+     * "a.b.example.com").
+     */
+    static bool Covers(const std::vector<std::string>& names, const std::string& host);
+
+    static Stats GetStats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Origin {
+        std::vector<std::string> addresses;                     ///< Resolved addresses, sorted
+        std::vector<std::string> names;                         ///< Certificate DNS names, lowercased
+        Clock::time_point expires;
+    };
+
+    struct Alias {
+        std::string origin;                                     ///< Origin key, or empty if none fits
+        std::vector<std::string> addresses;                     ///< The host's resolved addresses, sorted
+        uint64_t generation = 0;                                ///< Origin generation a miss was decided at
+        bool refused = false;                                   ///< The server refused a coalesced request; go direct until expiry
+        Clock::time_point expires;
+    };
+
+    static std::vector<std::string> ResolveAddresses(const std::string& host, int port);
+    static std::string AddressText(const sockaddr* address);
+    static void Prune(Clock::time_point now);
+
+    static std::atomic<bool> enabled;
+    static std::mutex registryMutex;
+    static std::map<std::string, Origin> origins;               ///< By "host:port"
+    static std::map<std::string, Alias> aliases;                ///< Decisions by "host:port"
+    static uint64_t generation;                                 ///< Bumped whenever an origin is added
+    static std::atomic<uint64_t> coalescedRequests;
+    static std::atomic<uint64_t> directRequests;
+    static std::atomic<uint64_t> misdirected;
+};
+
+#endif // NETWORK_COALESCING_HPP
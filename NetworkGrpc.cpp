@@ -0,0 +1,332 @@
+/**
+ * @file NetworkGrpc.cpp
+ * @brief Implementation of gRPC message framing and call status handling
+ */
+
+#include "NetworkGrpc.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+// Compressed flag and 4-byte big-endian length before every message
+static const size_t kFramePrefix = 5;
+// Messages at least this large are sent from their own storage instead of being packed with others
+static const size_t kZeroCopyThreshold = 16 * 1024;
+// Small messages and prefixes are packed into blocks of up to this size
+static const size_t kPackedBlockSize = 64 * 1024;
+// grpc-timeout allows at most 8 digits
+static const int kMaxTimeoutValue = 99999999;
+
+static void AppendPrefix(std::string& out, size_t length) {
+    char prefix[kFramePrefix] = {
+        0,
+        static_cast<char>((length >> 24) & 0xFF),
+        static_cast<char>((length >> 16) & 0xFF),
+        static_cast<char>((length >> 8) & 0xFF),
+        static_cast<char>(length & 0xFF)
+    };
+    out.append(prefix, kFramePrefix);
+}
+
+static size_t FrameLength(const char* prefix) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(prefix);
+    return (static_cast<size_t>(bytes[1]) << 24) | (static_cast<size_t>(bytes[2]) << 16) |
+           (static_cast<size_t>(bytes[3]) << 8) | static_cast<size_t>(bytes[4]);
+}
+
+/**
+ * @brief Case-insensitive header lookup; HTTP/2 field names arrive lowercased, HTTP/1.1 ones need not
+ */
+static std::string HeaderValue(const std::map<std::string, std::string>& headers, const char* name) {
+    for (const auto& [key, value] : headers) {
+        if (key.size() == std::strlen(name) &&
+            std::equal(key.begin(), key.end(), name, [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == b;
+            })) {
+            return value;
+        }
+    }
+    return "";
+}
+
+static std::string PercentDecode(const std::string& value) {
+    std::string decoded;
+    decoded.reserve(value.size());
+    for (size_t i = 0; i < value.size(); i++) {
+        if (value[i] == '%' && i + 2 < value.size() &&
+            std::isxdigit(static_cast<unsigned char>(value[i + 1])) && std::isxdigit(static_cast<unsigned char>(value[i + 2]))) {
+            decoded += static_cast<char>(std::strtol(value.substr(i + 1, 2).c_str(), nullptr, 16));
+            i += 2;
+        }
+        else {
+            decoded += value[i];
+        }
+    }
+    return decoded;
+}
+
+/**
+ * @brief Request messages framed on the fly as a body of known size
+ *
+ * Prefixes and small messages are packed together into blocks, so a stream of
+ * small messages is not written a few bytes at a time; large messages are
+ * sent from the caller's strings without a copy.
+ */
+class FramedMessages : public Network::BodySource {
+public:
+    explicit FramedMessages(const std::vector<std::string_view>& messages) : messages(messages) {
+        for (const auto& message : messages) {
+            size += kFramePrefix + message.size();
+        }
+    }
+
+    std::optional<uint64_t> Size() const override { return size; }
+
+    bool NextBlock(std::string_view& block) override {
+        if (largePending) {
+            block = messages[next++];
+            largePending = false;
+            return true;
+        }
+        packed.clear();
+        while (next < messages.size() && packed.size() < kPackedBlockSize) {
+            std::string_view message = messages[next];
+            AppendPrefix(packed, message.size());
+            if (message.size() >= kZeroCopyThreshold) {
+                largePending = true;
+                break;
+            }
+            packed.append(message.data(), message.size());
+            next++;
+        }
+        block = packed;
+        return true;
+    }
+
+    bool Read(char* buffer, size_t capacity, size_t& bytesRead) override {
+        bytesRead = 0;
+        while (bytesRead < capacity) {
+            if (remaining.empty() && (NextBlock(remaining), remaining.empty())) {
+                break;
+            }
+            size_t count = std::min(capacity - bytesRead, remaining.size());
+            std::memcpy(buffer + bytesRead, remaining.data(), count);
+            remaining.remove_prefix(count);
+            bytesRead += count;
+        }
+        return true;
+    }
+
+private:
+    const std::vector<std::string_view>& messages;
+    uint64_t size = 0;
+    size_t next = 0;                                            // Next message to pack or send
+    bool largePending = false;                                  // messages[next] is large and its prefix is already out
+    std::string packed;
+    std::string_view remaining;                                 // Rest of the current block, for Read
+};
+
+void NetworkGrpc::AppendFrame(std::string& out, std::string_view message) {
+    AppendPrefix(out, message.size());
+    out.append(message.data(), message.size());
+}
+
+bool NetworkGrpc::FrameReader::Fail(StatusCode status, const char* message) {
+    errorStatus = status;
+    error = message;
+    partial.clear();
+    return false;
+}
+
+/**
+ * @brief Decodes a piece of the body, passing on every message it completes
+ *
+ * A message carried over from the previous piece is completed first; whole
+ * messages in the rest of the piece are then passed on in place, and the
+ * incomplete tail is kept for the next call.
+ */
+bool NetworkGrpc::FrameReader::Feed(const char* data, size_t size, const MessageHandler& onMessage) {
+    if (errorStatus != StatusCode::Ok) {
+        return false;
+    }
+    auto checkPrefix = [this](const char* prefix) {
+        if (prefix[0] == 1) {
+            return Fail(StatusCode::Internal, "Compressed message received, but no compression was negotiated");
+        }
+        if (prefix[0] != 0) {
+            return Fail(StatusCode::Internal, "Malformed message prefix");
+        }
+        if (FrameLength(prefix) > maxMessageBytes) {
+            return Fail(StatusCode::ResourceExhausted, "Response message exceeds max_message_bytes");
+        }
+        return true;
+    };
+
+    while (!partial.empty() && size > 0) {
+        size_t wanted = partial.size() < kFramePrefix ? kFramePrefix : kFramePrefix + FrameLength(partial.data());
+        size_t count = std::min(wanted - partial.size(), size);
+        partial.append(data, count);
+        data += count;
+        size -= count;
+        if (partial.size() == kFramePrefix) {
+            if (!checkPrefix(partial.data())) {
+                return false;
+            }
+            partial.reserve(kFramePrefix + FrameLength(partial.data()));
+        }
+        if (partial.size() >= kFramePrefix && partial.size() == kFramePrefix + FrameLength(partial.data())) {
+            bool accepted = onMessage(std::string_view(partial).substr(kFramePrefix));
+            partial.clear();
+            if (!accepted) {
+                return Fail(StatusCode::Cancelled, "Cancelled by the message handler");
+            }
+        }
+    }
+
+    while (size >= kFramePrefix) {
+        if (!checkPrefix(data)) {
+            return false;
+        }
+        size_t length = FrameLength(data);
+        if (size - kFramePrefix < length) {
+            break;
+        }
+        if (!onMessage(std::string_view(data + kFramePrefix, length))) {
+            return Fail(StatusCode::Cancelled, "Cancelled by the message handler");
+        }
+        data += kFramePrefix + length;
+        size -= kFramePrefix + length;
+    }
+
+    if (size > 0) {
+        partial.assign(data, size);
+        if (size >= kFramePrefix) {
+            partial.reserve(kFramePrefix + FrameLength(data));
+        }
+    }
+    return true;
+}
+
+NetworkGrpc::Result NetworkGrpc::Unary(const std::string& url, std::string_view request, const CallOptions& options) {
+    return Call(url, { request }, nullptr, true, options);
+}
+
+NetworkGrpc::Result NetworkGrpc::ServerStreaming(const std::string& url, std::string_view request,
+                                                 const MessageHandler& onMessage, const CallOptions& options) {
+    return Call(url, { request }, &onMessage, false, options);
+}
+
+NetworkGrpc::Result NetworkGrpc::ClientStreaming(const std::string& url, const std::vector<std::string>& requests,
+                                                 const CallOptions& options) {
+    return Call(url, std::vector<std::string_view>(requests.begin(), requests.end()), nullptr, true, options);
+}
+
+NetworkGrpc::Result NetworkGrpc::BidiStreaming(const std::string& url, const std::vector<std::string>& requests,
+                                               const MessageHandler& onMessage, const CallOptions& options) {
+    return Call(url, std::vector<std::string_view>(requests.begin(), requests.end()), &onMessage, false, options);
+}
+
+/**
+ * @brief Sends the framed requests and derives the call status
+ *
+ * Response messages are decoded as the body arrives, through
+ * RequestConfig::on_body_data, so streamed responses are never accumulated.
+ * A single request message is sent as one in-memory payload; several are
+ * framed on the fly by FramedMessages. Either way the body has a known
+ * length, which keeps the request on HTTP/2.
+ */
+NetworkGrpc::Result NetworkGrpc::Call(const std::string& url, const std::vector<std::string_view>& requests,
+                                      const MessageHandler* onMessage, bool unaryResponse, const CallOptions& options) {
+    Result result;
+
+    Network::RequestConfig config = options.config;
+    config.use_http2 = true;
+    for (const auto& [key, value] : options.metadata) {
+        config.additional_headers[key] = value;
+    }
+    config.additional_headers["Content-Type"] = "application/grpc";
+    config.additional_headers["TE"] = "trailers";
+    config.additional_headers["grpc-accept-encoding"] = "identity";
+    if (options.deadline_ms > 0) {
+        config.additional_headers["grpc-timeout"] = std::to_string(std::min(options.deadline_ms, kMaxTimeoutValue)) + "m";
+        config.timeout_seconds = (options.deadline_ms + 999) / 1000;
+    }
+
+    FrameReader reader(options.max_message_bytes);
+    MessageHandler collect = [&result](std::string_view message) {
+        result.messages.emplace_back(message);
+        return true;
+    };
+    const MessageHandler& handler = onMessage ? *onMessage : collect;
+    config.on_body_data = [&reader, &handler](const char* data, size_t size) {
+        return reader.Feed(data, size, handler);
+    };
+
+    if (requests.size() == 1) {
+        std::optional<std::string> payload(std::in_place);
+        payload->reserve(kFramePrefix + requests[0].size());
+        AppendFrame(*payload, requests[0]);
+        result.response = Network::Request(Network::Method::HTTP_POST, url, payload, config);
+    }
+    else {
+        FramedMessages body(requests);
+        result.response = Network::Request(Network::Method::HTTP_POST, url, body, config);
+    }
+
+    const Network::NetworkResponse& response = result.response;
+    std::string grpcStatus = HeaderValue(response.headers, "grpc-status");
+    if (response.status_code != 0 && response.status_code != 200 && grpcStatus.empty()) {
+        result.status = FromHttpStatus(response.status_code);
+        result.message = "HTTP status " + std::to_string(response.status_code);
+    }
+    else if (reader.ErrorStatus() != StatusCode::Ok) {
+        result.status = reader.ErrorStatus();
+        result.message = reader.Error();
+    }
+    else if (response.error_type != Network::ErrorType::None && response.error_type != Network::ErrorType::Http) {
+        switch (response.error_type) {
+            case Network::ErrorType::Timeout:       result.status = StatusCode::DeadlineExceeded; break;
+            case Network::ErrorType::ResourceLimit: result.status = StatusCode::ResourceExhausted; break;
+            case Network::ErrorType::InvalidUrl:    result.status = StatusCode::InvalidArgument; break;
+            case Network::ErrorType::Other:         result.status = StatusCode::Unknown; break;
+            default:                                result.status = StatusCode::Unavailable; break;
+        }
+        result.message = response.error_message;
+    }
+    else if (grpcStatus.empty()) {
+        result.status = StatusCode::Internal;
+        result.message = "Response carries no grpc-status";
+    }
+    else {
+        int code = std::atoi(grpcStatus.c_str());
+        result.status = (code >= 0 && code <= 16) ? static_cast<StatusCode>(code) : StatusCode::Unknown;
+        result.message = PercentDecode(HeaderValue(response.headers, "grpc-message"));
+        if (result.ok() && reader.Pending()) {
+            result.status = StatusCode::Internal;
+            result.message = "Response ended inside a message";
+        }
+        else if (result.ok() && unaryResponse && result.messages.size() != 1) {
+            result.status = StatusCode::Internal;
+            result.message = "Expected one response message, received " + std::to_string(result.messages.size());
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Status for a response without grpc-status, per the gRPC HTTP/2 protocol
+ */
+NetworkGrpc::StatusCode NetworkGrpc::FromHttpStatus(int statusCode) {
+    switch (statusCode) {
+        case 400: return StatusCode::Internal;
+        case 401: return StatusCode::Unauthenticated;
+        case 403: return StatusCode::PermissionDenied;
+        case 404: return StatusCode::Unimplemented;
+        case 429:
+        case 502:
+        case 503:
+        case 504: return StatusCode::Unavailable;
+        default:  return StatusCode::Unknown;
+    }
+}
@@ -0,0 +1,187 @@
+/**
+ * @file NetworkGrpc.hpp
+ * @brief gRPC calls carried by Network's HTTP/2 requests
+ *
+ * NetworkGrpc frames opaque, already serialized messages with gRPC's 5-byte
+ * length prefix and sends them as ordinary Network requests: the same WinHTTP
+ * session, connection pool, HTTP/2 multiplexing, scheduler, limits, proxy and
+ * metrics as all other traffic. Message encoding (protobuf or otherwise) is
+ * left to the caller.
+ *
+ * @code
+ * NetworkGrpc::CallOptions options;
+ * options.deadline_ms = 500;
+ * options.metadata["authorization"] = "Bearer " + token;
+ *
+ * auto reply = NetworkGrpc::Unary("https://orders.internal/orders.v1.Orders/Get", request.SerializeAsString(), options);
+ * if (reply.ok()) {
+ *     order.ParseFromString(reply.messages[0]);
+ * }
+ *
+ * NetworkGrpc::ServerStreaming("https://orders.internal/orders.v1.Orders/Watch", filter, [](std::string_view message) {
+ *     Apply(message);
+ *     return true;  // false cancels the call
+ * });
+ * @endcode
+ *
+ * The status comes from the grpc-status and grpc-message trailers (or
+ * headers, for trailers-only responses); transport failures and non-200
+ * responses map to gRPC codes as the gRPC HTTP/2 protocol specifies.
+ *
+ * WinHTTP sends a request body completely before it reads the response, so
+ * bidirectional calls are half-duplex: every request message is sent, then
+ * response messages are delivered as they arrive. gRPC servers need HTTP/2,
+ * which WinHTTP negotiates over https only, and trailers need a WinHTTP
+ * recent enough to report them (WINHTTP_QUERY_FLAG_TRAILERS).
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_GRPC_HPP
+#define NETWORK_GRPC_HPP
+
+#include "Network.hpp"
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Unary and streaming gRPC calls with opaque payloads
+ */
+class NetworkGrpc {
+public:
+    /**
+     * @brief gRPC status codes
+     */
+    enum class StatusCode {
+        Ok = 0,
+        Cancelled = 1,
+        Unknown = 2,
+        InvalidArgument = 3,
+        DeadlineExceeded = 4,
+        NotFound = 5,
+        AlreadyExists = 6,
+        PermissionDenied = 7,
+        ResourceExhausted = 8,
+        FailedPrecondition = 9,
+        Aborted = 10,
+        OutOfRange = 11,
+        Unimplemented = 12,
+        Internal = 13,
+        Unavailable = 14,
+        DataLoss = 15,
+        Unauthenticated = 16
+    };
+
+    /**
+     * @brief Per-call settings
+     */
+    struct CallOptions {
+        Network::RequestConfig config;                          ///< Transport settings (TLS, scheduling, limits); use_http2 is forced on
+        std::map<std::string, std::string> metadata;            ///< Request metadata; values of "-bin" keys must already be base64
+        int deadline_ms = 0;                                    ///< Call deadline, sent as grpc-timeout and applied as the request timeout (0 = none)
+        size_t max_message_bytes = 4 * 1024 * 1024;             ///< Largest response message accepted
+    };
+
+    /**
+     * @brief Outcome of a call
+     */
+    struct Result {
+        StatusCode status = StatusCode::Unknown;                ///< grpc-status, or the code a failure maps to
+        std::string message;                                    ///< grpc-message (decoded), or the failure
+        std::vector<std::string> messages;                      ///< Response messages, unless a handler consumed them
+        Network::NetworkResponse response;                      ///< HTTP response: headers with trailers merged in, timings, transport error
+
+        bool ok() const { return status == StatusCode::Ok; }
+    };
+
+    /**
+     * @brief Receives each response message as it arrives; return false to cancel the call
+     */
+    using MessageHandler = std::function<bool(std::string_view message)>;
+
+    /**
+     * @brief One request message, one response message
+     * @param url Method URL, e.g. https://host/package.Service/Method
+     * @param request Serialized request message
+     * @param options Call settings
+     * @return Result with exactly one message when ok()
+     */
+    static Result Unary(const std::string& url, std::string_view request, const CallOptions& options = CallOptions());
+
+    /**
+     * @brief One request message, a stream of response messages
+     * @param url Method URL
+     * @param request Serialized request message
+     * @param onMessage Called for each response message as it arrives
+     * @param options Call settings
+     */
+    static Result ServerStreaming(const std::string& url, std::string_view request,
+                                  const MessageHandler& onMessage, const CallOptions& options = CallOptions());
+
+    /**
+     * @brief A stream of request messages, one response message
+     * @param url Method URL
+     * @param requests Serialized request messages, sent without being copied together
+     * @param options Call settings
+     * @return Result with exactly one message when ok()
+     */
+    static Result ClientStreaming(const std::string& url, const std::vector<std::string>& requests,
+                                  const CallOptions& options = CallOptions());
+
+    /**
+     * @brief Streams both ways, half-duplex: all requests are sent before responses are read
+     * @param url Method URL
+     * @param requests Serialized request messages
+     * @param onMessage Called for each response message as it arrives
+     * @param options Call settings
+     */
+    static Result BidiStreaming(const std::string& url, const std::vector<std::string>& requests,
+                                const MessageHandler& onMessage, const CallOptions& options = CallOptions());
+
+    /**
+     * @brief Append a message with its length prefix (uncompressed)
+     */
+    static void AppendFrame(std::string& out, std::string_view message);
+
+    /**
+     * @brief Incremental decoder of length-prefixed messages
+     *
+     * Messages that arrive whole within one piece of input are passed on
+     * without being copied; only messages split across pieces are assembled.
+     */
+    class FrameReader {
+    public:
+        explicit FrameReader(size_t maxMessageBytes) : maxMessageBytes(maxMessageBytes) {}
+
+        /**
+         * @brief Decode the next piece of a response body
+         * @return false if the input is malformed, a message is too large or compressed, or the handler cancelled
+         */
+        bool Feed(const char* data, size_t size, const MessageHandler& onMessage);
+
+        bool Pending() const { return !partial.empty(); }       ///< A message is incomplete
+        StatusCode ErrorStatus() const { return errorStatus; }  ///< Status for the failure that stopped Feed
+        const std::string& Error() const { return error; }
+
+    private:
+        bool Fail(StatusCode status, const char* message);
+
+        size_t maxMessageBytes;
+        std::string partial;                                    ///< Incomplete prefix or message carried into the next Feed
+        StatusCode errorStatus = StatusCode::Ok;
+        std::string error;
+    };
+
+private:
+    static Result Call(const std::string& url, const std::vector<std::string_view>& requests,
+                       const MessageHandler* onMessage, bool unaryResponse, const CallOptions& options);
+
+    static StatusCode FromHttpStatus(int statusCode);
+};
+
+#endif // NETWORK_GRPC_HPP
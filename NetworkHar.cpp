@@ -0,0 +1,336 @@
+/**
+ * @file NetworkHar.cpp
+ * @brief Implementation of sampled HAR export
+ */
+
+#include "NetworkHar.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+
+// Initialize static members
+std::atomic<bool> NetworkHar::enabled{false};
+std::atomic<uint64_t> NetworkHar::sampleThreshold{0};
+std::atomic<bool> NetworkHar::captureCredentials{false};
+std::shared_ptr<NetworkHar::Writer> NetworkHar::writer;
+std::mutex NetworkHar::controlMutex;
+
+// Sampling compares a 53-bit random draw against rate * 2^53, so a rate of 1 samples everything
+static const double kSampleScale = 9007199254740992.0;  // 2^53
+
+/**
+ * @brief Per-thread xorshift64* generator, cheap enough to run on every request
+ */
+static uint64_t NextRandom() {
+    thread_local uint64_t state = 0;  // Constant-initialized, so access needs no TLS guard
+    if (state == 0) {
+        state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+    }
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+static std::string JsonString(const std::string& value) {
+    std::string out = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                }
+                else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+/**
+ * @brief Milliseconds as HAR expects them, or -1 if the phase did not happen
+ */
+static std::string HarMillis(std::chrono::nanoseconds duration, bool happened = true) {
+    if (!happened) {
+        return "-1";
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", duration.count() / 1000000.0);
+    return buffer;
+}
+
+static std::string IsoTime(std::chrono::system_clock::time_point time) {
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    int millis = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000);
+    std::tm utc;
+#ifdef _WIN32
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                  utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec, millis);
+    return buffer;
+}
+
+static std::string HeaderArray(const std::map<std::string, std::string>& headers, long long& size) {
+    std::string out = "[";
+    for (const auto& [name, value] : headers) {
+        if (out.size() > 1) out += ",";
+        out += "{\"name\":" + JsonString(name) + ",\"value\":" + JsonString(value) + "}";
+        size += static_cast<long long>(name.size() + value.size() + 4);  // "Name: value\r\n"
+    }
+    out += "]";
+    return out;
+}
+
+static std::string QueryArray(const std::string& url) {
+    std::string out = "[";
+    size_t query = url.find('?');
+    if (query != std::string::npos) {
+        size_t fragment = url.find('#', query);
+        std::string params = url.substr(query + 1, fragment == std::string::npos ? std::string::npos : fragment - query - 1);
+        size_t position = 0;
+        while (position <= params.size() && !params.empty()) {
+            size_t next = params.find('&', position);
+            if (next == std::string::npos) next = params.size();
+            std::string param = params.substr(position, next - position);
+            size_t equals = param.find('=');
+            if (out.size() > 1) out += ",";
+            out += "{\"name\":" + JsonString(param.substr(0, equals)) + ",\"value\":" +
+                   JsonString(equals == std::string::npos ? "" : param.substr(equals + 1)) + "}";
+            position = next + 1;
+        }
+    }
+    out += "]";
+    return out;
+}
+
+static bool EqualsIgnoreCase(const std::string& value, const char* name) {
+    return value.size() == std::char_traits<char>::length(name) &&
+        std::equal(value.begin(), value.end(), name, [](char a, char b) {
+            return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+        });
+}
+
+static std::string FindHeader(const std::map<std::string, std::string>& headers, const char* name) {
+    for (const auto& [key, value] : headers) {
+        if (EqualsIgnoreCase(key, name)) {
+            return value;
+        }
+    }
+    return "";
+}
+
+// Headers that carry credentials; their values are redacted unless capture is opted into
+static const char kRedacted[] = "<redacted>";
+
+/**
+ * @brief Replaces credential values in a header set with kRedacted
+ *
+ * Redacts the same headers that a cross-origin redirect drops
+ * (see Network::IsCredentialHeader).
+ */
+static void RedactCredentials(std::map<std::string, std::string>& headers, const Network::RequestConfig& config) {
+    for (auto& [name, value] : headers) {
+        if (Network::IsCredentialHeader(name, value, config)) {
+            value = kRedacted;
+        }
+    }
+}
+
+/**
+ * @brief Starts a HAR export, finishing any export already running
+ *
+ * @param path The HAR file to create
+ * @param sampleRate The fraction of requests to export
+ * @param queueCapacity The number of entries buffered for the writer
+ * @return true if the file was created
+ */
+bool NetworkHar::Start(const std::string& path, double sampleRate, size_t queueCapacity) {
+    std::lock_guard<std::mutex> lock(controlMutex);
+
+    auto newWriter = std::make_shared<Writer>(queueCapacity);
+    newWriter->out.open(path, std::ios::binary | std::ios::trunc);
+    if (!newWriter->out) {
+        return false;
+    }
+    newWriter->out << "{\"log\":{\"version\":\"1.2\",\"creator\":{\"name\":\"NetworkClient\",\"version\":\"1.1.0\"},\"entries\":[\n";
+
+    enabled.store(false, std::memory_order_relaxed);
+    auto oldWriter = std::atomic_exchange(&writer, newWriter);
+    newWriter->thread = std::thread(&NetworkHar::WriteLoop, newWriter.get());
+    SetSampleRate(sampleRate);
+    enabled.store(true, std::memory_order_relaxed);
+
+    if (oldWriter) {
+        oldWriter->stopping = true;
+        oldWriter->thread.join();
+    }
+    return true;
+}
+
+void NetworkHar::Stop() {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    enabled.store(false, std::memory_order_relaxed);
+    auto oldWriter = std::atomic_exchange(&writer, std::shared_ptr<Writer>());
+    if (oldWriter) {
+        oldWriter->stopping = true;
+        oldWriter->thread.join();
+    }
+}
+
+void NetworkHar::SetSampleRate(double sampleRate) {
+    sampleRate = std::min(std::max(sampleRate, 0.0), 1.0);
+    sampleThreshold.store(static_cast<uint64_t>(sampleRate * kSampleScale), std::memory_order_relaxed);
+}
+
+void NetworkHar::SetCaptureCredentials(bool capture) {
+    captureCredentials.store(capture, std::memory_order_relaxed);
+}
+
+uint64_t NetworkHar::WrittenEntries() {
+    auto current = std::atomic_load(&writer);
+    return current ? current->written.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t NetworkHar::DroppedEntries() {
+    auto current = std::atomic_load(&writer);
+    return current ? current->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+/**
+ * @brief Samples a request and queues it for the writer
+ *
+ * Everything except the sampling decision happens only for sampled requests.
+ * Credentials are redacted here, so they never reach the queue or the file.
+ */
+void NetworkHar::Capture(
+    Network::Method method,
+    const std::string& url,
+    const Network::RequestConfig& config,
+    size_t payloadSize,
+    const Network::NetworkResponse& response
+) {
+    if ((NextRandom() >> 11) >= sampleThreshold.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    auto current = std::atomic_load(&writer);
+    if (!current) {
+        return;
+    }
+
+    HarEntry entry;
+    auto elapsed = std::chrono::steady_clock::now() - response.timings.start;
+    entry.started = std::chrono::system_clock::now() - std::chrono::duration_cast<std::chrono::system_clock::duration>(elapsed);
+    entry.method = method;
+    entry.url = url;
+    entry.request_headers = config.additional_headers;
+    entry.request_body_size = payloadSize;
+    entry.status_code = response.status_code;
+    entry.response_headers = response.headers;
+    entry.response_body_size = response.body.size();
+    entry.error_message = response.error_message;
+    entry.timings = response.timings;
+    if (!captureCredentials.load(std::memory_order_relaxed)) {
+        RedactCredentials(entry.request_headers, config);
+        RedactCredentials(entry.response_headers, config);
+    }
+
+    if (!current->queue.TryPush(std::move(entry))) {
+        current->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Writer thread: drains the queue into the file until stopped, then closes the document
+ */
+void NetworkHar::WriteLoop(Writer* writer) {
+    HarEntry entry;
+    for (;;) {
+        bool stopping = writer->stopping.load();
+        bool wrote = false;
+        while (writer->queue.TryPop(entry)) {
+            WriteEntry(*writer, entry);
+            wrote = true;
+        }
+        if (stopping) {
+            break;
+        }
+        if (wrote) {
+            writer->out.flush();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    writer->out << "\n]}}\n";
+    writer->out.close();
+}
+
+void NetworkHar::WriteEntry(Writer& writer, const HarEntry& entry) {
+    const auto& timings = entry.timings;
+    using Clock = Network::NetworkResponse::Timings::Clock;
+    bool connected = timings.connect_start != Clock::time_point();
+    bool resolved = timings.dns_start != Clock::time_point();
+    bool secure = entry.url.compare(0, 8, "https://") == 0;
+
+    long long requestHeadersSize = 0;
+    long long responseHeadersSize = 0;
+    std::string requestHeaders = HeaderArray(entry.request_headers, requestHeadersSize);
+    std::string responseHeaders = HeaderArray(entry.response_headers, responseHeadersSize);
+    if (entry.status_code == 0) {
+        responseHeadersSize = -1;
+    }
+
+    std::string mimeType = FindHeader(entry.response_headers, "Content-Type");
+    std::string requestMimeType = FindHeader(entry.request_headers, "Content-Type");
+
+    std::string json;
+    json.reserve(1024 + requestHeaders.size() + responseHeaders.size());
+    json += writer.first ? "" : ",\n";
+    json += "{\"startedDateTime\":\"" + IsoTime(entry.started) + "\"";
+    json += ",\"time\":" + HarMillis(timings.Total());
+    json += ",\"request\":{\"method\":\"" + std::string(Network::MethodName(entry.method)) + "\"";
+    json += ",\"url\":" + JsonString(entry.url);
+    json += ",\"httpVersion\":\"HTTP/1.1\",\"cookies\":[],\"headers\":" + requestHeaders;
+    json += ",\"queryString\":" + QueryArray(entry.url);
+    if (entry.request_body_size > 0) {
+        json += ",\"postData\":{\"mimeType\":" + JsonString(requestMimeType) + ",\"text\":\"\"}";
+    }
+    json += ",\"headersSize\":" + std::to_string(requestHeadersSize);
+    json += ",\"bodySize\":" + std::to_string(entry.request_body_size) + "}";
+    json += ",\"response\":{\"status\":" + std::to_string(entry.status_code);
+    json += ",\"statusText\":\"\",\"httpVersion\":\"HTTP/1.1\",\"cookies\":[],\"headers\":" + responseHeaders;
+    json += ",\"content\":{\"size\":" + std::to_string(entry.response_body_size) + ",\"mimeType\":" + JsonString(mimeType) + "}";
+    json += ",\"redirectURL\":" + JsonString(FindHeader(entry.response_headers, "Location"));
+    json += ",\"headersSize\":" + std::to_string(responseHeadersSize);
+    json += ",\"bodySize\":" + std::to_string(entry.response_body_size);
+    if (!entry.error_message.empty()) {
+        json += ",\"_error\":" + JsonString(entry.error_message);
+    }
+    json += "},\"cache\":{}";
+    json += ",\"timings\":{\"blocked\":" + HarMillis(timings.QueueWait() + timings.RateLimitWait());
+    json += ",\"dns\":" + HarMillis(timings.Dns(), resolved);
+    json += ",\"connect\":" + HarMillis(timings.Connect() + timings.Tls(), connected);  // HAR's connect includes ssl
+    json += ",\"ssl\":" + HarMillis(timings.Tls(), connected && secure);
+    json += ",\"send\":" + HarMillis(timings.Send());
+    json += ",\"wait\":" + HarMillis(timings.TimeToFirstByte());
+    json += ",\"receive\":" + HarMillis(timings.Download()) + "}";
+    json += std::string(",\"_connectionReused\":") + (timings.connection_reused ? "true" : "false");
+    json += "}";
+
+    writer.out << json;
+    writer.first = false;
+    writer.written.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file NetworkHar.hpp
+ * @brief Sampled HTTP Archive (HAR 1.2) export for the Network library
+ *
+ * When enabled, Network::Request hands a sample of completed requests to a
+ * background writer through a bounded lock-free queue. Unsampled requests cost
+ * one relaxed load and a thread-local random draw; sampled ones a copy of their
+ * headers and one queue push. When the writer falls behind, entries are
+ * dropped and counted rather than slowing requests down.
+ *
+ * Each entry carries the HAR timings (blocked, dns, connect, ssl, send, wait,
+ * receive), header and body sizes, and a `_connectionReused` flag. Bodies are
+ * not exported, and credential headers (Authorization, Proxy-Authorization,
+ * Cookie, Set-Cookie, API-key headers and any header carrying the request's
+ * api_key or oauth_token) are exported as "<redacted>" unless
+ * SetCaptureCredentials(true) is called.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_HAR_HPP
+#define NETWORK_HAR_HPP
+
+#include "Network.hpp"
+#include "NetworkQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief One sampled request, as queued for the HAR writer
+ */
+struct HarEntry {
+    std::chrono::system_clock::time_point started;              ///< Wall-clock request start
+    Network::Method method = Network::Method::HTTP_GET;         ///< HTTP method
+    std::string url;                                            ///< Request URL
+    std::map<std::string, std::string> request_headers;         ///< Headers set by the caller
+    size_t request_body_size = 0;                               ///< Request body size
+    int status_code = 0;                                        ///< HTTP status code (0 if no response)
+    std::map<std::string, std::string> response_headers;        ///< Response headers
+    size_t response_body_size = 0;                              ///< Response body size
+    std::string error_message;                                  ///< Error message if the request failed
+    Network::NetworkResponse::Timings timings;                  ///< Phase breakdown
+};
+
+/**
+ * @brief Global HAR export control
+ */
+class NetworkHar {
+public:
+    /**
+     * @brief Start exporting to a file, replacing any export in progress
+     * @param path HAR file to create (overwritten if it exists)
+     * @param sampleRate Fraction of requests to export, in [0, 1]
+     * @param queueCapacity Entries buffered for the writer before dropping
+     * @return true if the file could be created
+     */
+    static bool Start(const std::string& path, double sampleRate, size_t queueCapacity = 4096);
+
+    /**
+     * @brief Write out queued entries, close the HAR document and stop exporting
+     */
+    static void Stop();
+
+    /**
+     * @brief Change the sampling rate of the running export
+     * @param sampleRate Fraction of requests to export, in [0, 1]
+     */
+    static void SetSampleRate(double sampleRate);
+
+    /**
+     * @brief Export credential header values as sent instead of redacted
+     * @param capture true to write them to the file; off by default
+     */
+    static void SetCaptureCredentials(bool capture);
+
+    /**
+     * @brief Whether an export is running
+     */
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Sample a completed request (called by Network::Request)
+     * @param method HTTP method
+     * @param url Request URL
+     * @param config Configuration the request was sent with
+     * @param payloadSize Request body size
+     * @param response Completed response
+     */
+    static void Capture(
+        Network::Method method,
+        const std::string& url,
+        const Network::RequestConfig& config,
+        size_t payloadSize,
+        const Network::NetworkResponse& response
+    );
+
+    /**
+     * @brief Entries written to the current file
+     */
+    static uint64_t WrittenEntries();
+
+    /**
+     * @brief Sampled entries dropped because the queue was full
+     */
+    static uint64_t DroppedEntries();
+
+private:
+    struct Writer {
+        explicit Writer(size_t capacity) : queue(capacity) {}
+
+        BoundedQueue<HarEntry> queue;
+        std::ofstream out;
+        std::thread thread;
+        std::atomic<bool> stopping{false};
+        std::atomic<uint64_t> written{0};
+        std::atomic<uint64_t> dropped{0};
+        bool first = true;
+    };
+
+    static void WriteLoop(Writer* writer);
+    static void WriteEntry(Writer& writer, const HarEntry& entry);
+
+    static std::atomic<bool> enabled;
+    static std::atomic<uint64_t> sampleThreshold;               ///< Sample if a 64-bit draw is below this
+    static std::atomic<bool> captureCredentials;                ///< Export credential headers unredacted
+    static std::shared_ptr<Writer> writer;                      ///< Accessed with std::atomic_load/store
+    static std::mutex controlMutex;                             ///< Serializes Start/Stop
+};
+
+#endif // NETWORK_HAR_HPP
@@ -0,0 +1,539 @@
+/**
+ * @file NetworkJson.cpp
+ * @brief Implementation of on-demand JSON access
+ */
+
+#include "NetworkJson.hpp"
+#include "Network.hpp"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define NETWORK_JSON_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline int CountTrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+static inline bool IsWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/**
+ * @brief Character class masks of one 64-byte block, one bit per byte
+ */
+struct BlockMasks {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    uint64_t op = 0;                                            // { } [ ] : ,
+    uint64_t whitespace = 0;
+};
+
+static BlockMasks ClassifyBlock(const char* block) {
+    BlockMasks masks;
+#if NETWORK_JSON_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i caseBit = _mm_set1_epi8(0x20);                // Maps [ ] onto { }
+    const __m128i openBrace = _mm_set1_epi8('{');
+    const __m128i closeBrace = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+
+    for (int i = 0; i < 4; i++) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+        __m128i folded = _mm_or_si128(bytes, caseBit);
+        __m128i op = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, openBrace), _mm_cmpeq_epi8(folded, closeBrace)),
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, colon), _mm_cmpeq_epi8(bytes, comma)));
+        __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, space), _mm_cmpeq_epi8(bytes, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, newline), _mm_cmpeq_epi8(bytes, carriageReturn)));
+
+        int shift = i * 16;
+        masks.quote |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote)))) << shift;
+        masks.backslash |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, backslash)))) << shift;
+        masks.op |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(op))) << shift;
+        masks.whitespace |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(whitespace))) << shift;
+    }
+#else
+    for (int i = 0; i < 64; i++) {
+        char c = block[i];
+        uint64_t bit = 1ull << i;
+        if (c == '"') masks.quote |= bit;
+        else if (c == '\\') masks.backslash |= bit;
+        else if (c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',') masks.op |= bit;
+        else if (IsWhitespace(c)) masks.whitespace |= bit;
+    }
+#endif
+    return masks;
+}
+
+/**
+ * @brief Characters escaped by a backslash
+ *
+ * A backslash escapes the next character unless it is itself escaped.
+ * Backslashes are rare outside string-heavy text, so they are resolved one
+ * at a time; blocks without any cost a single test. carry is set when the
+ * block ends with an escaping backslash.
+ */
+static uint64_t FindEscaped(uint64_t backslash, uint64_t& carry) {
+    uint64_t escaped = carry;
+    if (carry) {
+        backslash &= ~1ull;
+    }
+    carry = 0;
+    while (backslash) {
+        int bit = CountTrailingZeros(backslash);
+        if (bit == 63) {
+            carry = 1;
+            break;
+        }
+        escaped |= 2ull << bit;
+        backslash &= ~(3ull << bit);
+    }
+    return escaped;
+}
+
+/**
+ * @brief Bit i of the result is the XOR of bits 0..i: set between an opening and a closing quote
+ */
+static inline uint64_t PrefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+/**
+ * @brief Stage 1: positions of every structural character and scalar start
+ *
+ * Kept: brackets, colons and commas outside strings, the opening quote of
+ * each string, and the first character of each number or literal. The
+ * last partial block is padded with spaces, which are never structural.
+ *
+ * @return false if a string is not terminated
+ */
+bool JsonDocument::BuildIndex(std::string_view text, std::vector<uint32_t>& positions) {
+    positions.clear();
+    positions.reserve(text.size() / 6 + 2);
+
+    uint64_t escapeCarry = 0;
+    uint64_t inStringCarry = 0;                                 // All ones while a string spans blocks
+    uint64_t scalarCarry = 0;
+    for (size_t offset = 0; offset < text.size(); offset += 64) {
+        char padded[64];
+        const char* block = text.data() + offset;
+        if (text.size() - offset < 64) {
+            std::memset(padded, ' ', sizeof(padded));
+            std::memcpy(padded, block, text.size() - offset);
+            block = padded;
+        }
+
+        BlockMasks masks = ClassifyBlock(block);
+        uint64_t quote = masks.quote & ~FindEscaped(masks.backslash, escapeCarry);
+        uint64_t inString = PrefixXor(quote) ^ inStringCarry;
+        inStringCarry = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+        // A scalar starts where a non-separator follows a separator
+        uint64_t scalar = ~(masks.op | masks.whitespace);
+        uint64_t nonQuoteScalar = scalar & ~quote;
+        uint64_t followsScalar = (nonQuoteScalar << 1) | scalarCarry;
+        scalarCarry = nonQuoteScalar >> 63;
+
+        // inString ^ quote covers string contents and closing quotes, not opening quotes
+        uint64_t structurals = (masks.op | (scalar & ~followsScalar)) & ~(inString ^ quote);
+        while (structurals) {
+            positions.push_back(static_cast<uint32_t>(offset + CountTrailingZeros(structurals)));
+            structurals &= structurals - 1;
+        }
+    }
+
+    // Sentinel, so every value has a following position
+    positions.push_back(static_cast<uint32_t>(text.size()));
+    return inStringCarry == 0;
+}
+
+/**
+ * @brief Pairs every bracket with its counterpart, recording closing positions
+ *
+ * The rest of the grammar is checked lazily, as values are accessed, so
+ * indexing costs one pass over the positions beyond stage 1.
+ */
+bool JsonDocument::MatchBrackets() {
+    matches.assign(positions.size(), 0);
+    std::vector<uint32_t> open;
+    open.reserve(64);
+
+    const char* data = text.data();
+    const uint32_t* position = positions.data();
+    uint32_t count = static_cast<uint32_t>(positions.size() - 1);
+    for (uint32_t i = 0; i < count; i++) {
+        char folded = static_cast<char>(data[position[i]] | 0x20);  // [ ] fold onto { }
+        if (folded == '{') {
+            open.push_back(i);
+        }
+        else if (folded == '}') {
+            // Closing brackets follow their openers by two code points
+            if (open.empty() || data[position[i]] - data[position[open.back()]] != 2) {
+                return false;
+            }
+            matches[open.back()] = i;
+            open.pop_back();
+        }
+    }
+    return open.empty();
+}
+
+JsonDocument JsonDocument::Parse(std::string_view text) {
+    JsonDocument document;
+    document.text = text;
+    if (text.size() >= UINT32_MAX) {
+        document.error = "Document too large";
+    }
+    else if (!BuildIndex(text, document.positions)) {
+        document.error = "Unterminated string";
+    }
+    else if (document.positions.size() < 2) {
+        document.error = "Empty document";
+    }
+    else if (!document.MatchBrackets()) {
+        document.error = "Unbalanced brackets";
+    }
+    else if (document.After(0) != document.positions.size() - 1) {
+        document.error = "Unexpected content after the top-level value";
+    }
+    else {
+        document.error.clear();
+    }
+    return document;
+}
+
+JsonValue JsonDocument::Root() const {
+    return Valid() ? JsonValue(this, 0) : JsonValue();
+}
+
+uint32_t JsonDocument::After(uint32_t index) const {
+    char c = text[positions[index]];
+    return (c == '{' || c == '[') ? matches[index] + 1 : index + 1;
+}
+
+char JsonValue::Lead() const {
+    return document ? document->text[document->positions[index]] : '\0';
+}
+
+/**
+ * @brief Text of a scalar up to the next structural position, without trailing whitespace
+ */
+std::string_view JsonValue::ScalarText() const {
+    size_t begin = document->positions[index];
+    size_t end = document->positions[index + 1];
+    while (end > begin && IsWhitespace(document->text[end - 1])) {
+        end--;
+    }
+    return document->text.substr(begin, end - begin);
+}
+
+JsonType JsonValue::Type() const {
+    switch (Lead()) {
+        case '{': return JsonType::Object;
+        case '[': return JsonType::Array;
+        case '"': return JsonType::String;
+        case 't':
+        case 'f': return JsonType::Bool;
+        case 'n': return JsonType::Null;
+        case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return JsonType::Number;
+        default:
+            return JsonType::Invalid;
+    }
+}
+
+/**
+ * @brief Value of the current element, or of the current field once its colon is confirmed
+ */
+JsonValue JsonValue::Iterator::operator*() const {
+    if (!fields) {
+        return JsonValue(document, index);
+    }
+    if (index + 2 >= end || document->text[document->positions[index + 1]] != ':') {
+        return JsonValue();
+    }
+    return JsonValue(document, index + 2);
+}
+
+/**
+ * @brief Skips the current value and its comma; never moves past the closing bracket
+ */
+JsonValue::Iterator& JsonValue::Iterator::operator++() {
+    uint32_t value = fields ? index + 2 : index;
+    if (value >= end) {
+        index = end;
+        return *this;
+    }
+    uint32_t next = document->After(value);
+    if (next < end && document->text[document->positions[next]] == ',') {
+        next++;
+    }
+    index = std::min(next, end);
+    return *this;
+}
+
+std::string_view JsonValue::Iterator::Key() const {
+    return fields ? JsonValue(document, index).RawString().value_or(std::string_view()) : std::string_view();
+}
+
+JsonValue::Range JsonValue::Elements() const {
+    if (Type() != JsonType::Array) {
+        return Range{ Iterator(nullptr, 0, 0, false), Iterator(nullptr, 0, 0, false) };
+    }
+    uint32_t close = document->matches[index];
+    return Range{ Iterator(document, index + 1, close, false), Iterator(document, close, close, false) };
+}
+
+JsonValue::Range JsonValue::Fields() const {
+    if (Type() != JsonType::Object) {
+        return Range{ Iterator(nullptr, 0, 0, true), Iterator(nullptr, 0, 0, true) };
+    }
+    uint32_t close = document->matches[index];
+    return Range{ Iterator(document, index + 1, close, true), Iterator(document, close, close, true) };
+}
+
+size_t JsonValue::Size() const {
+    size_t count = 0;
+    Range range = (Type() == JsonType::Object) ? Fields() : Elements();
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Scans the fields in order, comparing raw keys and unescaping only keys that contain escapes
+ */
+JsonValue JsonValue::operator[](std::string_view key) const {
+    Range fields = Fields();
+    for (auto it = fields.begin(); it != fields.end(); ++it) {
+        std::string_view name = it.Key();
+        if (name.find('\\') == std::string_view::npos
+                ? name == key
+                : JsonValue(document, it.index).AsString() == std::optional<std::string>(std::string(key))) {
+            return *it;
+        }
+    }
+    return JsonValue();
+}
+
+JsonValue JsonValue::operator[](size_t position) const {
+    Range elements = Elements();
+    for (auto it = elements.begin(); it != elements.end(); ++it) {
+        if (position-- == 0) {
+            return *it;
+        }
+    }
+    return JsonValue();
+}
+
+std::optional<bool> JsonValue::AsBool() const {
+    if (Type() != JsonType::Bool) {
+        return std::nullopt;
+    }
+    std::string_view literal = ScalarText();
+    if (literal == "true") return true;
+    if (literal == "false") return false;
+    return std::nullopt;
+}
+
+std::optional<int64_t> JsonValue::AsInt64() const {
+    if (Type() != JsonType::Number) {
+        return std::nullopt;
+    }
+    std::string_view number = ScalarText();
+    int64_t value = 0;
+    auto result = std::from_chars(number.data(), number.data() + number.size(), value);
+    if (result.ec != std::errc() || result.ptr != number.data() + number.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<uint64_t> JsonValue::AsUint64() const {
+    if (Type() != JsonType::Number) {
+        return std::nullopt;
+    }
+    std::string_view number = ScalarText();
+    uint64_t value = 0;
+    auto result = std::from_chars(number.data(), number.data() + number.size(), value);
+    if (result.ec != std::errc() || result.ptr != number.data() + number.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<double> JsonValue::AsDouble() const {
+    if (Type() != JsonType::Number) {
+        return std::nullopt;
+    }
+    std::string_view number = ScalarText();
+    for (char c : number) {
+        if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+            return std::nullopt;  // from_chars would also accept inf and nan
+        }
+    }
+    double value = 0.0;
+    auto result = std::from_chars(number.data(), number.data() + number.size(), value);
+    if (result.ec != std::errc() || result.ptr != number.data() + number.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+/**
+ * @brief The closing quote is the last character before the next structural position
+ */
+std::optional<std::string_view> JsonValue::RawString() const {
+    if (Type() != JsonType::String) {
+        return std::nullopt;
+    }
+    std::string_view quoted = ScalarText();
+    if (quoted.size() < 2 || quoted.back() != '"') {
+        return std::nullopt;
+    }
+    return quoted.substr(1, quoted.size() - 2);
+}
+
+static int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool ReadHex4(std::string_view text, size_t at, uint32_t& value) {
+    if (at + 4 > text.size()) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = at; i < at + 4; i++) {
+        int digit = HexValue(text[i]);
+        if (digit < 0) {
+            return false;
+        }
+        value = (value << 4) | static_cast<uint32_t>(digit);
+    }
+    return true;
+}
+
+static void AppendUtf8(std::string& out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+std::optional<std::string> JsonValue::AsString() const {
+    std::optional<std::string_view> raw = RawString();
+    if (!raw) {
+        return std::nullopt;
+    }
+
+    std::string_view text = *raw;
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (++i == text.size()) {
+            return std::nullopt;
+        }
+        switch (text[i]) {
+            case '"':  out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/'; break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                uint32_t codePoint = 0;
+                if (!ReadHex4(text, i + 1, codePoint)) {
+                    return std::nullopt;
+                }
+                i += 4;
+                // Combine a surrogate pair
+                uint32_t low = 0;
+                if (codePoint >= 0xD800 && codePoint < 0xDC00 &&
+                    i + 2 < text.size() && text[i + 1] == '\\' && text[i + 2] == 'u' &&
+                    ReadHex4(text, i + 3, low) && low >= 0xDC00 && low < 0xE000) {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+                AppendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                return std::nullopt;
+        }
+    }
+    return out;
+}
+
+std::string_view JsonValue::RawJson() const {
+    if (!document) {
+        return std::string_view();
+    }
+    size_t begin = document->positions[index];
+    char c = Lead();
+    if (c == '{' || c == '[') {
+        return document->text.substr(begin, document->positions[document->matches[index]] + 1 - begin);
+    }
+    return ScalarText();
+}
+
+/**
+ * @brief Indexes the body in place; the document refers to body and must not outlive it
+ */
+JsonDocument Network::NetworkResponse::json() const {
+    return JsonDocument::Parse(body);
+}
@@ -0,0 +1,216 @@
+/**
+ * @file NetworkJson.hpp
+ * @brief On-demand JSON access to response bodies
+ *
+ * Parsing runs in two stages, in the style of simdjson:
+ *
+ *  1. A structural index is built over the body in 64-byte blocks with SSE2:
+ *     quote, backslash, bracket, separator and whitespace masks are combined
+ *     into one bit per structural character, string interiors are masked out
+ *     with a prefix XOR, and the set bits are flattened into positions. A
+ *     pass over the positions then pairs brackets, so any value can be
+ *     skipped in constant time.
+ *  2. Values are decoded only when accessed. Looking up a key walks the
+ *     object's fields by index, skipping the values it passes over; numbers
+ *     and strings are converted when asked for, not before.
+ *
+ * The document refers to the text it was built from without copying it.
+ * NetworkResponse::json() builds one over the response body, which the
+ * library reads into directly, so the body is never copied on its way from
+ * WinHTTP to the caller's values.
+ *
+ * @code
+ * auto document = response.json();
+ * for (JsonValue order : document.Root()["orders"].Elements()) {
+ *     int64_t id = order["id"].AsInt64().value_or(0);
+ *     std::string_view status = order["status"].RawString().value_or("");
+ * }
+ * @endcode
+ *
+ * Parse rejects unterminated strings, unbalanced brackets and trailing
+ * content; like simdjson's on-demand API, the rest of the grammar is checked
+ * only where values are accessed. Errors never throw: a missing key, a value
+ * of the wrong type or malformed content yields an invalid JsonValue or
+ * std::nullopt, and invalid values can be chained.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_JSON_HPP
+#define NETWORK_JSON_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class JsonDocument;
+
+/**
+ * @brief Kinds of JSON value
+ */
+enum class JsonType {
+    Invalid,                                                    ///< Missing, or not a well-formed value
+    Null,                                                       ///< null
+    Bool,                                                       ///< true or false
+    Number,                                                     ///< Any JSON number
+    String,                                                     ///< String
+    Array,                                                      ///< Array
+    Object                                                      ///< Object
+};
+
+/**
+ * @brief Lightweight handle to one value inside a JsonDocument
+ *
+ * Copying is free; the handle is only valid while its document is.
+ */
+class JsonValue {
+public:
+    JsonValue() = default;
+
+    /**
+     * @brief Iterates the elements of an array or the values of an object
+     */
+    class Iterator {
+    public:
+        JsonValue operator*() const;
+        Iterator& operator++();
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+
+        /**
+         * @brief Key of the current field when iterating an object
+         */
+        std::string_view Key() const;
+
+    private:
+        friend class JsonValue;
+        Iterator(const JsonDocument* document, uint32_t index, uint32_t end, bool fields)
+            : document(document), index(index), end(end), fields(fields) {}
+
+        const JsonDocument* document = nullptr;
+        uint32_t index = 0;                                     // Structural index of the current element or key
+        uint32_t end = 0;                                       // Structural index of the closing bracket
+        bool fields = false;                                    // Iterating an object
+    };
+
+    /**
+     * @brief Begin/end pair for range-based for loops
+     */
+    struct Range {
+        Iterator first;
+        Iterator last;
+        Iterator begin() const { return first; }
+        Iterator end() const { return last; }
+    };
+
+    JsonType Type() const;
+    bool Valid() const { return Type() != JsonType::Invalid; }
+    bool IsNull() const { return Type() == JsonType::Null; }
+
+    /**
+     * @brief Look up a field of an object
+     * @param key Field name (compared after unescaping)
+     * @return The field's value, or an invalid value if absent or this is not an object
+     */
+    JsonValue operator[](std::string_view key) const;
+
+    /**
+     * @brief Look up an array element by position (linear in the position)
+     * @param position Zero-based position
+     * @return The element, or an invalid value if out of range or this is not an array
+     */
+    JsonValue operator[](size_t position) const;
+    JsonValue operator[](int position) const { return position < 0 ? JsonValue() : (*this)[static_cast<size_t>(position)]; }
+
+    /**
+     * @brief Elements of an array (empty for other types)
+     */
+    Range Elements() const;
+
+    /**
+     * @brief Fields of an object (empty for other types); use Iterator::Key for the names
+     */
+    Range Fields() const;
+
+    /**
+     * @brief Number of elements or fields (linear in the count)
+     */
+    size_t Size() const;
+
+    std::optional<bool> AsBool() const;
+    std::optional<int64_t> AsInt64() const;
+    std::optional<uint64_t> AsUint64() const;
+    std::optional<double> AsDouble() const;
+
+    /**
+     * @brief String value with escapes decoded
+     */
+    std::optional<std::string> AsString() const;
+
+    /**
+     * @brief String contents exactly as written between the quotes, escapes included
+     *
+     * Points into the document's text; no allocation.
+     */
+    std::optional<std::string_view> RawString() const;
+
+    /**
+     * @brief JSON text of this value, as written
+     */
+    std::string_view RawJson() const;
+
+private:
+    friend class JsonDocument;
+    JsonValue(const JsonDocument* document, uint32_t index) : document(document), index(index) {}
+
+    char Lead() const;
+    std::string_view ScalarText() const;
+
+    const JsonDocument* document = nullptr;
+    uint32_t index = 0;                                         // Position of the value in the structural index
+};
+
+/**
+ * @brief Structural index over a JSON text
+ */
+class JsonDocument {
+public:
+    JsonDocument() = default;
+
+    /**
+     * @brief Index a JSON text; the text must outlive the document
+     * @param text JSON text
+     * @return Document; check Valid() before use
+     */
+    static JsonDocument Parse(std::string_view text);
+
+    bool Valid() const { return error.empty(); }
+    const std::string& Error() const { return error; }          ///< Why indexing failed
+
+    /**
+     * @brief The top-level value (invalid if the document is)
+     */
+    JsonValue Root() const;
+
+    /**
+     * @brief Number of structural positions in the index
+     */
+    size_t StructuralCount() const { return positions.size(); }
+
+private:
+    friend class JsonValue;
+
+    static bool BuildIndex(std::string_view text, std::vector<uint32_t>& positions);
+    bool MatchBrackets();
+    uint32_t After(uint32_t index) const;                       // Index of the structural following a value
+
+    std::string_view text;
+    std::vector<uint32_t> positions;                            // Offsets of structural characters and scalar starts
+    std::vector<uint32_t> matches;                              // For an opening bracket, index of its closing bracket
+    std::string error = "Empty document";
+};
+
+#endif // NETWORK_JSON_HPP
@@ -0,0 +1,325 @@
+/**
+ * @file NetworkJsonWriter.cpp
+ * @brief Implementation of the streaming JSON serializer
+ */
+
+#include "NetworkJsonWriter.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define NETWORK_JSON_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static const size_t kMaxEscapedChar = 6;                        // \u00XX
+
+/**
+ * @brief Escape letter for each byte: 0 if written as is, 'u' for \u00XX
+ */
+struct EscapeTable {
+    char letter[256] = {};
+
+    EscapeTable() {
+        for (int c = 0; c < 0x20; c++) {
+            letter[c] = 'u';
+        }
+        letter['\b'] = 'b';
+        letter['\f'] = 'f';
+        letter['\n'] = 'n';
+        letter['\r'] = 'r';
+        letter['\t'] = 't';
+        letter['"'] = '"';
+        letter['\\'] = '\\';
+    }
+};
+
+static const EscapeTable kEscape;
+
+static inline char* EscapeChar(unsigned char c, char* out) {
+    static const char hexDigits[] = "0123456789abcdef";
+    char letter = kEscape.letter[c];
+    *out++ = '\\';
+    *out++ = letter;
+    if (letter == 'u') {
+        *out++ = '0';
+        *out++ = '0';
+        *out++ = hexDigits[c >> 4];
+        *out++ = hexDigits[c & 0xF];
+    }
+    return out;
+}
+
+/**
+ * @brief Escapes count bytes into out, which has room for kMaxEscapedChar per byte
+ *
+ * With SSE2, 16 bytes are tested at once for quotes, backslashes and control
+ * characters; runs without any are stored whole. Bytes of 0x80 and above are
+ * UTF-8 and pass through unchanged.
+ *
+ * @return Bytes written
+ */
+static size_t EscapeInto(const char* in, size_t count, char* out) {
+    char* start = out;
+    size_t i = 0;
+#if NETWORK_JSON_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    while (i + 16 <= count) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+
+        // Room for 16 bytes is guaranteed, so the whole chunk is stored even when only a prefix is kept
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), chunk);
+        if (mask == 0) {
+            out += 16;
+            i += 16;
+            continue;
+        }
+#ifdef _MSC_VER
+        unsigned long first;
+        _BitScanForward(&first, mask);
+#else
+        unsigned first = static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        out += first;
+        i += first;
+        out = EscapeChar(static_cast<unsigned char>(in[i]), out);
+        i++;
+    }
+#endif
+    for (; i < count; i++) {
+        unsigned char c = static_cast<unsigned char>(in[i]);
+        if (kEscape.letter[c]) {
+            out = EscapeChar(c, out);
+        }
+        else {
+            *out++ = static_cast<char>(c);
+        }
+    }
+    return static_cast<size_t>(out - start);
+}
+
+JsonKey::JsonKey(std::string_view name) {
+    literal.resize(name.size() * kMaxEscapedChar + 3);
+    literal[0] = '"';
+    size_t written = 1 + EscapeInto(name.data(), name.size(), &literal[1]);
+    literal[written++] = '"';
+    literal[written++] = ':';
+    literal.resize(written);
+}
+
+char* JsonWriter::Reserve(size_t size) {
+    if (blocks.empty() || kBlockSize - blocks.back().used < size) {
+        Block block;
+        block.data.reset(new char[kBlockSize]);
+        blocks.push_back(std::move(block));
+    }
+    return blocks.back().data.get() + blocks.back().used;
+}
+
+void JsonWriter::Append(const char* data, size_t size) {
+    while (size > 0) {
+        char* out = Reserve(1);
+        size_t length = std::min(size, kBlockSize - blocks.back().used);
+        std::memcpy(out, data, length);
+        Commit(length);
+        data += length;
+        size -= length;
+    }
+}
+
+/**
+ * @brief Escapes a string into the blocks, filling each before starting the next
+ */
+void JsonWriter::AppendEscaped(std::string_view value) {
+    static const size_t kMinimumRoom = 16 * kMaxEscapedChar;
+
+    const char* in = value.data();
+    size_t remaining = value.size();
+    while (remaining > 0) {
+        char* out = Reserve(kMinimumRoom);
+        size_t count = std::min(remaining, (kBlockSize - blocks.back().used) / kMaxEscapedChar);
+        Commit(EscapeInto(in, count, out));
+        in += count;
+        remaining -= count;
+    }
+}
+
+void JsonWriter::Separator() {
+    if (pendingComma) {
+        *Reserve(1) = ',';
+        Commit(1);
+    }
+}
+
+JsonWriter& JsonWriter::BeginObject() {
+    Separator();
+    *Reserve(1) = '{';
+    Commit(1);
+    pendingComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndObject() {
+    *Reserve(1) = '}';
+    Commit(1);
+    pendingComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::BeginArray() {
+    Separator();
+    *Reserve(1) = '[';
+    Commit(1);
+    pendingComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndArray() {
+    *Reserve(1) = ']';
+    Commit(1);
+    pendingComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Key(std::string_view name) {
+    Separator();
+    *Reserve(1) = '"';
+    Commit(1);
+    AppendEscaped(name);
+    Append("\":", 2);
+    pendingComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Key(const JsonKey& key) {
+    Separator();
+    Append(key.Literal().data(), key.Literal().size());
+    pendingComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::String(std::string_view value) {
+    Separator();
+    *Reserve(1) = '"';
+    Commit(1);
+    AppendEscaped(value);
+    *Reserve(1) = '"';
+    Commit(1);
+    pendingComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Int(int64_t value) {
+    static const size_t kMaxDigits = 20;                        // -9223372036854775808
+
+    Separator();
+    char* out = Reserve(kMaxDigits);
+    Commit(static_cast<size_t>(std::to_chars(out, out + kMaxDigits, value).ptr - out));
+    pendingComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Uint(uint64_t value) {
+    static const size_t kMaxDigits = 20;                        // 18446744073709551615
+
+    Separator();
+    char* out = Reserve(kMaxDigits);
+    Commit(static_cast<size_t>(std::to_chars(out, out + kMaxDigits, value).ptr - out));
+    pendingComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Double(double value) {
+    static const size_t kMaxChars = 32;                         // Shortest round-trip form is at most 24
+
+    if (!std::isfinite(value)) {
+        return Null();
+    }
+    Separator();
+    char* out = Reserve(kMaxChars);
+    Commit(static_cast<size_t>(std::to_chars(out, out + kMaxChars, value).ptr - out));
+    pendingComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Bool(bool value) {
+    return RawJson(value ? std::string_view("true") : std::string_view("false"));
+}
+
+JsonWriter& JsonWriter::Null() {
+    return RawJson("null");
+}
+
+JsonWriter& JsonWriter::RawJson(std::string_view json) {
+    Separator();
+    Append(json.data(), json.size());
+    pendingComma = true;
+    return *this;
+}
+
+std::string JsonWriter::ToString() const {
+    std::string result;
+    result.reserve(static_cast<size_t>(length));
+    for (const auto& block : blocks) {
+        result.append(block.data.get(), block.used);
+    }
+    return result;
+}
+
+void JsonWriter::Clear() {
+    if (blocks.size() > 1) {
+        blocks.resize(1);
+    }
+    if (!blocks.empty()) {
+        blocks[0].used = 0;
+    }
+    length = 0;
+    pendingComma = false;
+    readBlock = 0;
+    readOffset = 0;
+}
+
+bool JsonWriter::Read(char* buffer, size_t capacity, size_t& bytesRead) {
+    bytesRead = 0;
+    while (bytesRead < capacity && readBlock < blocks.size()) {
+        const Block& block = blocks[readBlock];
+        size_t count = std::min(capacity - bytesRead, block.used - readOffset);
+        std::memcpy(buffer + bytesRead, block.data.get() + readOffset, count);
+        bytesRead += count;
+        readOffset += count;
+        if (readOffset == block.used) {
+            readBlock++;
+            readOffset = 0;
+        }
+    }
+    return true;
+}
+
+bool JsonWriter::NextBlock(std::string_view& block) {
+    block = std::string_view();
+    while (readBlock < blocks.size() && block.empty()) {
+        const Block& current = blocks[readBlock];
+        block = std::string_view(current.data.get() + readOffset, current.used - readOffset);
+        readBlock++;
+        readOffset = 0;
+    }
+    return true;
+}
+
+void JsonWriter::Done() {
+    // Rewind so the same document can be sent again, by a retry for example
+    readBlock = 0;
+    readOffset = 0;
+}
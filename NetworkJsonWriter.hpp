@@ -0,0 +1,141 @@
+/**
+ * @file NetworkJsonWriter.hpp
+ * @brief Streaming JSON serializer for request bodies
+ *
+ * JsonWriter serializes straight into a chain of fixed-size blocks and is
+ * itself the request body: Network sends the blocks as they are, so a body is
+ * produced in one pass with no intermediate std::string and no second copy.
+ *
+ * Numbers are formatted with std::to_chars (shortest round-trip form for
+ * doubles), strings are escaped 16 bytes at a time with SSE2, and keys used
+ * repeatedly can be escaped once up front as JsonKey literals.
+ *
+ * @code
+ * static const JsonKey kName("name");
+ * static const JsonKey kAge("age");
+ *
+ * JsonWriter json;
+ * json.BeginObject()
+ *         .Key(kName).String(user.name)
+ *         .Key(kAge).Int(user.age)
+ *         .Key("interests").BeginArray();
+ * for (const auto& interest : user.interests) {
+ *     json.String(interest);
+ * }
+ * json.EndArray().EndObject();
+ * auto response = Network::Post(url, json, JsonWriter::ContentType());
+ * @endcode
+ *
+ * The writer inserts commas and colons but does not check that calls form a
+ * well-nested document; that is up to the caller. Non-finite doubles, which
+ * JSON cannot represent, are written as null.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_JSON_WRITER_HPP
+#define NETWORK_JSON_WRITER_HPP
+
+#include "Network.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Object key escaped once, ready to be copied into any number of documents
+ */
+class JsonKey {
+public:
+    explicit JsonKey(std::string_view name);
+
+    /**
+     * @brief The quoted, escaped key followed by its colon
+     */
+    std::string_view Literal() const { return literal; }
+
+private:
+    std::string literal;
+};
+
+/**
+ * @brief JSON document written into send-ready blocks
+ */
+class JsonWriter : public Network::BodySource {
+public:
+    JsonWriter() = default;
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    static const char* ContentType() { return "application/json"; }
+
+    JsonWriter& BeginObject();
+    JsonWriter& EndObject();
+    JsonWriter& BeginArray();
+    JsonWriter& EndArray();
+
+    /**
+     * @brief Start a field; the next value written is its value
+     */
+    JsonWriter& Key(std::string_view name);
+    JsonWriter& Key(const JsonKey& key);
+
+    JsonWriter& String(std::string_view value);
+    JsonWriter& Int(int64_t value);
+    JsonWriter& Uint(uint64_t value);
+    JsonWriter& Double(double value);
+    JsonWriter& Bool(bool value);
+    JsonWriter& Null();
+
+    /**
+     * @brief Insert already serialized JSON as the next value, unchanged
+     */
+    JsonWriter& RawJson(std::string_view json);
+
+    /**
+     * @brief Bytes written so far
+     */
+    uint64_t Length() const { return length; }
+
+    /**
+     * @brief Copy of the document, for logging and tests
+     */
+    std::string ToString() const;
+
+    /**
+     * @brief Discard the document, keeping the first block for reuse
+     */
+    void Clear();
+
+    std::optional<uint64_t> Size() const override { return length; }
+    bool Read(char* buffer, size_t capacity, size_t& bytesRead) override;
+    bool NextBlock(std::string_view& block) override;
+    void Done() override;
+
+private:
+    static const size_t kBlockSize = 64 * 1024;
+
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t used = 0;
+    };
+
+    void Separator();
+    char* Reserve(size_t size);                                 // Contiguous room for size bytes (size <= kBlockSize)
+    void Commit(size_t size) { blocks.back().used += size; length += size; }
+    void Append(const char* data, size_t size);
+    void AppendEscaped(std::string_view value);
+
+    std::vector<Block> blocks;
+    uint64_t length = 0;
+    bool pendingComma = false;                                  // A value precedes the next one at this level
+
+    // Send position
+    size_t readBlock = 0;
+    size_t readOffset = 0;
+};
+
+#endif // NETWORK_JSON_WRITER_HPP
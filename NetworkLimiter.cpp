@@ -0,0 +1,222 @@
+/**
+ * @file NetworkLimiter.cpp
+ * @brief Implementation of adaptive per-host concurrency limits
+ */
+
+#include "NetworkLimiter.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Initialize static members
+std::atomic<bool> NetworkLimiter::enabled{false};
+NetworkLimiter::Options NetworkLimiter::options;
+NetworkLimiter::HostMap NetworkLimiter::hosts;
+std::mutex NetworkLimiter::registryMutex;
+
+// Weight of a new sample in the smoothed latency
+static const double kSmoothing = 0.2;
+// Hosts tracked before unused ones are forgotten
+static const size_t kMaxHosts = 1024;
+// Unused hosts idle for this long are forgotten first
+static const std::chrono::minutes kHostIdleTtl(10);
+
+/**
+ * @brief Whether a response signals that the host is overloaded
+ */
+static bool IsOverloadSignal(const Network::NetworkResponse& response) {
+    switch (response.error_type) {
+        case Network::ErrorType::Timeout:
+        case Network::ErrorType::Connection:
+            return true;
+        case Network::ErrorType::Http:
+            return response.status_code == 429 || response.status_code == 503;
+        default:
+            return false;
+    }
+}
+
+NetworkLimiter::Permit::Permit(Permit&& other) noexcept
+    : host(std::move(other.host)), acquired(other.acquired) {
+}
+
+NetworkLimiter::Permit& NetworkLimiter::Permit::operator=(Permit&& other) noexcept {
+    if (this != &other) {
+        Release();
+        host = std::move(other.host);
+        acquired = other.acquired;
+    }
+    return *this;
+}
+
+NetworkLimiter::Permit::~Permit() {
+    Release();
+}
+
+void NetworkLimiter::Permit::Release() {
+    if (host) {
+        std::lock_guard<std::mutex> lock(host->mutex);
+        host->inFlight--;
+        host->permitFreed.notify_one();
+        host.reset();
+    }
+}
+
+void NetworkLimiter::Permit::Complete(const Network::NetworkResponse& response) {
+    if (!host) {
+        return;
+    }
+    bool overloaded = IsOverloadSignal(response);
+    // Other failures (DNS, TLS, 4xx, ...) say nothing about the host's load
+    if (overloaded || response.error_type == Network::ErrorType::None || response.error_type == Network::ErrorType::Http) {
+        double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - acquired).count();
+        std::lock_guard<std::mutex> lock(host->mutex);
+        Update(*host, latency, overloaded);
+    }
+    Release();
+}
+
+void NetworkLimiter::Enable(const Options& newOptions) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    options = newOptions;
+    options.min_limit = std::max(options.min_limit, 1);
+    options.max_limit = std::max(options.max_limit, options.min_limit);
+    hosts.clear();
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void NetworkLimiter::Disable() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    enabled.store(false, std::memory_order_relaxed);
+    hosts.clear();
+}
+
+std::shared_ptr<NetworkLimiter::Host> NetworkLimiter::FindHost(const std::string& key) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto now = std::chrono::steady_clock::now();
+    auto it = hosts.find(key);
+    if (it == hosts.end()) {
+        Prune(now);
+        auto host = std::make_shared<Host>();
+        host->name = key;
+        host->options = options;
+        host->limit = std::min(std::max(options.initial_limit, options.min_limit), options.max_limit);
+        it = hosts.emplace(key, std::move(host)).first;
+    }
+    it->second->lastUsed = now;
+    return it->second;
+}
+
+/**
+ * @brief Forgets unused hosts once kMaxHosts are tracked (call with registryMutex held)
+ *
+ * A host is unused when the map holds its only reference: permits and
+ * requests waiting in Acquire hold one each, and new ones are only handed out
+ * under registryMutex. Hosts idle for kHostIdleTtl go first; if that is not
+ * enough, every unused host goes.
+ */
+void NetworkLimiter::Prune(std::chrono::steady_clock::time_point now) {
+    if (hosts.size() < kMaxHosts) {
+        return;
+    }
+    for (auto it = hosts.begin(); it != hosts.end();) {
+        bool idle = it->second.use_count() == 1 && now - it->second->lastUsed >= kHostIdleTtl;
+        it = idle ? hosts.erase(it) : std::next(it);
+    }
+    if (hosts.size() >= kMaxHosts) {
+        for (auto it = hosts.begin(); it != hosts.end();) {
+            it = it->second.use_count() == 1 ? hosts.erase(it) : std::next(it);
+        }
+    }
+}
+
+/**
+ * @brief Waits for a permit while the host is at its limit
+ *
+ * @param host The target host
+ * @param port The target port
+ * @param permit The permit to fill in
+ * @return true if a permit was granted
+ */
+bool NetworkLimiter::Acquire(const std::string& host, int port, Permit& permit) {
+    auto target = FindHost(host + ":" + std::to_string(port));
+
+    std::unique_lock<std::mutex> lock(target->mutex);
+    auto underLimit = [&target]() { return target->inFlight < static_cast<int>(target->limit); };
+    if (!underLimit() &&
+        !target->permitFreed.wait_for(lock, std::chrono::milliseconds(target->options.queue_timeout_ms), underLimit)) {
+        target->rejected++;
+        return false;
+    }
+    target->inFlight++;
+    lock.unlock();
+
+    permit.host = std::move(target);
+    permit.acquired = std::chrono::steady_clock::now();
+    return true;
+}
+
+/**
+ * @brief Adjusts a host's limit from one completed request
+ *
+ * The requests queued at the host are estimated as limit * (1 - min / smoothed).
+ * The limit grows by 1/limit per sample (about one per round trip) while that
+ * is below max_queue / 2 and the limit is actually in use, and shrinks by
+ * backoff, at most once per smoothed round trip, when it exceeds max_queue or
+ * the host signals overload.
+ */
+void NetworkLimiter::Update(Host& host, double latency, bool overloaded) {
+    const Options& config = host.options;
+    auto now = std::chrono::steady_clock::now();
+
+    if (!overloaded) {
+        host.smoothedLatency = (host.smoothedLatency == 0.0)
+            ? latency
+            : host.smoothedLatency * (1.0 - kSmoothing) + latency * kSmoothing;
+        if (host.minLatency == 0.0 || latency < host.minLatency) {
+            host.minLatency = latency;
+        }
+        if (++host.windowSamples >= config.min_latency_window) {
+            host.minLatency = latency;  // Re-learn, in case the backend got permanently slower
+            host.windowSamples = 0;
+        }
+    }
+
+    double queued = (host.smoothedLatency > 0.0) ? host.limit * (1.0 - host.minLatency / host.smoothedLatency) : 0.0;
+    if (overloaded || queued > config.max_queue) {
+        if (now - host.lastDecrease >= std::chrono::duration<double>(host.smoothedLatency)) {
+            host.limit = std::max(host.limit * config.backoff, static_cast<double>(config.min_limit));
+            host.lastDecrease = now;
+        }
+    }
+    else if (queued < config.max_queue / 2 && host.inFlight * 2 >= host.limit) {
+        double previous = host.limit;
+        host.limit = std::min(host.limit + 1.0 / host.limit, static_cast<double>(config.max_limit));
+        if (std::floor(host.limit) > std::floor(previous)) {
+            host.permitFreed.notify_one();
+        }
+    }
+}
+
+std::vector<NetworkLimiter::HostStats> NetworkLimiter::GetStats() {
+    std::vector<std::shared_ptr<Host>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& [key, host] : hosts) {
+            snapshot.push_back(host);
+        }
+    }
+
+    std::vector<HostStats> stats;
+    for (const auto& host : snapshot) {
+        std::lock_guard<std::mutex> lock(host->mutex);
+        HostStats entry;
+        entry.host = host->name;
+        entry.limit = host->limit;
+        entry.in_flight = host->inFlight;
+        entry.min_latency = std::chrono::microseconds(static_cast<int64_t>(host->minLatency * 1e6));
+        entry.smoothed_latency = std::chrono::microseconds(static_cast<int64_t>(host->smoothedLatency * 1e6));
+        entry.rejected = host->rejected;
+        stats.push_back(entry);
+    }
+    return stats;
+}
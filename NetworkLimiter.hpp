@@ -0,0 +1,161 @@
+/**
+ * @file NetworkLimiter.hpp
+ * @brief Adaptive per-host concurrency limits
+ *
+ * When enabled, every upstream host:port gets a concurrency limit that adapts
+ * to the latency it observes:
+ *
+ *  - From the smoothed latency and the minimum observed latency it estimates,
+ *    Vegas-style, how many requests are queuing at the host:
+ *    limit * (1 - min / smoothed).
+ *  - While that stays below half of `max_queue` (latency is flat), the limit
+ *    grows by about one per round trip.
+ *  - When it exceeds `max_queue`, or a request times out, is reset or is
+ *    answered 429/503, the limit is cut by `backoff`, at most once per round
+ *    trip.
+ *
+ * Requests over the limit wait up to `queue_timeout_ms` for a permit and then
+ * fail with ErrorType::ResourceLimit. The minimum latency is re-learned
+ * periodically so that a backend that becomes permanently slower is not
+ * starved. Once many hosts are tracked, those with no request in flight or
+ * waiting are forgotten, idle ones first, and start over from
+ * `initial_limit` when they are seen again.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_LIMITER_HPP
+#define NETWORK_LIMITER_HPP
+
+#include "Network.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Registry of adaptive per-host concurrency limits
+ */
+class NetworkLimiter {
+public:
+    /**
+     * @brief Limit adaptation settings, shared by all hosts
+     */
+    struct Options {
+        int initial_limit = 20;                                 ///< Limit of a host seen for the first time
+        int min_limit = 1;                                      ///< Lower bound of the limit
+        int max_limit = 128;                                    ///< Upper bound (the WinHTTP per-server pool size)
+        double backoff = 0.9;                                   ///< Multiplicative decrease on queuing or errors
+        double max_queue = 4.0;                                 ///< Estimated requests queued at the host before backing off
+        int queue_timeout_ms = 0;                               ///< Wait for a permit before failing (0 = fail fast)
+        int min_latency_window = 1000;                          ///< Samples after which the minimum latency is re-learned
+    };
+
+    /**
+     * @brief Snapshot of one host's limit
+     */
+    struct HostStats {
+        std::string host;                                       ///< host:port
+        double limit = 0.0;                                     ///< Current limit
+        int in_flight = 0;                                      ///< Requests holding a permit
+        std::chrono::microseconds min_latency{0};               ///< Minimum latency in the current window
+        std::chrono::microseconds smoothed_latency{0};          ///< Exponentially smoothed latency
+        uint64_t rejected = 0;                                  ///< Requests refused a permit
+    };
+
+private:
+    struct Host;
+
+public:
+    /**
+     * @brief Right to send one request to a host
+     */
+    class Permit {
+    public:
+        Permit() = default;
+        Permit(Permit&& other) noexcept;
+        Permit& operator=(Permit&& other) noexcept;
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+        ~Permit();
+
+        explicit operator bool() const { return host != nullptr; }
+
+        /**
+         * @brief Feed the request's latency and outcome into the limit and release the permit
+         * @param response Completed response
+         */
+        void Complete(const Network::NetworkResponse& response);
+
+    private:
+        friend class NetworkLimiter;
+        void Release();
+
+        std::shared_ptr<Host> host;
+        std::chrono::steady_clock::time_point acquired;
+    };
+
+    /**
+     * @brief Enable adaptive limits, resetting any learned state
+     * @param options Adaptation settings
+     */
+    static void Enable(const Options& options);
+
+    /**
+     * @brief Disable adaptive limits; requests holding permits finish normally
+     */
+    static void Disable();
+
+    /**
+     * @brief Whether adaptive limits are enabled
+     */
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Obtain a permit for a host (called by Network::Request)
+     * @param host Target host
+     * @param port Target port
+     * @param permit Receives the permit
+     * @return false if the host stayed at its limit for the queue timeout
+     */
+    static bool Acquire(const std::string& host, int port, Permit& permit);
+
+    /**
+     * @brief Current state of every host tracked
+     */
+    static std::vector<HostStats> GetStats();
+
+private:
+    struct Host {
+        std::string name;
+        Options options;
+        std::mutex mutex;
+        std::condition_variable permitFreed;
+        double limit = 0.0;
+        int inFlight = 0;
+        double minLatency = 0.0;                                // Seconds; 0 until the first sample
+        double smoothedLatency = 0.0;                           // Seconds
+        int windowSamples = 0;                                  // Samples since the minimum was last reset
+        std::chrono::steady_clock::time_point lastDecrease;
+        uint64_t rejected = 0;
+        std::chrono::steady_clock::time_point lastUsed;         // Last permit request; guarded by registryMutex
+    };
+
+    using HostMap = std::map<std::string, std::shared_ptr<Host>>;
+
+    static std::shared_ptr<Host> FindHost(const std::string& key);
+    static void Update(Host& host, double latency, bool overloaded);
+    static void Prune(std::chrono::steady_clock::time_point now);
+
+    static std::atomic<bool> enabled;
+    static Options options;                                     ///< Guarded by registryMutex
+    static HostMap hosts;                                       ///< Guarded by registryMutex
+    static std::mutex registryMutex;
+};
+
+#endif // NETWORK_LIMITER_HPP
@@ -0,0 +1,556 @@
+/**
+ * @file NetworkLoadBalancer.cpp
+ * @brief Implementation of power-of-two-choices load balancing with outlier ejection
+ */
+
+// winsock2.h must precede windows.h, which Network.hpp includes
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "NetworkLoadBalancer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+#pragma comment(lib, "ws2_32.lib")
+
+// Initialize static members
+std::shared_ptr<const NetworkLoadBalancer::ServiceMap> NetworkLoadBalancer::services;
+std::atomic<size_t> NetworkLoadBalancer::serviceCount{0};
+std::mutex NetworkLoadBalancer::registryMutex;
+
+// Endpoints without a latency sample yet are costed as if they took this long
+static const double kDefaultLatencyNanos = 1000000.0;
+// Re-admitted endpoints start at this share of their normal weight
+static const double kMinimumWeight = 0.1;
+// Prime Maglev table size, at least 100 slots per endpoint for up to several hundred endpoints
+static const uint32_t kMaglevTableSize = 65537;
+static const uint16_t kMaglevEmpty = 0xFFFF;
+
+static int64_t SteadyNanos(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+/**
+ * @brief Per-thread xorshift64* generator for candidate selection
+ */
+static uint64_t NextRandom() {
+    thread_local uint64_t state = 0;
+    if (state == 0) {
+        state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+    }
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+/**
+ * @brief FNV-1a followed by a 64-bit finalizer, stable across runs and platforms
+ */
+static uint64_t StableHash(const std::string& value, uint64_t seed) {
+    uint64_t hash = 14695981039346656037ULL ^ seed;
+    for (unsigned char c : value) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+ * @brief Non-blocking connect to any address of host:port, bounded by a timeout
+ */
+static bool TcpProbe(const std::string& host, int port, int timeoutMs) {
+    static const bool winsockReady = []() {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    if (!winsockReady) {
+        return false;
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+        return false;
+    }
+
+    bool connected = false;
+    for (addrinfo* address = addresses; address && !connected; address = address->ai_next) {
+        SOCKET sock = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (sock == INVALID_SOCKET) {
+            continue;
+        }
+        u_long nonBlocking = 1;
+        ioctlsocket(sock, FIONBIO, &nonBlocking);
+        if (connect(sock, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0) {
+            connected = true;
+        }
+        else if (WSAGetLastError() == WSAEWOULDBLOCK) {
+            fd_set writable, failed;
+            FD_ZERO(&writable);
+            FD_ZERO(&failed);
+            FD_SET(sock, &writable);
+            FD_SET(sock, &failed);
+            timeval timeout = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+            connected = select(0, nullptr, &writable, &failed, &timeout) > 0 && FD_ISSET(sock, &writable);
+        }
+        closesocket(sock);
+    }
+    freeaddrinfo(addresses);
+    return connected;
+}
+
+/**
+ * @brief Whether a response counts against the endpoint's health
+ */
+static bool IsEndpointFailure(const Network::NetworkResponse& response) {
+    switch (response.error_type) {
+        case Network::ErrorType::Dns:
+        case Network::ErrorType::Connect:
+        case Network::ErrorType::Tls:
+        case Network::ErrorType::Timeout:
+        case Network::ErrorType::Connection:
+            return true;
+        case Network::ErrorType::Http:
+            return response.status_code >= 500;
+        default:
+            return false;
+    }
+}
+
+NetworkLoadBalancer::Lease::Lease(std::shared_ptr<Service> service, Endpoint* endpoint)
+    : service(std::move(service)), endpoint(endpoint), acquired(std::chrono::steady_clock::now()) {
+    endpoint->outstanding.fetch_add(1, std::memory_order_relaxed);
+    this->service->outstanding.fetch_add(1, std::memory_order_relaxed);
+}
+
+NetworkLoadBalancer::Lease::Lease(Lease&& other) noexcept
+    : service(std::move(other.service)), endpoint(other.endpoint), acquired(other.acquired) {
+    other.endpoint = nullptr;
+}
+
+NetworkLoadBalancer::Lease& NetworkLoadBalancer::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        Release();
+        service = std::move(other.service);
+        endpoint = other.endpoint;
+        acquired = other.acquired;
+        other.endpoint = nullptr;
+    }
+    return *this;
+}
+
+NetworkLoadBalancer::Lease::~Lease() {
+    Release();
+}
+
+void NetworkLoadBalancer::Lease::Release() {
+    if (endpoint) {
+        endpoint->outstanding.fetch_sub(1, std::memory_order_relaxed);
+        service->outstanding.fetch_sub(1, std::memory_order_relaxed);
+        endpoint = nullptr;
+        service.reset();
+    }
+}
+
+const std::string& NetworkLoadBalancer::Lease::Protocol() const { return endpoint->protocol; }
+const std::string& NetworkLoadBalancer::Lease::Host() const { return endpoint->host; }
+int NetworkLoadBalancer::Lease::Port() const { return endpoint->port; }
+const std::string& NetworkLoadBalancer::Lease::BasePath() const { return endpoint->basePath; }
+
+void NetworkLoadBalancer::Lease::Complete(const Network::NetworkResponse& response) {
+    if (!endpoint) {
+        return;
+    }
+    RecordOutcome(*service, *endpoint, response, std::chrono::steady_clock::now() - acquired);
+    Release();
+}
+
+/**
+ * @brief Registers a service, replacing any service with the same name
+ *
+ * @param name The host name requests use for the service
+ * @param endpoints The endpoint base URLs
+ * @param config The routing and outlier detection settings
+ * @return true if all endpoint URLs were valid
+ */
+bool NetworkLoadBalancer::RegisterService(
+    const std::string& name,
+    const std::vector<std::string>& endpoints,
+    const ServiceConfig& config
+) {
+    if (endpoints.empty() || (config.policy == RoutingPolicy::Maglev && endpoints.size() >= kMaglevEmpty)) {
+        return false;
+    }
+
+    auto service = std::make_shared<Service>();
+    service->config = config;
+    for (const auto& url : endpoints) {
+        auto endpoint = std::make_unique<Endpoint>();
+        if (!Network::ParseUrl(url, endpoint->protocol, endpoint->host, endpoint->basePath, endpoint->port)) {
+            return false;
+        }
+        while (!endpoint->basePath.empty() && endpoint->basePath.back() == '/') {
+            endpoint->basePath.pop_back();
+        }
+        endpoint->url = url;
+        service->endpoints.push_back(std::move(endpoint));
+    }
+    if (config.policy == RoutingPolicy::Maglev) {
+        BuildMaglevTable(*service);
+    }
+    StartProbes(service);
+
+    std::shared_ptr<Service> replaced;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto current = std::atomic_load(&services);
+        auto updated = current ? std::make_shared<ServiceMap>(*current) : std::make_shared<ServiceMap>();
+        auto& slot = (*updated)[name];
+        replaced = slot;
+        slot = service;
+        serviceCount.store(updated->size(), std::memory_order_relaxed);
+        std::atomic_store(&services, std::shared_ptr<const ServiceMap>(updated));
+    }
+    // Outside the lock: cancelling waits for a probe that is running
+    StopProbes(replaced);
+    return true;
+}
+
+void NetworkLoadBalancer::UnregisterService(const std::string& name) {
+    std::shared_ptr<Service> removed;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto current = std::atomic_load(&services);
+        if (!current || current->find(name) == current->end()) {
+            return;
+        }
+        auto updated = std::make_shared<ServiceMap>(*current);
+        removed = (*updated)[name];
+        updated->erase(name);
+        serviceCount.store(updated->size(), std::memory_order_relaxed);
+        std::atomic_store(&services, std::shared_ptr<const ServiceMap>(updated));
+    }
+    StopProbes(removed);
+}
+
+std::shared_ptr<NetworkLoadBalancer::Service> NetworkLoadBalancer::FindService(const std::string& name) {
+    auto current = std::atomic_load(&services);
+    if (!current) {
+        return nullptr;
+    }
+    auto it = current->find(name);
+    return (it != current->end()) ? it->second : nullptr;
+}
+
+NetworkLoadBalancer::Lease NetworkLoadBalancer::Acquire(const std::string& name, const std::string& routingKey) {
+    auto service = FindService(name);
+    if (!service) {
+        return Lease();
+    }
+    int64_t now = SteadyNanos(std::chrono::steady_clock::now());
+    Endpoint* endpoint = (!service->maglevTable.empty() && !routingKey.empty())
+        ? SelectByKey(*service, routingKey, now)
+        : Select(*service, now);
+    return Lease(std::move(service), endpoint);
+}
+
+/**
+ * @brief Whether an endpoint can be selected: not ejected and passing health checks
+ */
+bool NetworkLoadBalancer::IsAvailable(const Endpoint& endpoint, int64_t now) {
+    return endpoint.ejectedUntil.load(std::memory_order_relaxed) <= now &&
+           endpoint.healthy.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Schedules one periodic probe per endpoint, staggered across the interval
+ */
+void NetworkLoadBalancer::StartProbes(const std::shared_ptr<Service>& service) {
+    if (service->config.health_check == HealthCheck::None) {
+        return;
+    }
+    std::chrono::milliseconds interval(std::max(service->config.health_interval_ms, 1));
+    std::weak_ptr<Service> weakService = service;
+    size_t count = service->endpoints.size();
+    for (size_t i = 0; i < count; i++) {
+        service->probeTasks.push_back(NetworkTimer::ScheduleEvery(
+            interval * i / count,
+            interval,
+            [weakService, i]() { Probe(weakService, i); }
+        ));
+    }
+}
+
+void NetworkLoadBalancer::StopProbes(const std::shared_ptr<Service>& service) {
+    if (!service) {
+        return;
+    }
+    for (NetworkTimer::TaskId id : service->probeTasks) {
+        NetworkTimer::Cancel(id);
+    }
+}
+
+/**
+ * @brief Runs one health probe of an endpoint on the timer thread
+ *
+ * A successful request within the last interval counts as a passed probe, so
+ * endpoints carrying traffic are not probed on top of it. HTTP probes go
+ * through Network::Probe, which skips the scheduler, budget and limiter, so a
+ * saturated client cannot hold up the timer thread.
+ */
+void NetworkLoadBalancer::Probe(const std::weak_ptr<Service>& weakService, size_t index) {
+    auto service = weakService.lock();
+    if (!service) {
+        return;
+    }
+    Endpoint& endpoint = *service->endpoints[index];
+    const ServiceConfig& config = service->config;
+
+    int64_t now = SteadyNanos(std::chrono::steady_clock::now());
+    int64_t interval = static_cast<int64_t>(config.health_interval_ms) * 1000000;
+    bool passed;
+    if (now - endpoint.lastSuccess.load(std::memory_order_relaxed) < interval) {
+        passed = true;
+    }
+    else if (config.health_check == HealthCheck::Http) {
+        Network::RequestConfig probeConfig;
+        probeConfig.timeout_seconds = std::max(1, (config.health_timeout_ms + 999) / 1000);
+        probeConfig.max_retries = 0;
+        std::string url = endpoint.protocol + "://" + endpoint.host + ":" + std::to_string(endpoint.port) +
+                          endpoint.basePath + config.health_path;
+        passed = Network::Probe(url, probeConfig).success;
+    }
+    else {
+        passed = TcpProbe(endpoint.host, endpoint.port, config.health_timeout_ms);
+    }
+
+    if (passed) {
+        endpoint.probeFailures = 0;
+        if (!endpoint.healthy.load(std::memory_order_relaxed) && ++endpoint.probePasses >= config.healthy_threshold) {
+            endpoint.healthy.store(true, std::memory_order_relaxed);
+            endpoint.probePasses = 0;
+        }
+    }
+    else {
+        endpoint.probePasses = 0;
+        if (endpoint.healthy.load(std::memory_order_relaxed) && ++endpoint.probeFailures >= config.unhealthy_threshold) {
+            endpoint.healthy.store(false, std::memory_order_relaxed);
+            endpoint.probeFailures = 0;
+        }
+    }
+}
+
+/**
+ * @brief Fills the Maglev lookup table of a service
+ *
+ * Each endpoint walks its own permutation of the slots, derived from its URL,
+ * and the endpoints take turns claiming their next free slot. Slots therefore
+ * split evenly, and adding or removing an endpoint only moves the slots it
+ * gains or loses, independent of the order endpoints were listed in.
+ */
+void NetworkLoadBalancer::BuildMaglevTable(Service& service) {
+    size_t count = service.endpoints.size();
+    std::vector<uint64_t> offset(count), skip(count), next(count, 0);
+    for (size_t i = 0; i < count; i++) {
+        offset[i] = StableHash(service.endpoints[i]->url, 0) % kMaglevTableSize;
+        skip[i] = StableHash(service.endpoints[i]->url, 0x9e3779b97f4a7c15ULL) % (kMaglevTableSize - 1) + 1;
+    }
+
+    service.maglevTable.assign(kMaglevTableSize, kMaglevEmpty);
+    uint32_t filled = 0;
+    while (filled < kMaglevTableSize) {
+        for (size_t i = 0; i < count && filled < kMaglevTableSize; i++) {
+            uint64_t slot = (offset[i] + next[i] * skip[i]) % kMaglevTableSize;
+            while (service.maglevTable[slot] != kMaglevEmpty) {
+                next[i]++;
+                slot = (offset[i] + next[i] * skip[i]) % kMaglevTableSize;
+            }
+            service.maglevTable[slot] = static_cast<uint16_t>(i);
+            next[i]++;
+            filled++;
+        }
+    }
+}
+
+/**
+ * @brief Maglev lookup of a routing key
+ *
+ * Starts at the key's slot and walks forward past ejected endpoints and, with
+ * hash_load_factor set, endpoints above the load bound. A key therefore only
+ * leaves its home endpoint while that endpoint is unhealthy or overloaded.
+ */
+NetworkLoadBalancer::Endpoint* NetworkLoadBalancer::SelectByKey(Service& service, const std::string& routingKey, int64_t now) {
+    const auto& table = service.maglevTable;
+    size_t slot = StableHash(routingKey, 0) % table.size();
+
+    int bound = 0;
+    if (service.config.hash_load_factor > 0.0) {
+        double mean = (service.outstanding.load(std::memory_order_relaxed) + 1.0) / service.endpoints.size();
+        bound = static_cast<int>(std::ceil(service.config.hash_load_factor * mean));
+    }
+
+    Endpoint* healthy = nullptr;
+    for (size_t step = 0; step < table.size(); step++) {
+        Endpoint* endpoint = service.endpoints[table[(slot + step) % table.size()]].get();
+        if (!IsAvailable(*endpoint, now)) {
+            continue;
+        }
+        if (bound == 0 || endpoint->outstanding.load(std::memory_order_relaxed) < bound) {
+            return endpoint;
+        }
+        if (!healthy) {
+            healthy = endpoint;
+        }
+    }
+    // Every endpoint is over the bound or unavailable: prefer the first available one, else the home endpoint
+    return healthy ? healthy : service.endpoints[table[slot]].get();
+}
+
+/**
+ * @brief Slow-start weight: ramps from kMinimumWeight to 1 after an ejection ends
+ */
+double NetworkLoadBalancer::Weight(const Service& service, const Endpoint& endpoint, int64_t now) {
+    int64_t readmitted = endpoint.ejectedUntil.load(std::memory_order_relaxed);
+    int64_t window = static_cast<int64_t>(service.config.slow_start_ms) * 1000000;
+    if (readmitted == 0 || window <= 0 || now >= readmitted + window) {
+        return 1.0;
+    }
+    double progress = static_cast<double>(now - readmitted) / window;
+    return std::max(kMinimumWeight, progress);
+}
+
+/**
+ * @brief Power-of-two-choices over the endpoints that are not ejected or failing health checks
+ *
+ * Cost is (outstanding + 1) * EWMA latency, divided by the slow-start weight.
+ */
+NetworkLoadBalancer::Endpoint* NetworkLoadBalancer::Select(Service& service, int64_t now) {
+    thread_local std::vector<Endpoint*> candidates;
+    candidates.clear();
+    for (auto& endpoint : service.endpoints) {
+        if (IsAvailable(*endpoint, now)) {
+            candidates.push_back(endpoint.get());
+        }
+    }
+    if (candidates.empty()) {
+        // Panic mode: no endpoint is available, so spread load over all of them
+        for (auto& endpoint : service.endpoints) {
+            candidates.push_back(endpoint.get());
+        }
+    }
+    if (candidates.size() == 1) {
+        return candidates[0];
+    }
+
+    size_t first = NextRandom() % candidates.size();
+    size_t second = NextRandom() % (candidates.size() - 1);
+    if (second >= first) {
+        second++;
+    }
+
+    auto cost = [&](Endpoint* endpoint) {
+        double latency = endpoint->ewmaNanos.load(std::memory_order_relaxed);
+        if (latency <= 0.0) {
+            latency = kDefaultLatencyNanos;
+        }
+        int outstanding = endpoint->outstanding.load(std::memory_order_relaxed);
+        return (outstanding + 1) * latency / Weight(service, *endpoint, now);
+    };
+    return (cost(candidates[first]) <= cost(candidates[second])) ? candidates[first] : candidates[second];
+}
+
+/**
+ * @brief Updates latency and failure tracking, ejecting the endpoint if it keeps failing
+ */
+void NetworkLoadBalancer::RecordOutcome(
+    Service& service,
+    Endpoint& endpoint,
+    const Network::NetworkResponse& response,
+    std::chrono::nanoseconds latency
+) {
+    auto nowTime = std::chrono::steady_clock::now();
+    int64_t now = SteadyNanos(nowTime);
+    const ServiceConfig& config = service.config;
+    endpoint.requests.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        // Time-decayed EWMA: older samples fade with time, not with request count
+        std::lock_guard<std::mutex> lock(endpoint.ewmaMutex);
+        double previous = endpoint.ewmaNanos.load(std::memory_order_relaxed);
+        double sample = static_cast<double>(latency.count());
+        if (previous <= 0.0) {
+            endpoint.ewmaNanos.store(sample, std::memory_order_relaxed);
+        }
+        else {
+            double elapsed = std::chrono::duration<double, std::milli>(nowTime - endpoint.ewmaUpdated).count();
+            double decay = std::exp(-elapsed / std::max(config.ewma_decay_ms, 1));
+            endpoint.ewmaNanos.store(previous * decay + sample * (1.0 - decay), std::memory_order_relaxed);
+        }
+        endpoint.ewmaUpdated = nowTime;
+    }
+
+    if (!IsEndpointFailure(response)) {
+        endpoint.consecutiveFailures.store(0, std::memory_order_relaxed);
+        endpoint.lastSuccess.store(now, std::memory_order_relaxed);
+        // Fully recovered once the slow-start window has passed without another ejection
+        int64_t readmitted = endpoint.ejectedUntil.load(std::memory_order_relaxed);
+        if (readmitted != 0 && now >= readmitted + static_cast<int64_t>(config.slow_start_ms) * 1000000) {
+            endpoint.ejections.store(0, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    endpoint.failures.fetch_add(1, std::memory_order_relaxed);
+    if (endpoint.consecutiveFailures.fetch_add(1, std::memory_order_relaxed) + 1 < config.consecutive_failures ||
+        endpoint.ejectedUntil.load(std::memory_order_relaxed) > now) {
+        return;
+    }
+
+    size_t ejected = 0;
+    for (const auto& other : service.endpoints) {
+        if (other->ejectedUntil.load(std::memory_order_relaxed) > now) {
+            ejected++;
+        }
+    }
+    if ((ejected + 1) * 100 > service.endpoints.size() * static_cast<size_t>(config.max_ejection_percent)) {
+        return;
+    }
+
+    int ejections = std::min(endpoint.ejections.fetch_add(1, std::memory_order_relaxed), 20);
+    int64_t duration = std::min<int64_t>(static_cast<int64_t>(config.base_ejection_ms) << ejections, config.max_ejection_ms);
+    endpoint.ejectedUntil.store(now + duration * 1000000, std::memory_order_relaxed);
+    endpoint.consecutiveFailures.store(0, std::memory_order_relaxed);
+}
+
+std::vector<NetworkLoadBalancer::EndpointStats> NetworkLoadBalancer::GetStats(const std::string& name) {
+    std::vector<EndpointStats> stats;
+    auto service = FindService(name);
+    if (!service) {
+        return stats;
+    }
+
+    int64_t now = SteadyNanos(std::chrono::steady_clock::now());
+    for (const auto& endpoint : service->endpoints) {
+        EndpointStats entry;
+        entry.url = endpoint->url;
+        entry.outstanding = endpoint->outstanding.load(std::memory_order_relaxed);
+        entry.ewma_latency = std::chrono::microseconds(static_cast<int64_t>(endpoint->ewmaNanos.load(std::memory_order_relaxed) / 1000));
+        entry.requests = endpoint->requests.load(std::memory_order_relaxed);
+        entry.failures = endpoint->failures.load(std::memory_order_relaxed);
+        entry.ejected = endpoint->ejectedUntil.load(std::memory_order_relaxed) > now;
+        entry.healthy = endpoint->healthy.load(std::memory_order_relaxed);
+        entry.weight = entry.ejected ? 0.0 : Weight(*service, *endpoint, now);
+        stats.push_back(entry);
+    }
+    return stats;
+}
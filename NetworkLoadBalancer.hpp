@@ -0,0 +1,236 @@
+/**
+ * @file NetworkLoadBalancer.hpp
+ * @brief Client-side load balancing across registered endpoint sets
+ *
+ * A logical service name maps to a list of endpoint base URLs. When the host of
+ * a request URL is a registered service, Network::Request sends it to one of
+ * the service's endpoints instead:
+ *
+ * @code
+ * NetworkLoadBalancer::RegisterService("users", { "http://10.0.0.1:8080", "http://10.0.0.2:8080" });
+ * auto response = Network::Get("http://users/v1/users/42");
+ * @endcode
+ *
+ * Endpoints are picked by power-of-two-choices: two random candidates are
+ * compared on outstanding requests times EWMA latency and the cheaper one
+ * wins. Endpoints that fail repeatedly are ejected for a growing period and
+ * then re-admitted with a weight that ramps up over a slow-start window.
+ * If every endpoint is ejected, selection falls back to all of them.
+ *
+ * Services using RoutingPolicy::Maglev instead map RequestConfig::routing_key
+ * through a Maglev lookup table, so the same key keeps reaching the same
+ * endpoint and membership changes remap only about 1/N of the keys. Ejected
+ * endpoints are skipped by walking the table; with hash_load_factor set, so
+ * are endpoints carrying more than that multiple of the mean load.
+ *
+ * With a health check configured, every endpoint is probed periodically on the
+ * shared NetworkTimer thread and endpoints failing their probes are taken out
+ * of selection until they pass again. A successful request within the probe
+ * interval stands in for the probe, so busy endpoints are rarely probed and
+ * HTTP probes ride on the session's pooled keep-alive connections.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_LOAD_BALANCER_HPP
+#define NETWORK_LOAD_BALANCER_HPP
+
+#include "Network.hpp"
+#include "NetworkTimer.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Registry of load-balanced services
+ */
+class NetworkLoadBalancer {
+public:
+    /**
+     * @brief How a service picks the endpoint of a request
+     */
+    enum class RoutingPolicy {
+        PowerOfTwoChoices,                                      ///< Least loaded of two random endpoints
+        Maglev                                                  ///< Consistent hash of RequestConfig::routing_key
+    };
+
+    /**
+     * @brief Active health probe of each endpoint
+     */
+    enum class HealthCheck {
+        None,                                                   ///< Passive outlier detection only
+        Http,                                                   ///< GET health_path; healthy on a 2xx response
+        Tcp                                                     ///< Healthy if a TCP connection can be established
+    };
+
+    /**
+     * @brief Routing, health checking, outlier detection and latency tracking settings of a service
+     */
+    struct ServiceConfig {
+        RoutingPolicy policy = RoutingPolicy::PowerOfTwoChoices; ///< Endpoint selection
+        double hash_load_factor = 0.0;                          ///< Maglev: skip endpoints above this multiple of the mean load (0 = never)
+        int consecutive_failures = 5;                           ///< Failures in a row that eject an endpoint
+        int base_ejection_ms = 30000;                           ///< First ejection; doubles with each repeat
+        int max_ejection_ms = 300000;                           ///< Longest ejection
+        int max_ejection_percent = 50;                          ///< Never eject more than this share of endpoints
+        int slow_start_ms = 30000;                              ///< Ramp-up window after re-admission
+        int ewma_decay_ms = 10000;                              ///< Time constant of the latency EWMA
+        HealthCheck health_check = HealthCheck::None;           ///< Active probing of endpoints
+        std::string health_path = "/health";                    ///< Path probed by HealthCheck::Http, appended to the endpoint URL
+        int health_interval_ms = 5000;                          ///< Time between probes of an endpoint
+        int health_timeout_ms = 2000;                           ///< Probe timeout (whole seconds for HTTP probes)
+        int unhealthy_threshold = 2;                            ///< Failed probes in a row that take an endpoint out
+        int healthy_threshold = 2;                              ///< Passed probes in a row that bring it back
+    };
+
+    /**
+     * @brief Snapshot of one endpoint's state
+     */
+    struct EndpointStats {
+        std::string url;                                        ///< Endpoint base URL
+        int outstanding = 0;                                    ///< Requests in flight
+        std::chrono::microseconds ewma_latency{0};              ///< Smoothed latency
+        uint64_t requests = 0;                                  ///< Completed requests
+        uint64_t failures = 0;                                  ///< Failed requests
+        bool ejected = false;                                   ///< Currently ejected
+        bool healthy = true;                                    ///< Passing health checks (always true without them)
+        double weight = 1.0;                                    ///< Slow-start weight in (0, 1]
+    };
+
+private:
+    struct Endpoint;
+    struct Service;
+
+public:
+    /**
+     * @brief A selected endpoint, held for the duration of one request
+     *
+     * Counts as outstanding until completed or destroyed.
+     */
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        explicit operator bool() const { return endpoint != nullptr; }
+
+        const std::string& Protocol() const;                    ///< Endpoint protocol (http/https)
+        const std::string& Host() const;                        ///< Endpoint host
+        int Port() const;                                       ///< Endpoint port
+        const std::string& BasePath() const;                    ///< Path prefix of the endpoint URL, without trailing '/'
+
+        /**
+         * @brief Report the outcome and release the endpoint
+         * @param response Completed response
+         */
+        void Complete(const Network::NetworkResponse& response);
+
+    private:
+        friend class NetworkLoadBalancer;
+        Lease(std::shared_ptr<Service> service, Endpoint* endpoint);
+        void Release();
+
+        std::shared_ptr<Service> service;
+        Endpoint* endpoint = nullptr;
+        std::chrono::steady_clock::time_point acquired;
+    };
+
+    /**
+     * @brief Register or replace a service
+     * @param name Host name requests use to address the service
+     * @param endpoints Endpoint base URLs, e.g. "https://10.0.0.1:8443" or "http://host/prefix"
+     * @param config Routing, health checking and outlier detection settings
+     * @return false if the list is empty, too long for a Maglev table or an endpoint URL is invalid
+     */
+    static bool RegisterService(
+        const std::string& name,
+        const std::vector<std::string>& endpoints,
+        const ServiceConfig& config = ServiceConfig()
+    );
+
+    /**
+     * @brief Remove a service and stop its health probes; requests in flight finish normally
+     * @param name Service name
+     */
+    static void UnregisterService(const std::string& name);
+
+    /**
+     * @brief Whether any service is registered
+     */
+    static bool HasServices() { return serviceCount.load(std::memory_order_relaxed) > 0; }
+
+    /**
+     * @brief Pick an endpoint for a request (called by Network::Request)
+     * @param name Host of the request URL
+     * @param routingKey Consistent-hash key; empty keys fall back to power-of-two-choices
+     * @return Lease on the chosen endpoint, empty if name is not a service
+     */
+    static Lease Acquire(const std::string& name, const std::string& routingKey = std::string());
+
+    /**
+     * @brief State of each endpoint of a service
+     * @param name Service name
+     */
+    static std::vector<EndpointStats> GetStats(const std::string& name);
+
+private:
+    struct Endpoint {
+        std::string url;
+        std::string protocol;
+        std::string host;
+        std::string basePath;
+        int port = 0;
+
+        std::atomic<int> outstanding{0};
+        std::atomic<double> ewmaNanos{0.0};
+        std::atomic<int> consecutiveFailures{0};
+        std::atomic<int> ejections{0};                          // Ejections since last full recovery
+        std::atomic<int64_t> ejectedUntil{0};                   // Steady-clock nanoseconds
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> failures{0};
+        std::atomic<bool> healthy{true};                        // Last health check verdict
+        std::atomic<int64_t> lastSuccess{0};                    // Steady-clock nanoseconds of the last successful request
+        int probeFailures = 0;                                  // Probe streaks, timer thread only
+        int probePasses = 0;
+
+        std::mutex ewmaMutex;                                   // Serializes EWMA updates
+        std::chrono::steady_clock::time_point ewmaUpdated;
+    };
+
+    struct Service {
+        ServiceConfig config;
+        std::vector<std::unique_ptr<Endpoint>> endpoints;
+        std::vector<uint16_t> maglevTable;                      // Slot -> endpoint index; empty unless policy is Maglev
+        std::atomic<int> outstanding{0};                        // Requests in flight across all endpoints
+        std::vector<NetworkTimer::TaskId> probeTasks;           // One periodic probe per endpoint
+    };
+
+    using ServiceMap = std::map<std::string, std::shared_ptr<Service>>;
+
+    static std::shared_ptr<Service> FindService(const std::string& name);
+    static Endpoint* Select(Service& service, int64_t now);
+    static Endpoint* SelectByKey(Service& service, const std::string& routingKey, int64_t now);
+    static void BuildMaglevTable(Service& service);
+    static bool IsAvailable(const Endpoint& endpoint, int64_t now);
+    static void StartProbes(const std::shared_ptr<Service>& service);
+    static void StopProbes(const std::shared_ptr<Service>& service);
+    static void Probe(const std::weak_ptr<Service>& weakService, size_t index);
+    static double Weight(const Service& service, const Endpoint& endpoint, int64_t now);
+    static void RecordOutcome(Service& service, Endpoint& endpoint, const Network::NetworkResponse& response, std::chrono::nanoseconds latency);
+
+    static std::shared_ptr<const ServiceMap> services;          ///< Copy-on-write; accessed with std::atomic_load/store
+    static std::atomic<size_t> serviceCount;
+    static std::mutex registryMutex;                            ///< Serializes registry updates
+};
+
+#endif // NETWORK_LOAD_BALANCER_HPP
@@ -0,0 +1,463 @@
+/**
+ * @file NetworkMetrics.cpp
+ * @brief Implementation of the NetworkMetrics and LatencyHistogram classes
+ *
+ * Each recording thread claims a ThreadShard on first use and is its only writer,
+ * so counters are bumped with relaxed load/store pairs instead of locked RMWs.
+ * Shards outlive their threads and are handed to the next new thread, which keeps
+ * memory bounded with RequestAsync's thread-per-request model. The shard list
+ * mutex is only taken when a thread claims a shard and when a scrape walks them.
+ */
+
+#include "NetworkMetrics.hpp"
+#include "NetworkBudget.hpp"
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Initialize static members
+std::atomic<bool> NetworkMetrics::enabled{false};
+std::atomic<int64_t> NetworkMetrics::inFlightRequests{0};
+std::atomic<int64_t> NetworkMetrics::openConnections{0};
+
+namespace {
+
+const size_t kMaxSeries = 256;                                  // Host/method pairs tracked individually (power of two)
+const size_t kOverflowSeries = kMaxSeries;                      // Slot shared by series beyond kMaxSeries
+
+// Error classes exported in network_request_errors_total; HTTP errors split by status family
+const char* const kErrorClassNames[] = {
+    "invalid_url", "rate_limited", "dns", "connect", "tls", "timeout", "connection", "other",
+    "http_4xx", "http_5xx", "http_other", "resource_limit"
+};
+const size_t kErrorClassCount = sizeof(kErrorClassNames) / sizeof(kErrorClassNames[0]);
+
+struct SeriesKey {
+    std::string host;
+    Network::Method method;
+};
+
+// Insert-only open-addressing table of series keys; keys are never freed
+std::atomic<SeriesKey*> seriesKeys[kMaxSeries];
+SeriesKey overflowKey{ "_other", Network::Method::HTTP_GET };
+
+struct SeriesShard {
+    std::atomic<uint64_t> buckets[LatencyHistogram::kBucketCount] = {};
+    std::atomic<uint64_t> sumMicros{0};
+    std::atomic<uint64_t> maxMicros{0};
+};
+
+struct ThreadShard {
+    std::atomic<SeriesShard*> series[kMaxSeries + 1] = {};
+    std::atomic<uint64_t> errors[kErrorClassCount] = {};
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<uint64_t> bytesReceived{0};
+    std::atomic<bool> inUse{false};
+
+    ~ThreadShard() {
+        for (auto& entry : series) {
+            delete entry.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+std::mutex shardsMutex;
+std::vector<std::unique_ptr<ThreadShard>> shards;
+
+// Releases the thread's shard for reuse when the thread exits
+struct ShardOwner {
+    ThreadShard* shard = nullptr;
+    ~ShardOwner() {
+        if (shard) {
+            shard->inUse.store(false, std::memory_order_release);
+        }
+    }
+};
+thread_local ShardOwner shardOwner;
+
+// Single-writer increment; readers only ever see whole values
+inline void Bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+ThreadShard& LocalShard() {
+    if (!shardOwner.shard) {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        for (auto& shard : shards) {
+            if (!shard->inUse.load(std::memory_order_acquire)) {
+                shardOwner.shard = shard.get();
+                break;
+            }
+        }
+        if (!shardOwner.shard) {
+            shards.push_back(std::make_unique<ThreadShard>());
+            shardOwner.shard = shards.back().get();
+        }
+        shardOwner.shard->inUse.store(true, std::memory_order_relaxed);
+    }
+    return *shardOwner.shard;
+}
+
+size_t SeriesHash(const std::string& host, Network::Method method) {
+    return std::hash<std::string>()(host) ^ (static_cast<size_t>(method) * 0x9e3779b9u);
+}
+
+// Finds or inserts the series slot for a host and method without locking
+size_t FindSeries(const std::string& host, Network::Method method, bool insert) {
+    size_t hash = SeriesHash(host, method);
+    for (size_t probe = 0; probe < kMaxSeries; probe++) {
+        size_t slot = (hash + probe) & (kMaxSeries - 1);
+        SeriesKey* key = seriesKeys[slot].load(std::memory_order_acquire);
+        if (!key) {
+            if (!insert) {
+                return kOverflowSeries + 1;
+            }
+            auto* candidate = new SeriesKey{ host, method };
+            if (seriesKeys[slot].compare_exchange_strong(key, candidate, std::memory_order_acq_rel)) {
+                return slot;
+            }
+            delete candidate;  // Lost the race; key now holds the winner
+        }
+        if (key->method == method && key->host == host) {
+            return slot;
+        }
+    }
+    return insert ? kOverflowSeries : kOverflowSeries + 1;
+}
+
+size_t ErrorClassIndex(const Network::NetworkResponse& response) {
+    switch (response.error_type) {
+        case Network::ErrorType::InvalidUrl:  return 0;
+        case Network::ErrorType::RateLimited: return 1;
+        case Network::ErrorType::Dns:         return 2;
+        case Network::ErrorType::Connect:     return 3;
+        case Network::ErrorType::Tls:         return 4;
+        case Network::ErrorType::Timeout:     return 5;
+        case Network::ErrorType::Connection:  return 6;
+        case Network::ErrorType::ResourceLimit: return 11;
+        case Network::ErrorType::Http:
+            if (response.status_code >= 400 && response.status_code < 500) return 8;
+            if (response.status_code >= 500 && response.status_code < 600) return 9;
+            return 10;
+        default:                              return 7;
+    }
+}
+
+// Merges one series across all shards; caller holds shardsMutex
+LatencyHistogram MergeSeries(size_t slot) {
+    LatencyHistogram merged;
+    for (auto& shard : shards) {
+        SeriesShard* series = shard->series[slot].load(std::memory_order_acquire);
+        if (!series) {
+            continue;
+        }
+        std::array<uint64_t, LatencyHistogram::kBucketCount> counts;
+        for (size_t i = 0; i < LatencyHistogram::kBucketCount; i++) {
+            counts[i] = series->buckets[i].load(std::memory_order_relaxed);
+        }
+        merged.AddBuckets(
+            counts,
+            series->sumMicros.load(std::memory_order_relaxed),
+            series->maxMicros.load(std::memory_order_relaxed));
+    }
+    return merged;
+}
+
+void AppendEscaped(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default:   out += c; break;
+        }
+    }
+}
+
+void AppendSeriesLabels(std::string& out, const SeriesKey& key) {
+    out += "host=\"";
+    AppendEscaped(out, key.host);
+    out += "\",method=\"";
+    out += (&key == &overflowKey) ? "_other" : Network::MethodName(key.method);
+    out += "\"";
+}
+
+void AppendNumber(std::string& out, const char* format, double value) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), format, value);
+    out += buffer;
+}
+
+} // namespace
+
+void LatencyHistogram::Record(uint64_t micros) {
+    buckets[BucketIndex(micros)]++;
+    count++;
+    sum += micros;
+    max = std::max(max, micros);
+}
+
+void LatencyHistogram::AddBuckets(
+    const std::array<uint64_t, kBucketCount>& bucketCounts,
+    uint64_t sumMicros,
+    uint64_t maxMicros
+) {
+    for (size_t i = 0; i < kBucketCount; i++) {
+        buckets[i] += bucketCounts[i];
+        count += bucketCounts[i];
+    }
+    sum += sumMicros;
+    max = std::max(max, maxMicros);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < kBucketCount; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+}
+
+uint64_t LatencyHistogram::Percentile(double quantile) const {
+    if (count == 0) {
+        return 0;
+    }
+    quantile = std::min(std::max(quantile, 0.0), 1.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * static_cast<double>(count) + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(BucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+uint64_t LatencyHistogram::CountAtOrBelow(uint64_t micros) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount && BucketUpperBound(i) <= micros; i++) {
+        total += buckets[i];
+    }
+    return total;
+}
+
+size_t LatencyHistogram::BucketIndex(uint64_t micros) {
+    const uint64_t linearLimit = static_cast<uint64_t>(kSubBucketCount) << 1;
+    if (micros < linearLimit) {
+        return static_cast<size_t>(micros);  // Exact below 2 * kSubBucketCount
+    }
+
+    const uint64_t maxValue = (static_cast<uint64_t>(1) << (kMaxExponent + 1)) - 1;
+    micros = std::min(micros, maxValue);
+
+#ifdef _MSC_VER
+    unsigned long exponent = 0;
+    _BitScanReverse64(&exponent, micros);
+    int shift = static_cast<int>(exponent) - kSubBucketBits;
+#else
+    int exponent = 63 - __builtin_clzll(micros);
+    int shift = exponent - kSubBucketBits;
+#endif
+    size_t subBucket = static_cast<size_t>(micros >> shift) - kSubBucketCount;
+    return static_cast<size_t>(shift + 1) * kSubBucketCount + subBucket;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t bucket) {
+    if (bucket < static_cast<size_t>(kSubBucketCount) * 2) {
+        return bucket;
+    }
+    int shift = static_cast<int>(bucket / kSubBucketCount) - 1;
+    uint64_t lower = static_cast<uint64_t>(kSubBucketCount + bucket % kSubBucketCount) << shift;
+    return lower + (static_cast<uint64_t>(1) << shift) - 1;
+}
+
+/**
+ * @brief Enables or disables metric recording
+ *
+ * @param enable Whether Network::Request should record metrics
+ */
+void NetworkMetrics::SetEnabled(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Records a completed request into the calling thread's shard
+ *
+ * @param host Target host (empty if the URL was invalid)
+ * @param method HTTP method
+ * @param response Completed response, including timings
+ * @param bytesSent Request body size
+ */
+void NetworkMetrics::RecordRequest(
+    const std::string& host,
+    Network::Method method,
+    const Network::NetworkResponse& response,
+    uint64_t bytesSent
+) {
+    const auto& timings = response.timings;
+    auto end = timings.last_byte != std::chrono::steady_clock::time_point()
+        ? timings.last_byte
+        : std::chrono::steady_clock::now();
+    uint64_t micros = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(end - timings.start).count());
+
+    ThreadShard& shard = LocalShard();
+
+    size_t slot = FindSeries(host, method, true);
+    SeriesShard* series = shard.series[slot].load(std::memory_order_relaxed);
+    if (!series) {
+        series = new SeriesShard();
+        shard.series[slot].store(series, std::memory_order_release);
+    }
+    Bump(series->buckets[LatencyHistogram::BucketIndex(micros)], 1);
+    Bump(series->sumMicros, micros);
+    if (micros > series->maxMicros.load(std::memory_order_relaxed)) {
+        series->maxMicros.store(micros, std::memory_order_relaxed);
+    }
+
+    if (!response.success) {
+        Bump(shard.errors[ErrorClassIndex(response)], 1);
+    }
+    Bump(shard.bytesSent, bytesSent);
+    Bump(shard.bytesReceived, response.body.size());
+}
+
+void NetworkMetrics::ConnectionOpened() {
+    if (IsEnabled()) {
+        openConnections.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void NetworkMetrics::ConnectionClosed() {
+    if (IsEnabled() && openConnections.load(std::memory_order_relaxed) > 0) {
+        openConnections.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Merges all shards and appends a Prometheus text exposition
+ *
+ * Histogram buckets are exported at power-of-two microsecond bounds from 128us
+ * to about 67s; the full resolution is available through GetLatencyHistogram().
+ *
+ * @param out Buffer the exposition is appended to
+ */
+void NetworkMetrics::RenderPrometheus(std::string& out) {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+
+    // Collect live series once; the overflow slot is appended last
+    std::vector<std::pair<const SeriesKey*, LatencyHistogram>> series;
+    for (size_t slot = 0; slot <= kOverflowSeries; slot++) {
+        const SeriesKey* key = slot == kOverflowSeries
+            ? &overflowKey
+            : seriesKeys[slot].load(std::memory_order_acquire);
+        if (!key) {
+            continue;
+        }
+        LatencyHistogram merged = MergeSeries(slot);
+        if (merged.Count() > 0) {
+            series.emplace_back(key, merged);
+        }
+    }
+
+    out += "# HELP network_requests_total Requests completed by Network::Request.\n";
+    out += "# TYPE network_requests_total counter\n";
+    for (const auto& [key, histogram] : series) {
+        out += "network_requests_total{";
+        AppendSeriesLabels(out, *key);
+        out += "} " + std::to_string(histogram.Count()) + "\n";
+    }
+
+    uint64_t errors[kErrorClassCount] = {};
+    uint64_t bytesSent = 0;
+    uint64_t bytesReceived = 0;
+    for (auto& shard : shards) {
+        for (size_t i = 0; i < kErrorClassCount; i++) {
+            errors[i] += shard->errors[i].load(std::memory_order_relaxed);
+        }
+        bytesSent += shard->bytesSent.load(std::memory_order_relaxed);
+        bytesReceived += shard->bytesReceived.load(std::memory_order_relaxed);
+    }
+
+    out += "# HELP network_request_errors_total Failed requests by error class.\n";
+    out += "# TYPE network_request_errors_total counter\n";
+    for (size_t i = 0; i < kErrorClassCount; i++) {
+        out += "network_request_errors_total{class=\"";
+        out += kErrorClassNames[i];
+        out += "\"} " + std::to_string(errors[i]) + "\n";
+    }
+
+    out += "# HELP network_bytes_sent_total Request body bytes sent.\n";
+    out += "# TYPE network_bytes_sent_total counter\n";
+    out += "network_bytes_sent_total " + std::to_string(bytesSent) + "\n";
+    out += "# HELP network_bytes_received_total Response body bytes received.\n";
+    out += "# TYPE network_bytes_received_total counter\n";
+    out += "network_bytes_received_total " + std::to_string(bytesReceived) + "\n";
+
+    out += "# HELP network_requests_in_flight Requests currently being processed.\n";
+    out += "# TYPE network_requests_in_flight gauge\n";
+    out += "network_requests_in_flight " + std::to_string(inFlightRequests.load(std::memory_order_relaxed)) + "\n";
+    out += "# HELP network_connections_open Pooled connections reported open by WinHTTP.\n";
+    out += "# TYPE network_connections_open gauge\n";
+    out += "network_connections_open " + std::to_string(openConnections.load(std::memory_order_relaxed)) + "\n";
+    out += "# HELP network_memory_budget_bytes In-flight memory budget (0 = unlimited).\n";
+    out += "# TYPE network_memory_budget_bytes gauge\n";
+    out += "network_memory_budget_bytes " + std::to_string(NetworkBudget::GetLimit()) + "\n";
+    out += "# HELP network_memory_in_use_bytes Request and response bytes reserved by in-flight requests.\n";
+    out += "# TYPE network_memory_in_use_bytes gauge\n";
+    out += "network_memory_in_use_bytes " + std::to_string(NetworkBudget::InUse()) + "\n";
+    out += "# HELP network_memory_rejections_total Requests refused or aborted for lack of memory budget.\n";
+    out += "# TYPE network_memory_rejections_total counter\n";
+    out += "network_memory_rejections_total " + std::to_string(NetworkBudget::Rejected()) + "\n";
+
+    out += "# HELP network_request_duration_seconds Request latency from Request() entry to last byte.\n";
+    out += "# TYPE network_request_duration_seconds histogram\n";
+    for (const auto& [key, histogram] : series) {
+        for (int exponent = 7; exponent <= 26; exponent++) {
+            uint64_t bound = static_cast<uint64_t>(1) << exponent;
+            out += "network_request_duration_seconds_bucket{";
+            AppendSeriesLabels(out, *key);
+            out += ",le=\"";
+            AppendNumber(out, "%g", static_cast<double>(bound) / 1e6);
+            out += "\"} " + std::to_string(histogram.CountAtOrBelow(bound - 1)) + "\n";
+        }
+        out += "network_request_duration_seconds_bucket{";
+        AppendSeriesLabels(out, *key);
+        out += ",le=\"+Inf\"} " + std::to_string(histogram.Count()) + "\n";
+
+        out += "network_request_duration_seconds_sum{";
+        AppendSeriesLabels(out, *key);
+        out += "} ";
+        AppendNumber(out, "%.6f", static_cast<double>(histogram.SumMicros()) / 1e6);
+        out += "\n";
+
+        out += "network_request_duration_seconds_count{";
+        AppendSeriesLabels(out, *key);
+        out += "} " + std::to_string(histogram.Count()) + "\n";
+    }
+}
+
+/**
+ * @brief Returns the merged latency histogram of one series
+ *
+ * @param host Target host
+ * @param method HTTP method
+ * @return Histogram of request latencies, empty if the series is unknown
+ */
+LatencyHistogram NetworkMetrics::GetLatencyHistogram(const std::string& host, Network::Method method) {
+    size_t slot = FindSeries(host, method, false);
+    if (slot > kOverflowSeries) {
+        return LatencyHistogram();
+    }
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    return MergeSeries(slot);
+}
@@ -0,0 +1,176 @@
+/**
+ * @file NetworkMetrics.hpp
+ * @brief Request metrics and Prometheus text export for the Network library
+ *
+ * Network::Request reports every completed request here when metrics are enabled.
+ * Recording never takes a lock: each thread owns a shard of counters and
+ * log-linear (HDR-style) latency histograms that only it writes, and a scrape
+ * merges all shards into a Prometheus text exposition.
+ *
+ * Exported series:
+ * - network_requests_total{host,method}
+ * - network_request_errors_total{class}
+ * - network_request_duration_seconds{host,method} (histogram)
+ * - network_bytes_sent_total / network_bytes_received_total
+ * - network_requests_in_flight / network_connections_open
+ * - network_memory_budget_bytes / network_memory_in_use_bytes / network_memory_rejections_total
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_METRICS_HPP
+#define NETWORK_METRICS_HPP
+
+#include "Network.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Log-linear latency histogram with microsecond resolution
+ *
+ * Values are bucketed by their power of two and then into 8 linear sub-buckets,
+ * giving a worst-case relative error of 12.5% from 1us up to about 12 days.
+ * Not thread-safe; used for merged snapshots and by the benchmark tools.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 3;                    ///< log2 of sub-buckets per power of two
+    static constexpr int kSubBucketCount = 1 << kSubBucketBits; ///< Linear sub-buckets per power of two
+    static constexpr int kMaxExponent = 40;                     ///< Largest tracked power of two (microseconds)
+    static constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBucketCount;
+
+    /**
+     * @brief Record one value
+     * @param micros Value in microseconds
+     */
+    void Record(uint64_t micros);
+
+    /**
+     * @brief Add values that were already bucketed elsewhere
+     * @param bucketCounts Number of values per bucket index
+     * @param sumMicros Sum of the values
+     * @param maxMicros Largest value
+     */
+    void AddBuckets(const std::array<uint64_t, kBucketCount>& bucketCounts, uint64_t sumMicros, uint64_t maxMicros);
+
+    /**
+     * @brief Add all values of another histogram
+     * @param other Histogram to merge
+     */
+    void Merge(const LatencyHistogram& other);
+
+    /**
+     * @brief Value at the given quantile
+     * @param quantile Quantile in [0, 1]
+     * @return Upper bound of the bucket holding the quantile, in microseconds
+     */
+    uint64_t Percentile(double quantile) const;
+
+    /**
+     * @brief Number of values less than or equal to a bound
+     *
+     * Counts whole buckets whose upper bound does not exceed the bound, so the
+     * result is exact for bounds of the form 2^k - 1 and conservative otherwise.
+     *
+     * @param micros Bound in microseconds
+     */
+    uint64_t CountAtOrBelow(uint64_t micros) const;
+
+    uint64_t Count() const { return count; }                    ///< Number of recorded values
+    uint64_t SumMicros() const { return sum; }                  ///< Sum of recorded values
+    uint64_t MaxMicros() const { return max; }                  ///< Largest recorded value
+
+    /**
+     * @brief Bucket index for a value
+     * @param micros Value in microseconds
+     */
+    static size_t BucketIndex(uint64_t micros);
+
+    /**
+     * @brief Largest value that falls into a bucket
+     * @param bucket Bucket index
+     */
+    static uint64_t BucketUpperBound(size_t bucket);
+
+private:
+    std::array<uint64_t, kBucketCount> buckets{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+};
+
+/**
+ * @brief Library-wide request metrics
+ */
+class NetworkMetrics {
+public:
+    /**
+     * @brief Enable or disable recording (disabled by default)
+     * @param enable Whether Network::Request should record metrics
+     */
+    static void SetEnabled(bool enable);
+
+    /**
+     * @brief Whether recording is enabled
+     */
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Record a completed request
+     * @param host Target host (empty if the URL was invalid)
+     * @param method HTTP method
+     * @param response Completed response, including timings
+     * @param bytesSent Request body size
+     */
+    static void RecordRequest(
+        const std::string& host,
+        Network::Method method,
+        const Network::NetworkResponse& response,
+        uint64_t bytesSent
+    );
+
+    static void ConnectionOpened();                             ///< A pooled connection was established
+    static void ConnectionClosed();                             ///< A pooled connection was closed
+
+    /**
+     * @brief Render all metrics in Prometheus text format
+     * @param out Buffer the exposition is appended to
+     */
+    static void RenderPrometheus(std::string& out);
+
+    /**
+     * @brief Merged latency histogram for one host and method
+     * @param host Target host
+     * @param method HTTP method
+     * @return Histogram of request latencies, empty if the series is unknown
+     */
+    static LatencyHistogram GetLatencyHistogram(const std::string& host, Network::Method method);
+
+    /**
+     * @brief RAII guard maintaining the in-flight request gauge
+     */
+    class InFlight {
+    public:
+        InFlight() : counted(IsEnabled()) {
+            if (counted) inFlightRequests.fetch_add(1, std::memory_order_relaxed);
+        }
+        ~InFlight() {
+            if (counted) inFlightRequests.fetch_sub(1, std::memory_order_relaxed);
+        }
+        InFlight(const InFlight&) = delete;
+        InFlight& operator=(const InFlight&) = delete;
+
+    private:
+        bool counted;
+    };
+
+private:
+    static std::atomic<bool> enabled;                           ///< Whether recording is enabled
+    static std::atomic<int64_t> inFlightRequests;               ///< Requests currently inside Request()
+    static std::atomic<int64_t> openConnections;                ///< Connections reported open by WinHTTP
+};
+
+#endif // NETWORK_METRICS_HPP
@@ -0,0 +1,224 @@
+/**
+ * @file NetworkMultipart.cpp
+ * @brief Implementation of the streaming multipart/form-data encoder
+ */
+
+#include "NetworkMultipart.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+NetworkMultipart::NetworkMultipart() {
+    static const char hexDigits[] = "0123456789abcdef";
+    std::random_device device;
+    std::mt19937_64 random((static_cast<uint64_t>(device()) << 32) ^ device());
+    uint64_t value = random();
+
+    std::string generated = "NetworkFormBoundary";
+    for (int i = 0; i < 16; i++) {
+        generated += hexDigits[(value >> (i * 4)) & 0xF];
+    }
+    boundary = generated;
+    closing = "--" + boundary + "--\r\n";
+}
+
+NetworkMultipart::NetworkMultipart(std::string fixedBoundary) : boundary(std::move(fixedBoundary)) {
+    closing = "--" + boundary + "--\r\n";
+}
+
+/**
+ * @brief Escapes a Content-Disposition parameter the way browsers do
+ *
+ * Quotes and line breaks are percent-encoded so that a name or file name
+ * cannot terminate the parameter or inject headers.
+ */
+std::string NetworkMultipart::QuoteParameter(const std::string& value) {
+    std::string quoted = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"':  quoted += "%22"; break;
+            case '\r': quoted += "%0D"; break;
+            case '\n': quoted += "%0A"; break;
+            default:   quoted += c; break;
+        }
+    }
+    quoted += '"';
+    return quoted;
+}
+
+void NetworkMultipart::AddPart(Part part, const std::string& name, const std::string& filename, const std::string& contentType) {
+    part.head = "--" + boundary + "\r\nContent-Disposition: form-data; name=" + QuoteParameter(name);
+    if (!filename.empty()) {
+        part.head += "; filename=" + QuoteParameter(filename);
+    }
+    part.head += "\r\n";
+    if (!contentType.empty()) {
+        part.head += "Content-Type: " + contentType + "\r\n";
+    }
+    part.head += "\r\n";
+    parts.push_back(std::move(part));
+}
+
+void NetworkMultipart::AddField(const std::string& name, std::string value) {
+    Part part;
+    part.kind = PartKind::Text;
+    part.size = value.size();
+    part.text = std::move(value);
+    AddPart(std::move(part), name, std::string(), std::string());
+}
+
+bool NetworkMultipart::AddFile(
+    const std::string& name,
+    const std::string& path,
+    const std::string& contentType,
+    const std::string& filename
+) {
+    std::error_code error;
+    uintmax_t fileSize = std::filesystem::file_size(path, error);
+    if (error) {
+        return false;
+    }
+
+    Part part;
+    part.kind = PartKind::File;
+    part.path = path;
+    part.size = static_cast<uint64_t>(fileSize);
+    std::string reportedName = filename;
+    if (reportedName.empty()) {
+        size_t separator = path.find_last_of("/\\");
+        reportedName = (separator == std::string::npos) ? path : path.substr(separator + 1);
+    }
+    AddPart(std::move(part), name, reportedName, contentType);
+    return true;
+}
+
+void NetworkMultipart::AddStream(
+    const std::string& name,
+    const std::string& filename,
+    const std::string& contentType,
+    Generator generator,
+    std::optional<uint64_t> size
+) {
+    Part part;
+    part.kind = PartKind::Stream;
+    part.generator = std::move(generator);
+    part.size = size;
+    AddPart(std::move(part), name, filename, contentType);
+}
+
+std::optional<uint64_t> NetworkMultipart::Size() const {
+    uint64_t total = closing.size();
+    for (const auto& part : parts) {
+        if (!part.size) {
+            return std::nullopt;
+        }
+        total += part.head.size() + *part.size + 2;  // Contents are followed by CRLF
+    }
+    return total;
+}
+
+/**
+ * @brief Reads the next contents of a part, opening its file on first use
+ */
+bool NetworkMultipart::ReadContent(Part& part, char* buffer, size_t capacity, size_t& bytesRead) {
+    bytesRead = 0;
+    switch (part.kind) {
+        case PartKind::Text:
+            bytesRead = std::min(capacity, part.text.size() - offset);
+            std::memcpy(buffer, part.text.data() + offset, bytesRead);
+            offset += bytesRead;
+            return true;
+
+        case PartKind::File:
+            if (!file.is_open()) {
+                file.open(part.path, std::ios::binary);
+                if (!file) {
+                    return false;
+                }
+            }
+            file.read(buffer, static_cast<std::streamsize>(capacity));
+            bytesRead = static_cast<size_t>(file.gcount());
+            return !file.bad();
+
+        case PartKind::Stream:
+            return part.generator(buffer, capacity, bytesRead) && bytesRead <= capacity;
+    }
+    return false;
+}
+
+/**
+ * @brief Fills the buffer with the next bytes of the encoded form
+ *
+ * Walks each part through its head, contents and trailing CRLF, then emits
+ * the closing boundary. A part whose contents end up longer or shorter than
+ * its declared size fails the read, since Content-Length has already been sent.
+ */
+bool NetworkMultipart::Read(char* buffer, size_t capacity, size_t& bytesRead) {
+    bytesRead = 0;
+
+    // Copies the rest of a fixed string; true once it has been copied completely
+    auto copy = [&](const std::string& source) {
+        size_t length = std::min(capacity - bytesRead, source.size() - offset);
+        std::memcpy(buffer + bytesRead, source.data() + offset, length);
+        bytesRead += length;
+        offset += length;
+        return offset == source.size();
+    };
+
+    while (bytesRead < capacity && stage != Stage::Done) {
+        if (partIndex == parts.size()) {
+            if (copy(closing)) {
+                stage = Stage::Done;
+            }
+            continue;
+        }
+
+        Part& part = parts[partIndex];
+        switch (stage) {
+            case Stage::Head:
+                if (copy(part.head)) {
+                    stage = Stage::Content;
+                    offset = 0;
+                    contentRead = 0;
+                }
+                break;
+
+            case Stage::Content: {
+                size_t length = 0;
+                if (!ReadContent(part, buffer + bytesRead, capacity - bytesRead, length)) {
+                    return false;
+                }
+                contentRead += length;
+                bytesRead += length;
+                if (part.size && contentRead > *part.size) {
+                    return false;
+                }
+                if (length == 0) {
+                    if (part.size && contentRead != *part.size) {
+                        return false;
+                    }
+                    file.close();
+                    file.clear();
+                    stage = Stage::Tail;
+                    offset = 0;
+                }
+                break;
+            }
+
+            case Stage::Tail: {
+                static const std::string lineBreak = "\r\n";
+                if (copy(lineBreak)) {
+                    partIndex++;
+                    stage = Stage::Head;
+                    offset = 0;
+                }
+                break;
+            }
+
+            case Stage::Done:
+                break;
+        }
+    }
+    return true;
+}
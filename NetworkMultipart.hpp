@@ -0,0 +1,144 @@
+/**
+ * @file NetworkMultipart.hpp
+ * @brief Streaming multipart/form-data encoder
+ *
+ * A form is composed of parts whose contents stay where they are until the
+ * request is sent: strings, files on disk, or generator callbacks. The encoded
+ * body is produced chunk by chunk as Network streams it, so uploading a file
+ * of several hundred MB costs one upload chunk of memory, not a copy of the file.
+ *
+ * @code
+ * NetworkMultipart form;
+ * form.AddField("description", "nightly export");
+ * form.AddFile("file", "C:\\exports\\data.bin");
+ * auto response = Network::Post(url, form, form.ContentType());
+ * @endcode
+ *
+ * Content-Length is computed up front when every part has a known size;
+ * otherwise the form is sent with chunked transfer encoding. A form is read
+ * once; build a new one to repeat the upload.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_MULTIPART_HPP
+#define NETWORK_MULTIPART_HPP
+
+#include "Network.hpp"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief multipart/form-data request body built from streamed parts
+ */
+class NetworkMultipart : public Network::BodySource {
+public:
+    /**
+     * @brief Produces the contents of a generated part
+     *
+     * Called with a buffer to fill; sets bytesWritten to the bytes produced,
+     * or to 0 once the part is complete. Returning false aborts the request.
+     */
+    using Generator = std::function<bool(char* buffer, size_t capacity, size_t& bytesWritten)>;
+
+    /**
+     * @brief Create a form with a random boundary
+     */
+    NetworkMultipart();
+
+    /**
+     * @brief Create a form with a fixed boundary
+     * @param boundary Boundary string; must not occur in any part
+     */
+    explicit NetworkMultipart(std::string boundary);
+
+    NetworkMultipart(const NetworkMultipart&) = delete;
+    NetworkMultipart& operator=(const NetworkMultipart&) = delete;
+
+    /**
+     * @brief Add a text field
+     * @param name Field name
+     * @param value Field value
+     */
+    void AddField(const std::string& name, std::string value);
+
+    /**
+     * @brief Add a file, read from disk while the request is sent
+     * @param name Field name
+     * @param path File to upload
+     * @param contentType Content type of the file
+     * @param filename File name reported to the server (defaults to the last component of path)
+     * @return false if the file does not exist or its size cannot be read
+     */
+    bool AddFile(
+        const std::string& name,
+        const std::string& path,
+        const std::string& contentType = "application/octet-stream",
+        const std::string& filename = std::string()
+    );
+
+    /**
+     * @brief Add a part whose contents are produced by a callback while the request is sent
+     * @param name Field name
+     * @param filename File name reported to the server (empty for none)
+     * @param contentType Content type of the part
+     * @param generator Producer of the contents
+     * @param size Exact size of the contents, if known; without it the form is sent chunked
+     */
+    void AddStream(
+        const std::string& name,
+        const std::string& filename,
+        const std::string& contentType,
+        Generator generator,
+        std::optional<uint64_t> size = std::nullopt
+    );
+
+    /**
+     * @brief Content-Type header value for the request, including the boundary
+     */
+    std::string ContentType() const { return "multipart/form-data; boundary=" + boundary; }
+
+    /**
+     * @brief Boundary separating the parts
+     */
+    const std::string& Boundary() const { return boundary; }
+
+    std::optional<uint64_t> Size() const override;
+    bool Read(char* buffer, size_t capacity, size_t& bytesRead) override;
+
+private:
+    enum class PartKind { Text, File, Stream };
+
+    struct Part {
+        PartKind kind = PartKind::Text;
+        std::string head;                                       // Boundary line and part headers
+        std::string text;                                       // Contents of a text part
+        std::string path;                                       // File of a file part
+        Generator generator;                                    // Producer of a stream part
+        std::optional<uint64_t> size;                           // Content size, if known
+    };
+
+    enum class Stage { Head, Content, Tail, Done };
+
+    void AddPart(Part part, const std::string& name, const std::string& filename, const std::string& contentType);
+    bool ReadContent(Part& part, char* buffer, size_t capacity, size_t& bytesRead);
+    static std::string QuoteParameter(const std::string& value);
+
+    std::string boundary;
+    std::string closing;                                        // Final boundary line
+    std::vector<Part> parts;
+
+    // Read position
+    size_t partIndex = 0;
+    Stage stage = Stage::Head;
+    size_t offset = 0;                                          // Within the current head, text or closing line
+    uint64_t contentRead = 0;                                   // Content bytes of the current part
+    std::ifstream file;                                         // Open file of the current file part
+};
+
+#endif // NETWORK_MULTIPART_HPP
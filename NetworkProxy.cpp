@@ -0,0 +1,766 @@
+/**
+ * @file NetworkProxy.cpp
+ * @brief Implementation of proxy routing and the SOCKS5 relay
+ */
+
+// winsock2.h must precede windows.h
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <iphlpapi.h>
+
+#include "NetworkProxy.hpp"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <condition_variable>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+
+#pragma comment(lib, "ws2_32.lib")
+#pragma comment(lib, "iphlpapi.lib")
+
+// Initialize static members
+std::atomic<bool> NetworkProxy::enabled{false};
+NetworkProxy::Options NetworkProxy::options;
+std::vector<std::string> NetworkProxy::noProxy;
+std::shared_ptr<NetworkProxy::Relay> NetworkProxy::relay;
+std::mutex NetworkProxy::configMutex;
+std::atomic<uint64_t> NetworkProxy::proxied{0};
+std::atomic<uint64_t> NetworkProxy::direct{0};
+std::atomic<uint64_t> NetworkProxy::tunnelsOpened{0};
+std::atomic<uint64_t> NetworkProxy::tunnelsOpen{0};
+std::atomic<uint64_t> NetworkProxy::tunnelFailures{0};
+
+// Connecting to the proxy, the SOCKS5 handshake and a CONNECT request head must each finish within this
+static const int kHandshakeTimeoutMs = 30000;
+static const size_t kMaxConnectHead = 8 * 1024;
+static const size_t kRelayBufferSize = 64 * 1024;
+// https targets the relay will tunnel to; the oldest are forgotten beyond this
+static const size_t kMaxRoutedTargets = 4096;
+// http targets with a raw listener (a socket and a thread each); the least recently routed is closed beyond this
+static const size_t kMaxRawTargets = 256;
+static const char kRelayUsername[] = "network";
+
+static std::string Lowercase(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+/**
+ * @brief Host without IPv6 brackets, lowercased
+ */
+static std::string NormalizeHost(const std::string& host) {
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        return Lowercase(host.substr(1, host.size() - 2));
+    }
+    return Lowercase(host);
+}
+
+static std::string Base64Encode(const std::string& input) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string encoded;
+    encoded.reserve((input.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < input.size(); i += 3) {
+        uint32_t group = static_cast<unsigned char>(input[i]) << 16;
+        if (i + 1 < input.size()) group |= static_cast<unsigned char>(input[i + 1]) << 8;
+        if (i + 2 < input.size()) group |= static_cast<unsigned char>(input[i + 2]);
+        encoded += alphabet[(group >> 18) & 0x3F];
+        encoded += alphabet[(group >> 12) & 0x3F];
+        encoded += i + 1 < input.size() ? alphabet[(group >> 6) & 0x3F] : '=';
+        encoded += i + 2 < input.size() ? alphabet[group & 0x3F] : '=';
+    }
+    return encoded;
+}
+
+/**
+ * @brief Compare without returning early, so that timing does not reveal a secret
+ */
+static bool ConstantTimeEquals(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    unsigned char difference = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        difference |= static_cast<unsigned char>(a[i] ^ b[i]);
+    }
+    return difference == 0;
+}
+
+/**
+ * @brief Random 128-bit token, hex-encoded
+ */
+static std::string RandomToken() {
+    std::random_device random;
+    static const char digits[] = "0123456789abcdef";
+    std::string token;
+    for (int i = 0; i < 4; i++) {
+        uint32_t word = random();
+        for (int shift = 28; shift >= 0; shift -= 4) {
+            token += digits[(word >> shift) & 0xF];
+        }
+    }
+    return token;
+}
+
+/**
+ * @brief Whether the other end of an accepted loopback connection belongs to this process
+ *
+ * Looks the connection up in the TCP table from the client's side, where its
+ * local address is our peer and its remote address is us.
+ */
+static bool OwnedByThisProcess(SOCKET client) {
+    sockaddr_in peer = {};
+    sockaddr_in local = {};
+    int peerLength = sizeof(peer);
+    int localLength = sizeof(local);
+    if (getpeername(client, reinterpret_cast<sockaddr*>(&peer), &peerLength) != 0 ||
+        getsockname(client, reinterpret_cast<sockaddr*>(&local), &localLength) != 0 ||
+        peer.sin_family != AF_INET) {
+        return false;
+    }
+
+    std::vector<char> table;
+    ULONG size = 0;
+    DWORD result = GetExtendedTcpTable(nullptr, &size, FALSE, AF_INET, TCP_TABLE_OWNER_PID_CONNECTIONS, 0);
+    while (result == ERROR_INSUFFICIENT_BUFFER) {
+        table.resize(size);
+        result = GetExtendedTcpTable(table.data(), &size, FALSE, AF_INET, TCP_TABLE_OWNER_PID_CONNECTIONS, 0);
+    }
+    if (result != NO_ERROR || table.empty()) {
+        return false;
+    }
+
+    // Ports are in network byte order in the low 16 bits
+    const auto* rows = reinterpret_cast<const MIB_TCPTABLE_OWNER_PID*>(table.data());
+    for (DWORD i = 0; i < rows->dwNumEntries; i++) {
+        const MIB_TCPROW_OWNER_PID& row = rows->table[i];
+        if (row.dwLocalAddr == peer.sin_addr.s_addr && static_cast<u_short>(row.dwLocalPort) == peer.sin_port &&
+            row.dwRemoteAddr == local.sin_addr.s_addr && static_cast<u_short>(row.dwRemotePort) == local.sin_port) {
+            return row.dwOwningPid == GetCurrentProcessId();
+        }
+    }
+    return false;
+}
+
+static void SetReceiveTimeout(SOCKET socket, int timeoutMs) {
+    DWORD timeout = static_cast<DWORD>(timeoutMs);
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+
+static bool SendAll(SOCKET socket, const char* data, size_t size) {
+    while (size > 0) {
+        int sent = send(socket, data, static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+static bool ReceiveAll(SOCKET socket, char* data, size_t size) {
+    while (size > 0) {
+        int received = recv(socket, data, static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+        if (received <= 0) {
+            return false;
+        }
+        data += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+/**
+ * @brief Blocking TCP connect to the first reachable address of host:port
+ */
+static SOCKET Dial(const std::string& host, int port) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(NormalizeHost(host).c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+        return INVALID_SOCKET;
+    }
+
+    SOCKET connected = INVALID_SOCKET;
+    for (addrinfo* address = addresses; address && connected == INVALID_SOCKET; address = address->ai_next) {
+        SOCKET sock = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (sock == INVALID_SOCKET) {
+            continue;
+        }
+        if (connect(sock, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0) {
+            connected = sock;
+        }
+        else {
+            closesocket(sock);
+        }
+    }
+    freeaddrinfo(addresses);
+
+    if (connected != INVALID_SOCKET) {
+        BOOL noDelay = TRUE;
+        setsockopt(connected, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+    }
+    return connected;
+}
+
+/**
+ * @brief SOCKS5 CONNECT to a target over an open proxy connection
+ *
+ * Offers no authentication, plus username/password (RFC 1929) when
+ * credentials are set. The target is sent as a domain name so that the proxy
+ * resolves it, as egress proxies usually must.
+ */
+static bool Socks5Connect(SOCKET socket, const std::string& target, int port,
+                          const std::string& username, const std::string& password) {
+    std::string host = NormalizeHost(target);
+    if (host.empty() || host.size() > 255) {
+        return false;
+    }
+
+    std::string greeting = username.empty() ? std::string("\x05\x01\x00", 3) : std::string("\x05\x02\x00\x02", 4);
+    unsigned char choice[2];
+    if (!SendAll(socket, greeting.data(), greeting.size()) ||
+        !ReceiveAll(socket, reinterpret_cast<char*>(choice), sizeof(choice)) || choice[0] != 0x05) {
+        return false;
+    }
+    if (choice[1] == 0x02 && !username.empty()) {
+        std::string login;
+        login += '\x01';
+        login += static_cast<char>(username.size());
+        login += username;
+        login += static_cast<char>(password.size());
+        login += password;
+        unsigned char status[2];
+        if (!SendAll(socket, login.data(), login.size()) ||
+            !ReceiveAll(socket, reinterpret_cast<char*>(status), sizeof(status)) || status[1] != 0x00) {
+            return false;
+        }
+    }
+    else if (choice[1] != 0x00) {
+        return false;
+    }
+
+    std::string request("\x05\x01\x00\x03", 4);
+    request += static_cast<char>(host.size());
+    request += host;
+    request += static_cast<char>((port >> 8) & 0xFF);
+    request += static_cast<char>(port & 0xFF);
+    unsigned char reply[4];
+    if (!SendAll(socket, request.data(), request.size()) ||
+        !ReceiveAll(socket, reinterpret_cast<char*>(reply), sizeof(reply)) || reply[0] != 0x05 || reply[1] != 0x00) {
+        return false;
+    }
+
+    // Skip the bound address, whose length depends on its type
+    size_t boundLength = 0;
+    switch (reply[3]) {
+        case 0x01: boundLength = 4 + 2; break;
+        case 0x04: boundLength = 16 + 2; break;
+        case 0x03: {
+            unsigned char nameLength = 0;
+            if (!ReceiveAll(socket, reinterpret_cast<char*>(&nameLength), 1)) {
+                return false;
+            }
+            boundLength = nameLength + 2u;
+            break;
+        }
+        default:
+            return false;
+    }
+    char bound[255 + 2];
+    return ReceiveAll(socket, bound, boundLength);
+}
+
+/**
+ * @brief In-process relay from WinHTTP to the SOCKS5 proxy
+ *
+ * One listener accepts CONNECT requests (used for https targets); further
+ * listeners, created on first use, each forward raw bytes to one http target.
+ * Every accepted connection gets its own tunnel and relay thread, and lives
+ * as long as WinHTTP keeps the connection.
+ *
+ * Other local processes can reach the listeners too, so the relay only serves
+ * this one: CONNECT requests must carry the relay's random token as Basic
+ * proxy credentials and name a target that Resolve routed here, and raw
+ * listeners accept only connections that this process opened.
+ */
+struct NetworkProxy::Relay : std::enable_shared_from_this<NetworkProxy::Relay> {
+    std::string proxyHost;
+    int proxyPort = 0;
+    std::string username;
+    std::string password;
+    int connectPort = 0;                                        ///< Port of the CONNECT listener
+    std::string token;                                          ///< Proxy password WinHTTP sends with CONNECT
+    std::string authorization;                                  ///< Expected Proxy-Authorization value
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    struct RawTarget {
+        int port = 0;                                           ///< Raw listener port
+        SOCKET listener = INVALID_SOCKET;
+        uint64_t lastRouted = 0;                                ///< Routing sequence of the last request
+    };
+    std::map<std::string, RawTarget> targetPorts;               ///< "host:port" of http targets
+    std::map<std::string, uint64_t> routedTargets;              ///< "host:port" of https targets -> routing sequence
+    uint64_t routedSequence = 0;
+    std::map<SOCKET, std::thread> acceptors;                    ///< Accept thread of each open listener
+    std::set<SOCKET> sockets;                                   ///< Client and proxy sockets of live connections
+    size_t connections = 0;
+    bool stopping = false;
+
+    /**
+     * @brief Open a listener on 127.0.0.1
+     * @param target Target host for a raw listener, empty for the CONNECT listener
+     * @param port Target port
+     * @param opened Receives the listener socket
+     * @return Listener port, 0 on failure
+     */
+    int Listen(const std::string& target, int port, SOCKET* opened = nullptr) {
+        SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listener == INVALID_SOCKET) {
+            return 0;
+        }
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        int addressLength = sizeof(address);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listener, SOMAXCONN) != 0 ||
+            getsockname(listener, reinterpret_cast<sockaddr*>(&address), &addressLength) != 0) {
+            closesocket(listener);
+            return 0;
+        }
+
+        // Caller holds mutex
+        acceptors[listener] = std::thread(&Relay::Accept, shared_from_this(), listener, target, port);
+        if (opened) {
+            *opened = listener;
+        }
+        return ntohs(address.sin_port);
+    }
+
+    /**
+     * @brief Raw listener port for an http target, created on first use
+     *
+     * Beyond kMaxRawTargets the least recently routed target's listener is
+     * closed; its open tunnels stay until WinHTTP drops them.
+     */
+    int TargetPort(const std::string& host, int port) {
+        std::thread evicted;
+        int listenerPort = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                return 0;
+            }
+            std::string key = NormalizeHost(host) + ":" + std::to_string(port);
+            auto it = targetPorts.find(key);
+            if (it != targetPorts.end()) {
+                it->second.lastRouted = ++routedSequence;
+                return it->second.port;
+            }
+            if (targetPorts.size() >= kMaxRawTargets) {
+                auto oldest = std::min_element(targetPorts.begin(), targetPorts.end(),
+                    [](const std::pair<const std::string, RawTarget>& a, const std::pair<const std::string, RawTarget>& b) {
+                        return a.second.lastRouted < b.second.lastRouted;
+                    });
+                SOCKET listener = oldest->second.listener;
+                shutdown(listener, SD_BOTH);
+                closesocket(listener);
+                evicted = std::move(acceptors[listener]);
+                acceptors.erase(listener);
+                targetPorts.erase(oldest);
+            }
+            RawTarget target;
+            target.port = Listen(host, port, &target.listener);
+            target.lastRouted = ++routedSequence;
+            if (target.port != 0) {
+                targetPorts[key] = target;
+            }
+            listenerPort = target.port;
+        }
+        // Outside the lock: the acceptor may need it to hand off a connection it just accepted
+        if (evicted.joinable()) {
+            evicted.join();
+        }
+        return listenerPort;
+    }
+
+    /**
+     * @brief Allow CONNECT requests to an https target
+     */
+    void AllowTarget(const std::string& host, int port) {
+        std::lock_guard<std::mutex> lock(mutex);
+        routedTargets[NormalizeHost(host) + ":" + std::to_string(port)] = ++routedSequence;
+        if (routedTargets.size() > kMaxRoutedTargets) {
+            auto oldest = std::min_element(routedTargets.begin(), routedTargets.end(),
+                [](const std::pair<const std::string, uint64_t>& a, const std::pair<const std::string, uint64_t>& b) {
+                    return a.second < b.second;
+                });
+            routedTargets.erase(oldest);
+        }
+    }
+
+    bool Routed(const std::string& host, int port) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return routedTargets.count(NormalizeHost(host) + ":" + std::to_string(port)) != 0;
+    }
+
+    void Accept(SOCKET listener, std::string target, int port) {
+        while (true) {
+            SOCKET client = accept(listener, nullptr, nullptr);
+            if (client == INVALID_SOCKET) {
+                return;  // Listener closed by Stop
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            if (stopping) {
+                closesocket(client);
+                return;
+            }
+            sockets.insert(client);
+            connections++;
+            lock.unlock();
+
+            std::thread(&Relay::Serve, shared_from_this(), client, target, port).detach();
+        }
+    }
+
+    void Serve(SOCKET client, std::string target, int port) {
+        BOOL noDelay = TRUE;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+        bool connectRequest = target.empty();
+        std::string early;  // Bytes the client sent after the CONNECT head
+        if (connectRequest) {
+            const char* refusal = ReadConnect(client, target, port, early);
+            if (refusal) {
+                SendAll(client, refusal, std::char_traits<char>::length(refusal));
+                Finish(client, INVALID_SOCKET);
+                return;
+            }
+        }
+        else if (!OwnedByThisProcess(client)) {
+            Finish(client, INVALID_SOCKET);
+            return;
+        }
+
+        SOCKET upstream = Dial(proxyHost, proxyPort);
+        if (upstream != INVALID_SOCKET) {
+            std::lock_guard<std::mutex> lock(mutex);
+            sockets.insert(upstream);
+            if (stopping) {
+                shutdown(upstream, SD_BOTH);
+            }
+        }
+        if (upstream != INVALID_SOCKET) {
+            SetReceiveTimeout(upstream, kHandshakeTimeoutMs);
+        }
+        if (upstream == INVALID_SOCKET || !Socks5Connect(upstream, target, port, username, password)) {
+            tunnelFailures.fetch_add(1, std::memory_order_relaxed);
+            if (connectRequest) {
+                static const char badGateway[] = "HTTP/1.1 502 Bad Gateway\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                SendAll(client, badGateway, sizeof(badGateway) - 1);
+            }
+            Finish(client, upstream);
+            return;
+        }
+        SetReceiveTimeout(upstream, 0);
+
+        tunnelsOpened.fetch_add(1, std::memory_order_relaxed);
+        tunnelsOpen.fetch_add(1, std::memory_order_relaxed);
+        static const char established[] = "HTTP/1.1 200 Connection Established\r\n\r\n";
+        if ((!connectRequest || SendAll(client, established, sizeof(established) - 1)) &&
+            SendAll(upstream, early.data(), early.size())) {
+            Pump(client, upstream);
+        }
+        tunnelsOpen.fetch_sub(1, std::memory_order_relaxed);
+        Finish(client, upstream);
+    }
+
+    /**
+     * @brief Read and check "CONNECT host:port HTTP/1.1" and its headers
+     * @return nullptr to open the tunnel, otherwise the response refusing it
+     */
+    const char* ReadConnect(SOCKET client, std::string& target, int& port, std::string& early) {
+        static const char badRequest[] = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        static const char authenticate[] = "HTTP/1.1 407 Proxy Authentication Required\r\n"
+                                           "Proxy-Authenticate: Basic realm=\"relay\"\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        static const char forbidden[] = "HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+        SetReceiveTimeout(client, kHandshakeTimeoutMs);
+        std::string head;
+        size_t end = std::string::npos;
+        char buffer[4096];
+        while ((end = head.find("\r\n\r\n")) == std::string::npos) {
+            if (head.size() > kMaxConnectHead) {
+                return badRequest;
+            }
+            int received = recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                return badRequest;
+            }
+            head.append(buffer, static_cast<size_t>(received));
+        }
+        SetReceiveTimeout(client, 0);
+        early = head.substr(end + 4);
+
+        if (head.compare(0, 8, "CONNECT ") != 0) {
+            return badRequest;
+        }
+        size_t authorityEnd = head.find(' ', 8);
+        if (authorityEnd == std::string::npos) {
+            return badRequest;
+        }
+        std::string authority = head.substr(8, authorityEnd - 8);
+        size_t colon = authority.rfind(':');
+        if (colon == std::string::npos || colon + 1 == authority.size() ||
+            authority.find_first_not_of("0123456789", colon + 1) != std::string::npos || authority.size() - colon > 6) {
+            return badRequest;
+        }
+        target = authority.substr(0, colon);
+        port = std::stoi(authority.substr(colon + 1));
+        if (target.empty() || port <= 0 || port > 65535) {
+            return badRequest;
+        }
+
+        std::string credentials;
+        size_t line = head.find("\r\n");
+        while (line < end) {
+            size_t next = head.find("\r\n", line + 2);
+            size_t colonAt = head.find(':', line + 2);
+            if (colonAt < next && Lowercase(head.substr(line + 2, colonAt - line - 2)) == "proxy-authorization") {
+                size_t valueStart = head.find_first_not_of(" \t", colonAt + 1);
+                size_t valueEnd = head.find_last_not_of(" \t", next - 1);
+                if (valueStart != std::string::npos && valueStart <= valueEnd && valueEnd < next) {
+                    credentials = head.substr(valueStart, valueEnd - valueStart + 1);
+                }
+            }
+            line = next;
+        }
+        if (!ConstantTimeEquals(credentials, authorization)) {
+            return authenticate;
+        }
+        return Routed(target, port) ? nullptr : forbidden;
+    }
+
+    /**
+     * @brief Copy bytes both ways until either side closes
+     */
+    static void Pump(SOCKET client, SOCKET upstream) {
+        std::vector<char> buffer(kRelayBufferSize);
+        while (true) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(client, &readable);
+            FD_SET(upstream, &readable);
+            if (select(0, &readable, nullptr, nullptr, nullptr) <= 0) {
+                return;
+            }
+            for (SOCKET from : { client, upstream }) {
+                if (!FD_ISSET(from, &readable)) {
+                    continue;
+                }
+                int received = recv(from, buffer.data(), static_cast<int>(buffer.size()), 0);
+                if (received <= 0 || !SendAll(from == client ? upstream : client, buffer.data(), static_cast<size_t>(received))) {
+                    return;
+                }
+            }
+        }
+    }
+
+    void Finish(SOCKET client, SOCKET upstream) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (SOCKET socket : { client, upstream }) {
+            if (socket != INVALID_SOCKET) {
+                sockets.erase(socket);
+                closesocket(socket);
+            }
+        }
+        if (--connections == 0) {
+            finished.notify_all();
+        }
+    }
+
+    /**
+     * @brief Close the listeners and every tunnel, and wait for the relay threads
+     */
+    void Stop() {
+        std::vector<std::thread> joining;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            for (auto& [listener, acceptor] : acceptors) {
+                shutdown(listener, SD_BOTH);
+                closesocket(listener);
+                joining.push_back(std::move(acceptor));
+            }
+            acceptors.clear();
+        }
+        for (auto& acceptor : joining) {
+            acceptor.join();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        for (SOCKET socket : sockets) {
+            shutdown(socket, SD_BOTH);
+        }
+        finished.wait(lock, [this]() { return connections == 0; });
+    }
+};
+
+bool NetworkProxy::Matches(const std::vector<std::string>& patterns, const std::string& host) {
+    std::string name = NormalizeHost(host);
+    for (const auto& pattern : patterns) {
+        if (pattern == "*") {
+            return true;
+        }
+        if (pattern == "<local>") {
+            if (name.find('.') == std::string::npos && name.find(':') == std::string::npos) {
+                return true;
+            }
+            continue;
+        }
+        if (name == pattern ||
+            (name.size() > pattern.size() && name[name.size() - pattern.size() - 1] == '.' &&
+             name.compare(name.size() - pattern.size(), pattern.size(), pattern) == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NetworkProxy::Enable(const Options& settings) {
+    if (settings.host.empty() || settings.port <= 0 || settings.port > 65535) {
+        return false;
+    }
+    if (settings.type == Type::Socks5 && (settings.username.size() > 255 || settings.password.size() > 255)) {
+        return false;
+    }
+
+    // no_proxy entries: "host", ".domain" or "*.domain" (both match the domain and its subdomains), "*", "<local>"
+    std::vector<std::string> patterns;
+    std::string entry;
+    for (size_t i = 0; i <= settings.no_proxy.size(); i++) {
+        char c = i < settings.no_proxy.size() ? settings.no_proxy[i] : ',';
+        if (c != ',' && c != ';' && !std::isspace(static_cast<unsigned char>(c))) {
+            entry += c;
+            continue;
+        }
+        if (entry.compare(0, 2, "*.") == 0) {
+            entry.erase(0, 2);
+        }
+        else if (!entry.empty() && entry[0] == '.') {
+            entry.erase(0, 1);
+        }
+        if (!entry.empty()) {
+            patterns.push_back(entry == "<local>" ? entry : NormalizeHost(entry));
+        }
+        entry.clear();
+    }
+
+    std::shared_ptr<Relay> started;
+    if (settings.type == Type::Socks5) {
+        static const bool winsockReady = []() {
+            WSADATA data;
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        if (!winsockReady) {
+            return false;
+        }
+        started = std::make_shared<Relay>();
+        started->proxyHost = settings.host;
+        started->proxyPort = settings.port;
+        started->username = settings.username;
+        started->password = settings.password;
+        started->token = RandomToken();
+        started->authorization = "Basic " + Base64Encode(std::string(kRelayUsername) + ":" + started->token);
+        {
+            std::lock_guard<std::mutex> lock(started->mutex);
+            started->connectPort = started->Listen(std::string(), 0);
+        }
+        if (started->connectPort == 0) {
+            started->Stop();
+            return false;
+        }
+    }
+
+    std::shared_ptr<Relay> previous;
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        options = settings;
+        noProxy = std::move(patterns);
+        previous = std::move(relay);
+        relay = std::move(started);
+        enabled.store(true, std::memory_order_relaxed);
+    }
+    if (previous) {
+        previous->Stop();
+    }
+    return true;
+}
+
+void NetworkProxy::Disable() {
+    std::shared_ptr<Relay> previous;
+    {
+        std::lock_guard<std::mutex> lock(configMutex);
+        enabled.store(false, std::memory_order_relaxed);
+        previous = std::move(relay);
+    }
+    if (previous) {
+        previous->Stop();
+    }
+}
+
+bool NetworkProxy::Bypasses(const std::string& host) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    return Matches(noProxy, host);
+}
+
+NetworkProxy::Route NetworkProxy::Resolve(const std::string& protocol, const std::string& host, int port) {
+    Route route;
+    std::lock_guard<std::mutex> lock(configMutex);
+    if (!enabled.load(std::memory_order_relaxed) || Matches(noProxy, host)) {
+        direct.fetch_add(1, std::memory_order_relaxed);
+        return route;
+    }
+    proxied.fetch_add(1, std::memory_order_relaxed);
+
+    if (options.type == Type::Http) {
+        bool ipv6 = options.host.find(':') != std::string::npos && options.host.front() != '[';
+        route.kind = Route::Kind::Proxy;
+        route.proxy = (ipv6 ? "[" + options.host + "]" : options.host) + ":" + std::to_string(options.port);
+        route.username = options.username;
+        route.password = options.password;
+    }
+    else if (protocol == "https") {
+        // WinHTTP tunnels through the relay with CONNECT, as through an HTTP proxy
+        route.kind = Route::Kind::Proxy;
+        route.proxy = "127.0.0.1:" + std::to_string(relay->connectPort);
+        route.username = kRelayUsername;
+        route.password = relay->token;
+        relay->AllowTarget(host, port);
+    }
+    else {
+        // Plain HTTP through a proxy is sent in absolute form over shared connections;
+        // a port per target keeps each connection, and so each tunnel, to one target
+        route.kind = Route::Kind::Relay;
+        route.relay_port = relay->TargetPort(host, port);
+    }
+    return route;
+}
+
+NetworkProxy::Stats NetworkProxy::GetStats() {
+    Stats stats;
+    stats.requests_proxied = proxied.load(std::memory_order_relaxed);
+    stats.requests_direct = direct.load(std::memory_order_relaxed);
+    stats.tunnels_opened = tunnelsOpened.load(std::memory_order_relaxed);
+    stats.tunnels_open = tunnelsOpen.load(std::memory_order_relaxed);
+    stats.tunnel_failures = tunnelFailures.load(std::memory_order_relaxed);
+    return stats;
+}
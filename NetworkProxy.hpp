@@ -0,0 +1,149 @@
+/**
+ * @file NetworkProxy.hpp
+ * @brief Explicit forward proxy support: HTTP CONNECT and SOCKS5
+ *
+ * When enabled, every request whose host is not on the no-proxy list goes
+ * through the configured proxy, and tunnels are kept and reused per target
+ * instead of being set up for each request:
+ *
+ *  - HTTP proxies are handed to WinHTTP. https targets are tunnelled with
+ *    CONNECT; WinHTTP pools each tunnel as a connection to its target, so
+ *    later requests to the same host reuse it without a new CONNECT or TLS
+ *    handshake. http targets are forwarded over kept-alive proxy connections.
+ *  - SOCKS5 proxies, which WinHTTP does not support, are reached through an
+ *    in-process relay on 127.0.0.1. WinHTTP sends https targets to the relay
+ *    as CONNECT requests, and http targets to a relay port dedicated to the
+ *    target; either way the relay opens one SOCKS5 tunnel per connection it
+ *    accepts, so WinHTTP's keep-alive pool is a pool of tunnels per target.
+ *    Target names are resolved by the proxy (socks5h). The relay serves only
+ *    this process: CONNECT requests must carry a random per-relay token as
+ *    proxy credentials and name a target routed through it, and the raw
+ *    ports accept only connections opened by this process.
+ *
+ * @code
+ * NetworkProxy::Options proxy;
+ * proxy.type = NetworkProxy::Type::Socks5;
+ * proxy.host = "egress.internal";
+ * proxy.port = 1080;
+ * proxy.no_proxy = "localhost,127.0.0.1,.svc.cluster.local";
+ * NetworkProxy::Enable(proxy);
+ * @endcode
+ *
+ * Unix socket URLs never use the proxy.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_PROXY_HPP
+#define NETWORK_PROXY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Library-wide forward proxy configuration and SOCKS5 relay
+ */
+class NetworkProxy {
+public:
+    /**
+     * @brief Proxy protocols
+     */
+    enum class Type {
+        Http,                                                   ///< HTTP proxy; https targets use CONNECT tunnels
+        Socks5                                                  ///< SOCKS5 proxy (RFC 1928), names resolved by the proxy
+    };
+
+    /**
+     * @brief Proxy settings
+     */
+    struct Options {
+        Type type = Type::Http;                                 ///< Proxy protocol
+        std::string host;                                       ///< Proxy host name or address
+        int port = 8080;                                        ///< Proxy port
+        std::string username;                                   ///< Credentials (Basic for HTTP, RFC 1929 for SOCKS5); empty for none
+        std::string password;                                   ///< Password for username
+        std::string no_proxy;                                   ///< Comma-separated hosts and domain suffixes reached directly ("*" for all, "<local>" for dotless names)
+    };
+
+    /**
+     * @brief How one request reaches its target
+     */
+    struct Route {
+        enum class Kind {
+            Direct,                                             ///< No proxy (WINHTTP_ACCESS_TYPE_NO_PROXY)
+            Proxy,                                              ///< WinHTTP named proxy in `proxy`
+            Relay                                               ///< Connect to 127.0.0.1:relay_port, which tunnels to the target
+        };
+        Kind kind = Kind::Direct;
+        std::string proxy;                                      ///< "host:port" for Kind::Proxy
+        int relay_port = 0;                                     ///< Relay port for Kind::Relay
+        std::string username;                                   ///< Proxy credentials for Kind::Proxy
+        std::string password;
+    };
+
+    /**
+     * @brief Proxy counters
+     */
+    struct Stats {
+        uint64_t requests_proxied = 0;                          ///< Requests routed through the proxy
+        uint64_t requests_direct = 0;                           ///< Requests matching the no-proxy list
+        uint64_t tunnels_opened = 0;                            ///< SOCKS5 tunnels established by the relay (WinHTTP does not report its CONNECT tunnels)
+        uint64_t tunnels_open = 0;                              ///< SOCKS5 tunnels currently open
+        uint64_t tunnel_failures = 0;                           ///< SOCKS5 connections or handshakes that failed
+    };
+
+    /**
+     * @brief Route requests through a proxy
+     * @param options Proxy settings
+     * @return false if the settings are invalid or the SOCKS5 relay could not start
+     */
+    static bool Enable(const Options& options);
+
+    /**
+     * @brief Stop using the proxy; requests use the system proxy settings again
+     *
+     * Closes the SOCKS5 relay and every tunnel through it.
+     */
+    static void Disable();
+
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Whether a host is on the no-proxy list
+     */
+    static bool Bypasses(const std::string& host);
+
+    /**
+     * @brief Route for a request (call only while enabled)
+     * @param protocol URL protocol (http/https)
+     * @param host Target host
+     * @param port Target port
+     * @return How to connect
+     */
+    static Route Resolve(const std::string& protocol, const std::string& host, int port);
+
+    static Stats GetStats();
+
+private:
+    struct Relay;
+
+    static bool Matches(const std::vector<std::string>& patterns, const std::string& host);
+
+    static std::atomic<bool> enabled;
+    static Options options;                                     ///< Guarded by configMutex
+    static std::vector<std::string> noProxy;                    ///< Parsed no_proxy entries, lowercased
+    static std::shared_ptr<Relay> relay;                        ///< SOCKS5 relay, if the proxy is SOCKS5
+    static std::mutex configMutex;
+    static std::atomic<uint64_t> proxied;
+    static std::atomic<uint64_t> direct;
+    static std::atomic<uint64_t> tunnelsOpened;
+    static std::atomic<uint64_t> tunnelsOpen;
+    static std::atomic<uint64_t> tunnelFailures;
+};
+
+#endif // NETWORK_PROXY_HPP
@@ -0,0 +1,120 @@
+/**
+ * @file NetworkQueue.hpp
+ * @brief Bounded lock-free queue used to hand records off the request path
+ *
+ * A fixed-capacity multi-producer multi-consumer ring (Vyukov's sequence-number
+ * design). Producers never block: when the ring is full TryPush fails and the
+ * caller decides whether to drop. Used by tracing and HAR export so that
+ * Network::Request only ever pays for a couple of atomic operations.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_QUEUE_HPP
+#define NETWORK_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Bounded MPMC ring buffer
+ * @tparam T Element type; must be default-constructible and move-assignable
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    /**
+     * @brief Create a queue
+     * @param capacity Maximum number of elements, rounded up to a power of two
+     */
+    explicit BoundedQueue(size_t capacity) {
+        size_t rounded = 2;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        mask = rounded - 1;
+        cells.reset(new Cell[rounded]);
+        for (size_t i = 0; i < rounded; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Append an element without blocking
+     * @param value Element to move into the queue
+     * @return true if queued, false if the queue is full (value is left untouched)
+     */
+    bool TryPush(T&& value) {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;  // Full
+            }
+            else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Remove the oldest element without blocking
+     * @param value Receives the element
+     * @return true if an element was removed, false if the queue is empty
+     */
+    bool TryPop(T& value) {
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (difference == 0) {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;  // Empty
+            }
+            else {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Maximum number of elements
+     */
+    size_t Capacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> enqueuePosition{0};
+    alignas(64) std::atomic<size_t> dequeuePosition{0};
+};
+
+#endif // NETWORK_QUEUE_HPP
@@ -0,0 +1,343 @@
+/**
+ * @file NetworkReplay.cpp
+ * @brief Implementation of trace recording and memory-mapped replay
+ */
+
+#include "NetworkReplay.hpp"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+// Initialize static members
+std::atomic<bool> NetworkReplay::recording{false};
+std::atomic<bool> NetworkReplay::replaying{false};
+std::shared_ptr<NetworkReplay::Recorder> NetworkReplay::recorder;
+std::shared_ptr<NetworkReplay::Player> NetworkReplay::player;
+
+static const char kMagic[8] = { 'N', 'W', 'T', 'R', 'A', 'C', 'E', '1' };
+
+template<typename T>
+static void Append(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void AppendString(std::string& out, const std::string& value) {
+    Append(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+/**
+ * @brief Bounds-checked reader over one mapped record
+ */
+class RecordReader {
+public:
+    RecordReader(const char* data, size_t size) : position(data), end(data + size) {}
+
+    template<typename T>
+    bool Read(T& value) {
+        if (static_cast<size_t>(end - position) < sizeof(T)) return false;
+        std::memcpy(&value, position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+
+    template<typename Length>
+    bool ReadString(std::string_view& value) {
+        Length length;
+        if (!Read(length) || static_cast<uint64_t>(end - position) < length) return false;
+        value = std::string_view(position, static_cast<size_t>(length));
+        position += length;
+        return true;
+    }
+
+    bool AtEnd() const { return position == end; }
+
+private:
+    const char* position;
+    const char* end;
+};
+
+static std::string ReplayKey(Network::Method method, std::string_view url) {
+    std::string key = Network::MethodName(method);
+    key += ' ';
+    key.append(url.data(), url.size());
+    return key;
+}
+
+ReplayFile::~ReplayFile() {
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+}
+
+bool ReplayFile::Open(const std::string& path, std::string& error) {
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = "Cannot open trace file: " + std::to_string(GetLastError());
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(kMagic))) {
+        error = "Trace file is too short";
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        error = "Cannot map trace file: " + std::to_string(GetLastError());
+        return false;
+    }
+    data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        error = "Cannot map trace file: " + std::to_string(GetLastError());
+        return false;
+    }
+
+    return Parse(error);
+}
+
+/**
+ * @brief Indexes all records, pointing into the mapping
+ */
+bool ReplayFile::Parse(std::string& error) {
+    if (std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+        error = "Not a Network trace file";
+        return false;
+    }
+
+    size_t offset = sizeof(kMagic);
+    while (offset < size) {
+        uint32_t recordSize;
+        if (size - offset < sizeof(recordSize)) {
+            break;  // Truncated tail, e.g. recording was interrupted
+        }
+        std::memcpy(&recordSize, data + offset, sizeof(recordSize));
+        offset += sizeof(recordSize);
+        if (size - offset < recordSize) {
+            break;
+        }
+
+        RecordReader reader(data + offset, recordSize);
+        ReplayRecord record;
+        uint8_t method, flags, errorType, reserved;
+        int32_t statusCode;
+        uint64_t payloadSize;
+        int64_t startOffset;
+        uint32_t headerCount;
+        bool valid = reader.Read(method) && reader.Read(flags) && reader.Read(errorType) && reader.Read(reserved) &&
+                     reader.Read(statusCode) && reader.Read(payloadSize) && reader.Read(startOffset);
+        for (size_t i = 0; valid && i < ReplayRecord::kPhaseCount; i++) {
+            valid = reader.Read(record.phase_ns[i]);
+        }
+        valid = valid && reader.ReadString<uint32_t>(record.url) &&
+                reader.ReadString<uint32_t>(record.error_message) && reader.Read(headerCount);
+        for (uint32_t i = 0; valid && i < headerCount; i++) {
+            std::string_view name, value;
+            valid = reader.ReadString<uint32_t>(name) && reader.ReadString<uint32_t>(value);
+            record.headers.emplace_back(name, value);
+        }
+        valid = valid && reader.ReadString<uint64_t>(record.body) && reader.AtEnd();
+        // Enums are stored as bytes; a foreign or damaged file must not produce values outside them
+        valid = valid && method <= static_cast<uint8_t>(Network::Method::HTTP_DELETE) &&
+                errorType <= static_cast<uint8_t>(Network::ErrorType::ResourceLimit);
+        if (!valid) {
+            error = "Corrupt record at offset " + std::to_string(offset);
+            return false;
+        }
+
+        record.method = static_cast<Network::Method>(method);
+        record.success = (flags & 1) != 0;
+        record.connection_reused = (flags & 2) != 0;
+        record.error_type = static_cast<Network::ErrorType>(errorType);
+        record.status_code = statusCode;
+        record.payload_size = static_cast<size_t>(payloadSize);
+        record.start_offset = std::chrono::nanoseconds(startOffset);
+        records.push_back(std::move(record));
+        offset += recordSize;
+    }
+    return true;
+}
+
+/**
+ * @brief Starts recording into a new trace file
+ *
+ * @param path The file to create
+ * @return true if the file was created
+ */
+bool NetworkReplay::StartRecording(const std::string& path) {
+    auto newRecorder = std::make_shared<Recorder>();
+    newRecorder->out.open(path, std::ios::binary | std::ios::trunc);
+    if (!newRecorder->out) {
+        return false;
+    }
+    newRecorder->out.write(kMagic, sizeof(kMagic));
+
+    StopRecording();
+    std::atomic_store(&recorder, newRecorder);
+    recording.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void NetworkReplay::StopRecording() {
+    recording.store(false, std::memory_order_relaxed);
+    auto oldRecorder = std::atomic_exchange(&recorder, std::shared_ptr<Recorder>());
+    if (oldRecorder) {
+        std::lock_guard<std::mutex> lock(oldRecorder->mutex);
+        oldRecorder->out.flush();
+        oldRecorder->out.close();
+    }
+}
+
+/**
+ * @brief Serializes a request outside the lock, then appends it to the file
+ */
+void NetworkReplay::Record(
+    Network::Method method,
+    const std::string& url,
+    size_t payloadSize,
+    const Network::NetworkResponse& response
+) {
+    auto activeRecorder = std::atomic_load(&recorder);
+    if (!activeRecorder) {
+        return;
+    }
+
+    const auto& timings = response.timings;
+    const std::chrono::steady_clock::time_point phases[ReplayRecord::kPhaseCount] = {
+        timings.dequeued, timings.rate_limited, timings.dns_start, timings.dns_end, timings.connect_start,
+        timings.connect_end, timings.send_start, timings.request_sent, timings.first_byte, timings.last_byte
+    };
+
+    thread_local std::string buffer;
+    buffer.clear();
+    Append(buffer, static_cast<uint32_t>(0));  // Size, patched below
+    Append(buffer, static_cast<uint8_t>(method));
+    Append(buffer, static_cast<uint8_t>((response.success ? 1 : 0) | (timings.connection_reused ? 2 : 0)));
+    Append(buffer, static_cast<uint8_t>(response.error_type));
+    Append(buffer, static_cast<uint8_t>(0));
+    Append(buffer, static_cast<int32_t>(response.status_code));
+    Append(buffer, static_cast<uint64_t>(payloadSize));
+    size_t startOffsetPosition = buffer.size();
+    Append(buffer, static_cast<int64_t>(0));  // Start offset, filled in under the lock
+    for (const auto& phase : phases) {
+        int64_t offset = (phase == std::chrono::steady_clock::time_point()) ? -1
+            : std::chrono::duration_cast<std::chrono::nanoseconds>(phase - timings.start).count();
+        Append(buffer, offset);
+    }
+    AppendString(buffer, url);
+    AppendString(buffer, response.error_message);
+    Append(buffer, static_cast<uint32_t>(response.headers.size()));
+    for (const auto& [name, value] : response.headers) {
+        AppendString(buffer, name);
+        AppendString(buffer, value);
+    }
+
+    // The record size field is 32 bits; responses too large for it are left out of the trace
+    if (buffer.size() - sizeof(uint32_t) + sizeof(uint64_t) + response.body.size() > UINT32_MAX) {
+        return;
+    }
+    Append(buffer, static_cast<uint64_t>(response.body.size()));
+    buffer.append(response.body);
+
+    uint32_t recordSize = static_cast<uint32_t>(buffer.size() - sizeof(uint32_t));
+    std::memcpy(&buffer[0], &recordSize, sizeof(recordSize));
+
+    std::lock_guard<std::mutex> lock(activeRecorder->mutex);
+    if (!activeRecorder->hasOrigin) {
+        activeRecorder->origin = timings.start;
+        activeRecorder->hasOrigin = true;
+    }
+    int64_t startOffset = std::chrono::duration_cast<std::chrono::nanoseconds>(timings.start - activeRecorder->origin).count();
+    std::memcpy(&buffer[startOffsetPosition], &startOffset, sizeof(startOffset));
+    activeRecorder->out.write(buffer.data(), buffer.size());
+}
+
+/**
+ * @brief Loads a trace file for replay
+ *
+ * @param path The trace file
+ * @param speed Replay speed factor (0 = no delays)
+ * @param error Receives the reason on failure
+ * @return true if the trace was loaded
+ */
+bool NetworkReplay::StartReplay(const std::string& path, double speed, std::string& error) {
+    auto newPlayer = std::make_shared<Player>();
+    if (!newPlayer->file.Open(path, error)) {
+        return false;
+    }
+    newPlayer->speed = speed;
+    for (size_t i = 0; i < newPlayer->file.Size(); i++) {
+        const ReplayRecord& record = newPlayer->file.Record(i);
+        newPlayer->cursors[ReplayKey(record.method, record.url)].records.push_back(i);
+    }
+
+    std::atomic_store(&player, newPlayer);
+    replaying.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void NetworkReplay::StopReplay() {
+    replaying.store(false, std::memory_order_relaxed);
+    std::atomic_store(&player, std::shared_ptr<Player>());
+}
+
+/**
+ * @brief Serves a recorded response, reproducing its phase timings at the replay speed
+ */
+void NetworkReplay::Replay(Network::Method method, const std::string& url, Network::NetworkResponse& response) {
+    auto activePlayer = std::atomic_load(&player);
+    Cursor* cursor = nullptr;
+    if (activePlayer) {
+        auto it = activePlayer->cursors.find(ReplayKey(method, url));
+        if (it != activePlayer->cursors.end()) {
+            cursor = &it->second;
+        }
+    }
+    if (!cursor) {
+        response.success = false;
+        response.error_message = "No recorded response for " + std::string(Network::MethodName(method)) + " " + url;
+        response.error_type = Network::ErrorType::Other;
+        return;
+    }
+
+    size_t next = cursor->next.fetch_add(1, std::memory_order_relaxed);
+    const ReplayRecord& record = activePlayer->file.Record(cursor->records[next % cursor->records.size()]);
+
+    // The queue wait just happened for real; the phases after it are reproduced
+    // relative to now, scaled by the replay speed
+    auto& timings = response.timings;
+    std::chrono::steady_clock::time_point* phases[ReplayRecord::kPhaseCount] = {
+        nullptr, &timings.rate_limited, &timings.dns_start, &timings.dns_end, &timings.connect_start,
+        &timings.connect_end, &timings.send_start, &timings.request_sent, &timings.first_byte, &timings.last_byte
+    };
+    auto replayStart = std::chrono::steady_clock::now();
+    int64_t recordedDequeue = std::max<int64_t>(record.phase_ns[0], 0);
+    for (size_t i = 1; i < ReplayRecord::kPhaseCount; i++) {
+        if (record.phase_ns[i] < 0) {
+            *phases[i] = std::chrono::steady_clock::time_point();
+        }
+        else if (activePlayer->speed > 0.0) {
+            int64_t offset = std::max<int64_t>(record.phase_ns[i] - recordedDequeue, 0);
+            *phases[i] = replayStart + std::chrono::nanoseconds(static_cast<int64_t>(offset / activePlayer->speed));
+        }
+        else {
+            *phases[i] = replayStart;
+        }
+    }
+    timings.connection_reused = record.connection_reused;
+
+    response.success = record.success;
+    response.status_code = record.status_code;
+    response.error_type = record.error_type;
+    response.error_message.assign(record.error_message.data(), record.error_message.size());
+    for (const auto& [name, value] : record.headers) {
+        response.headers[std::string(name)] = std::string(value);
+    }
+    response.body.assign(record.body.data(), record.body.size());
+
+    if (timings.last_byte != std::chrono::steady_clock::time_point()) {
+        std::this_thread::sleep_until(timings.last_byte);
+    }
+}
@@ -0,0 +1,195 @@
+/**
+ * @file NetworkReplay.hpp
+ * @brief Record-and-replay transport for the Network library
+ *
+ * While recording, every request Network::Request sends is appended to a
+ * compact binary trace file: method, URL, status, headers, body and the phase
+ * timings. While replaying, Network::Request serves responses from such a file
+ * instead of the network, at the recorded speed or accelerated, so client code
+ * and the library's own bookkeeping can be profiled offline.
+ *
+ * Trace files are memory-mapped during replay; bodies are copied straight out
+ * of the mapping, so replay never waits on file I/O.
+ *
+ * File layout (little-endian):
+ * @code
+ * "NWTRACE1"                             8-byte magic
+ * record*
+ *   uint32 size                          bytes following this field
+ *   uint8  method, flags, error_type, 0  flags: 1 = success, 2 = connection reused
+ *   int32  status_code
+ *   uint64 payload_size                  request body size (the body is not stored)
+ *   int64  start_offset_ns               since recording started
+ *   int64  phase_ns[10]                  since request start, -1 if the phase did not happen
+ *   uint32 + bytes  url
+ *   uint32 + bytes  error_message
+ *   uint32 header_count, (uint32 + bytes name, uint32 + bytes value)*
+ *   uint64 + bytes  body
+ * @endcode
+ *
+ * A record holds at most 4 GB (the size field), so larger responses are not
+ * recorded. A record whose method or error_type is outside the enums rejects
+ * the whole file as corrupt.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_REPLAY_HPP
+#define NETWORK_REPLAY_HPP
+
+#include "Network.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief One recorded exchange, viewing memory owned by a ReplayFile
+ */
+struct ReplayRecord {
+    static constexpr size_t kPhaseCount = 10;                   ///< Timing phases after Timings::start
+
+    Network::Method method = Network::Method::HTTP_GET;         ///< HTTP method
+    std::string_view url;                                       ///< Request URL
+    size_t payload_size = 0;                                    ///< Request body size
+    std::chrono::nanoseconds start_offset{0};                   ///< Start relative to the first recorded request
+    int status_code = 0;                                        ///< HTTP status code
+    bool success = false;                                       ///< Whether the request succeeded
+    bool connection_reused = false;                             ///< Whether a pooled connection was used
+    Network::ErrorType error_type = Network::ErrorType::None;   ///< Failure class
+    std::string_view error_message;                             ///< Error message
+    std::array<int64_t, kPhaseCount> phase_ns{};                ///< dequeued .. last_byte since start, -1 if unset
+    std::vector<std::pair<std::string_view, std::string_view>> headers;  ///< Response headers
+    std::string_view body;                                      ///< Response body
+};
+
+/**
+ * @brief Read-only, memory-mapped trace file
+ */
+class ReplayFile {
+public:
+    ReplayFile() = default;
+    ~ReplayFile();
+
+    ReplayFile(const ReplayFile&) = delete;
+    ReplayFile& operator=(const ReplayFile&) = delete;
+
+    /**
+     * @brief Map a trace file and index its records
+     * @param path Trace file path
+     * @param error Receives the reason on failure
+     * @return true if the file is a valid trace
+     */
+    bool Open(const std::string& path, std::string& error);
+
+    size_t Size() const { return records.size(); }              ///< Number of records
+    const ReplayRecord& Record(size_t index) const { return records[index]; }
+
+private:
+    bool Parse(std::string& error);
+
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+    const char* data = nullptr;
+    size_t size = 0;
+    std::vector<ReplayRecord> records;
+};
+
+/**
+ * @brief Global recording and replay control
+ */
+class NetworkReplay {
+public:
+    /**
+     * @brief Start appending every request to a new trace file
+     * @param path File to create (overwritten if it exists)
+     * @return true if the file could be created
+     */
+    static bool StartRecording(const std::string& path);
+
+    /**
+     * @brief Flush and close the trace file
+     */
+    static void StopRecording();
+
+    /**
+     * @brief Whether requests are being recorded
+     */
+    static bool IsRecording() { return recording.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Serve all requests from a trace file instead of the network
+     *
+     * Requests are matched by method and URL; repeated requests for the same
+     * key cycle through its recordings in order. Unmatched requests fail.
+     *
+     * @param path Trace file written by StartRecording
+     * @param speed Replay speed: 1.0 reproduces recorded latencies, 2.0 halves them,
+     *              0 serves every response immediately
+     * @param error Receives the reason on failure
+     * @return true if the trace was loaded
+     */
+    static bool StartReplay(const std::string& path, double speed, std::string& error);
+
+    /**
+     * @brief Go back to sending requests over the network
+     */
+    static void StopReplay();
+
+    /**
+     * @brief Whether requests are served from a trace
+     */
+    static bool IsReplaying() { return replaying.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Append a completed request to the trace (called by Network::Request)
+     * @param method HTTP method
+     * @param url Request URL
+     * @param payloadSize Request body size
+     * @param response Completed response
+     */
+    static void Record(Network::Method method, const std::string& url, size_t payloadSize, const Network::NetworkResponse& response);
+
+    /**
+     * @brief Fill a response from the trace (called by Network::Request)
+     * @param method HTTP method
+     * @param url Request URL
+     * @param response Response to fill; timings.start must already be set
+     */
+    static void Replay(Network::Method method, const std::string& url, Network::NetworkResponse& response);
+
+private:
+    struct Recorder {
+        std::mutex mutex;
+        std::ofstream out;
+        std::chrono::steady_clock::time_point origin;
+        bool hasOrigin = false;
+    };
+
+    struct Cursor {
+        std::vector<size_t> records;
+        std::atomic<size_t> next{0};
+    };
+
+    struct Player {
+        ReplayFile file;
+        double speed = 1.0;
+        std::unordered_map<std::string, Cursor> cursors;        // Keyed by "METHOD url"
+    };
+
+    static std::atomic<bool> recording;
+    static std::atomic<bool> replaying;
+    static std::shared_ptr<Recorder> recorder;                  ///< Accessed with std::atomic_load/store
+    static std::shared_ptr<Player> player;                      ///< Accessed with std::atomic_load/store
+};
+
+#endif // NETWORK_REPLAY_HPP
@@ -0,0 +1,129 @@
+/**
+ * @file NetworkScheduler.cpp
+ * @brief Implementation of priority and weighted fair request scheduling
+ */
+
+#include "NetworkScheduler.hpp"
+#include <algorithm>
+
+// Initialize static members
+std::mutex NetworkScheduler::schedulerMutex;
+int NetworkScheduler::maxConcurrency = 16;
+int NetworkScheduler::inFlight = 0;
+std::deque<NetworkScheduler::Waiter*> NetworkScheduler::interactive;
+std::vector<NetworkScheduler::Waiter*> NetworkScheduler::normal;
+std::map<std::string, NetworkScheduler::Flow> NetworkScheduler::flows;
+double NetworkScheduler::virtualTime = 0.0;
+uint64_t NetworkScheduler::nextSequence = 0;
+
+// Idle flows are pruned once this many are tracked
+static const size_t kMaxIdleFlows = 256;
+
+NetworkScheduler::Slot::Slot(const Network::RequestConfig& config) {
+    Acquire(config);
+}
+
+NetworkScheduler::Slot::~Slot() {
+    Release();
+}
+
+void NetworkScheduler::SetMaxConcurrency(int maxConcurrent) {
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    maxConcurrency = std::max(maxConcurrent, 1);
+    DispatchLocked();
+}
+
+int NetworkScheduler::GetMaxConcurrency() {
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    return maxConcurrency;
+}
+
+int NetworkScheduler::InFlight() {
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    return inFlight;
+}
+
+size_t NetworkScheduler::Queued() {
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    return interactive.size() + normal.size();
+}
+
+/**
+ * @brief Heap order for Normal waiters: earliest start tag first, then arrival order
+ */
+bool NetworkScheduler::LaterStart(const Waiter* a, const Waiter* b) {
+    return a->startTag != b->startTag ? a->startTag > b->startTag : a->sequence > b->sequence;
+}
+
+/**
+ * @brief Takes a slot, queuing behind the limit if all slots are taken
+ *
+ * Normal requests get a start tag of max(virtual time, flow's last finish);
+ * each request advances its flow's finish by 1/weight, so a flow with twice the
+ * weight is dispatched twice as often while both have requests queued.
+ */
+void NetworkScheduler::Acquire(const Network::RequestConfig& config) {
+    std::unique_lock<std::mutex> lock(schedulerMutex);
+    if (inFlight < maxConcurrency && interactive.empty() && normal.empty()) {
+        inFlight++;
+        return;
+    }
+
+    Waiter waiter;
+    waiter.sequence = nextSequence++;
+    if (config.priority == Network::Priority::Interactive) {
+        interactive.push_back(&waiter);
+    }
+    else {
+        Flow& flow = flows[config.flow];
+        waiter.startTag = std::max(virtualTime, flow.lastFinish);
+        flow.lastFinish = waiter.startTag + 1.0 / std::max(config.weight, 1);
+        flow.queued++;
+        normal.push_back(&waiter);
+        waiter.flow = &flow;
+        std::push_heap(normal.begin(), normal.end(), LaterStart);
+    }
+
+    waiter.ready.wait(lock, [&waiter]() { return waiter.granted; });
+}
+
+void NetworkScheduler::Release() {
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    inFlight--;
+    DispatchLocked();
+}
+
+/**
+ * @brief Grants free slots to queued requests: interactive first, then the earliest start tag
+ */
+void NetworkScheduler::DispatchLocked() {
+    while (inFlight < maxConcurrency && (!interactive.empty() || !normal.empty())) {
+        Waiter* next;
+        if (!interactive.empty()) {
+            next = interactive.front();
+            interactive.pop_front();
+        }
+        else {
+            std::pop_heap(normal.begin(), normal.end(), LaterStart);
+            next = normal.back();
+            normal.pop_back();
+            next->flow->queued--;
+            virtualTime = next->startTag;
+        }
+        inFlight++;
+        next->granted = true;
+        next->ready.notify_one();
+    }
+
+    if (flows.size() > kMaxIdleFlows) {
+        for (auto it = flows.begin(); it != flows.end();) {
+            // A flow whose tags are all in the past behaves exactly like a new one
+            if (it->second.queued == 0 && it->second.lastFinish <= virtualTime) {
+                it = flows.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+}
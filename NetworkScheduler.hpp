@@ -0,0 +1,108 @@
+/**
+ * @file NetworkScheduler.hpp
+ * @brief Priority and weighted fair scheduling of outbound requests
+ *
+ * Network::Request takes a slot from the scheduler once it has been admitted
+ * by the memory budget and the adaptive per-host limiter, and before it
+ * reaches the rate limiter and the connection pool; each redirect hop takes a
+ * slot of its own. A request waiting on a busy host therefore holds no slot.
+ * While fewer than the configured maximum of
+ * requests are in flight, slots are granted immediately. Once the limit is
+ * reached, requests queue and are dispatched as slots free up:
+ *
+ *  - Priority::Interactive requests go first, in arrival order.
+ *  - Priority::Normal requests are dispatched by start-time fair queuing
+ *    across RequestConfig::flow, each flow receiving slots in proportion to
+ *    its RequestConfig::weight, so one busy flow cannot starve the others.
+ *
+ * The time a request spends queued is reported as NetworkResponse::Timings::QueueWait.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_SCHEDULER_HPP
+#define NETWORK_SCHEDULER_HPP
+
+#include "Network.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Process-wide request slot scheduler
+ */
+class NetworkScheduler {
+public:
+    /**
+     * @brief A request slot, held for the lifetime of the object
+     *
+     * Blocks in the constructor until the request may proceed.
+     */
+    class Slot {
+    public:
+        explicit Slot(const Network::RequestConfig& config);
+        ~Slot();
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+    };
+
+    /**
+     * @brief Set the number of requests allowed in flight at once
+     *
+     * Raising the limit dispatches queued requests right away; lowering it
+     * lets requests in flight finish.
+     *
+     * @param maxConcurrent Maximum requests in flight (at least 1)
+     */
+    static void SetMaxConcurrency(int maxConcurrent);
+
+    /**
+     * @brief Number of requests allowed in flight at once (default 16)
+     */
+    static int GetMaxConcurrency();
+
+    /**
+     * @brief Requests currently in flight
+     */
+    static int InFlight();
+
+    /**
+     * @brief Requests currently waiting for a slot
+     */
+    static size_t Queued();
+
+private:
+    struct Flow {
+        double lastFinish = 0.0;                                // Virtual finish time of the flow's last request
+        size_t queued = 0;                                      // Waiters of the flow; queued flows are never pruned
+    };
+
+    struct Waiter {
+        std::condition_variable ready;
+        bool granted = false;
+        double startTag = 0.0;                                  // Virtual start time (Normal only)
+        uint64_t sequence = 0;                                  // Arrival order, breaks ties
+        Flow* flow = nullptr;                                   // Normal only
+    };
+
+    static bool LaterStart(const Waiter* a, const Waiter* b);
+    static void Acquire(const Network::RequestConfig& config);
+    static void Release();
+    static void DispatchLocked();
+
+    static std::mutex schedulerMutex;
+    static int maxConcurrency;
+    static int inFlight;
+    static std::deque<Waiter*> interactive;                     ///< Strict-priority FIFO
+    static std::vector<Waiter*> normal;                         ///< Min-heap on (startTag, sequence)
+    static std::map<std::string, Flow> flows;                   ///< Flows with requests queued or recently dispatched
+    static double virtualTime;                                  ///< Start tag of the last dispatched Normal request
+    static uint64_t nextSequence;
+};
+
+#endif // NETWORK_SCHEDULER_HPP
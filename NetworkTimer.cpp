@@ -0,0 +1,129 @@
+/**
+ * @file NetworkTimer.cpp
+ * @brief Implementation of the shared background timer
+ */
+
+#include "NetworkTimer.hpp"
+#include <algorithm>
+
+// Initialize static members
+std::mutex NetworkTimer::timerMutex;
+std::condition_variable NetworkTimer::wakeup;
+std::thread NetworkTimer::thread;
+std::vector<NetworkTimer::Due> NetworkTimer::heap;
+std::map<NetworkTimer::TaskId, NetworkTimer::Task> NetworkTimer::tasks;
+NetworkTimer::TaskId NetworkTimer::nextId = 1;
+NetworkTimer::TaskId NetworkTimer::runningId = 0;
+uint64_t NetworkTimer::generation = 0;
+
+static thread_local bool onTimerThread = false;
+
+NetworkTimer::TaskId NetworkTimer::Schedule(std::chrono::milliseconds delay, std::function<void()> task) {
+    return Add(delay, std::chrono::milliseconds(0), std::move(task));
+}
+
+NetworkTimer::TaskId NetworkTimer::ScheduleEvery(
+    std::chrono::milliseconds firstDelay,
+    std::chrono::milliseconds interval,
+    std::function<void()> task
+) {
+    return Add(firstDelay, std::max(interval, std::chrono::milliseconds(1)), std::move(task));
+}
+
+NetworkTimer::TaskId NetworkTimer::Add(
+    std::chrono::milliseconds delay,
+    std::chrono::milliseconds interval,
+    std::function<void()> task
+) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    TaskId id = nextId++;
+    tasks[id] = Task{ std::move(task), interval };
+
+    Due due{ std::chrono::steady_clock::now() + delay, id };
+    heap.push_back(due);
+    std::push_heap(heap.begin(), heap.end(), std::greater<>());
+
+    if (!thread.joinable()) {
+        thread = std::thread(&NetworkTimer::Run, generation);
+    }
+    else if (heap.front().id == id) {
+        wakeup.notify_all();  // New earliest task
+    }
+    return id;
+}
+
+bool NetworkTimer::Cancel(TaskId id) {
+    std::unique_lock<std::mutex> lock(timerMutex);
+    bool scheduled = tasks.erase(id) > 0;
+    if (runningId == id && !onTimerThread) {
+        wakeup.wait(lock, [id]() { return runningId != id; });
+    }
+    return scheduled;
+}
+
+void NetworkTimer::Shutdown() {
+    std::thread worker;
+    {
+        std::lock_guard<std::mutex> lock(timerMutex);
+        generation++;
+        tasks.clear();
+        heap.clear();
+        worker = std::move(thread);
+    }
+    wakeup.notify_all();
+
+    if (worker.joinable()) {
+        if (onTimerThread) {
+            worker.detach();  // Shut down from within a task
+        }
+        else {
+            worker.join();
+        }
+    }
+}
+
+/**
+ * @brief Timer thread: sleeps until the earliest task is due, runs it and reschedules periodic ones
+ */
+void NetworkTimer::Run(uint64_t runGeneration) {
+    onTimerThread = true;
+    std::unique_lock<std::mutex> lock(timerMutex);
+    while (generation == runGeneration) {
+        if (heap.empty()) {
+            wakeup.wait(lock);
+            continue;
+        }
+
+        Due next = heap.front();
+        auto it = tasks.find(next.id);
+        if (it == tasks.end()) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+            heap.pop_back();  // Cancelled
+            continue;
+        }
+        if (std::chrono::steady_clock::now() < next.time) {
+            wakeup.wait_until(lock, next.time);
+            continue;
+        }
+
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        heap.pop_back();
+        std::function<void()> callback = it->second.callback;
+        std::chrono::milliseconds interval = it->second.interval;
+        if (interval.count() == 0) {
+            tasks.erase(it);
+        }
+
+        runningId = next.id;
+        lock.unlock();
+        callback();
+        lock.lock();
+        runningId = 0;
+
+        if (interval.count() > 0 && generation == runGeneration && tasks.count(next.id)) {
+            heap.push_back(Due{ std::chrono::steady_clock::now() + interval, next.id });
+            std::push_heap(heap.begin(), heap.end(), std::greater<>());
+        }
+        wakeup.notify_all();  // Releases Cancel calls waiting for this task
+    }
+}
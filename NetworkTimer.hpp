@@ -0,0 +1,93 @@
+/**
+ * @file NetworkTimer.hpp
+ * @brief Shared background timer for the Network library
+ *
+ * One thread serves every scheduled task from a min-heap ordered by due time,
+ * so periodic work such as health probes costs one thread in total rather than
+ * one per endpoint. The thread starts with the first scheduled task.
+ *
+ * Tasks run on the timer thread one at a time and delay each other, so they
+ * should be short or bounded by a timeout.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_TIMER_HPP
+#define NETWORK_TIMER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Process-wide timer thread
+ */
+class NetworkTimer {
+public:
+    using TaskId = uint64_t;                                    ///< Identifies a scheduled task; 0 is never used
+
+    /**
+     * @brief Run a task once after a delay
+     * @param delay Time until the task runs
+     * @param task Callback, run on the timer thread
+     * @return Id for Cancel
+     */
+    static TaskId Schedule(std::chrono::milliseconds delay, std::function<void()> task);
+
+    /**
+     * @brief Run a task repeatedly
+     * @param firstDelay Time until the first run
+     * @param interval Time between the end of one run and the start of the next
+     * @param task Callback, run on the timer thread
+     * @return Id for Cancel
+     */
+    static TaskId ScheduleEvery(std::chrono::milliseconds firstDelay, std::chrono::milliseconds interval, std::function<void()> task);
+
+    /**
+     * @brief Stop a task from running again
+     *
+     * If the task is running on the timer thread, waits for it to finish unless
+     * called from the task itself.
+     *
+     * @param id Task to cancel
+     * @return true if the task was still scheduled
+     */
+    static bool Cancel(TaskId id);
+
+    /**
+     * @brief Cancel every task and stop the timer thread (called by Network::Cleanup)
+     */
+    static void Shutdown();
+
+private:
+    struct Task {
+        std::function<void()> callback;
+        std::chrono::milliseconds interval{0};                  // 0 for one-shot tasks
+    };
+
+    struct Due {
+        std::chrono::steady_clock::time_point time;
+        TaskId id;
+        bool operator>(const Due& other) const { return time > other.time; }
+    };
+
+    static TaskId Add(std::chrono::milliseconds delay, std::chrono::milliseconds interval, std::function<void()> task);
+    static void Run(uint64_t runGeneration);
+
+    static std::mutex timerMutex;
+    static std::condition_variable wakeup;                      ///< Signalled on new earliest task, finished task or shutdown
+    static std::thread thread;
+    static std::vector<Due> heap;                               ///< Min-heap on due time; cancelled ids are skipped when popped
+    static std::map<TaskId, Task> tasks;                        ///< Scheduled tasks by id
+    static TaskId nextId;
+    static TaskId runningId;                                    ///< Task executing right now, 0 if none
+    static uint64_t generation;                                 ///< Bumped by Shutdown; the timer thread exits when it changes
+};
+
+#endif // NETWORK_TIMER_HPP
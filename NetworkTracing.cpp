@@ -0,0 +1,213 @@
+/**
+ * @file NetworkTracing.cpp
+ * @brief Implementation of the W3C trace hook and hook registration
+ */
+
+#include "NetworkTracing.hpp"
+#include <algorithm>
+#include <cctype>
+#include <random>
+
+// Initialize static members
+std::shared_ptr<TraceHook> NetworkTracing::hook;
+
+/**
+ * @brief Fills a buffer with random bytes from a per-thread generator
+ */
+static void RandomBytes(uint8_t* data, size_t size) {
+    thread_local std::mt19937_64 generator(std::random_device{}());
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t value = generator();
+        for (size_t j = 0; j < 8 && i + j < size; j++) {
+            data[i + j] = static_cast<uint8_t>(value >> (j * 8));
+        }
+    }
+}
+
+/**
+ * @brief Generates a non-zero random id, as W3C Trace Context requires
+ */
+template<size_t N>
+static void RandomId(std::array<uint8_t, N>& id) {
+    do {
+        RandomBytes(id.data(), N);
+    } while (std::all_of(id.begin(), id.end(), [](uint8_t b) { return b == 0; }));
+}
+
+template<size_t N>
+static std::string ToHex(const std::array<uint8_t, N>& bytes) {
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string hex(N * 2, '0');
+    for (size_t i = 0; i < N; i++) {
+        hex[i * 2] = hexDigits[bytes[i] >> 4];
+        hex[i * 2 + 1] = hexDigits[bytes[i] & 0x0f];
+    }
+    return hex;
+}
+
+static int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;  // W3C requires lowercase hex
+}
+
+template<size_t N>
+static bool FromHex(const std::string& hex, size_t offset, std::array<uint8_t, N>& bytes) {
+    bool nonZero = false;
+    for (size_t i = 0; i < N; i++) {
+        int high = HexValue(hex[offset + i * 2]);
+        int low = HexValue(hex[offset + i * 2 + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        bytes[i] = static_cast<uint8_t>((high << 4) | low);
+        nonZero |= bytes[i] != 0;
+    }
+    return nonZero;
+}
+
+/**
+ * @brief Finds a header by case-insensitive name
+ */
+static std::map<std::string, std::string>::iterator FindHeader(
+    std::map<std::string, std::string>& headers,
+    const char* name
+) {
+    for (auto it = headers.begin(); it != headers.end(); ++it) {
+        const std::string& key = it->first;
+        size_t i = 0;
+        for (; name[i] && i < key.size(); i++) {
+            if (std::tolower(static_cast<unsigned char>(key[i])) != name[i]) {
+                break;
+            }
+        }
+        if (!name[i] && i == key.size()) {
+            return it;
+        }
+    }
+    return headers.end();
+}
+
+W3CTraceHook::W3CTraceHook(size_t capacity, std::string traceState)
+    : spans(capacity), defaultTraceState(std::move(traceState)) {
+}
+
+/**
+ * @brief Starts or continues a trace and injects the propagation headers
+ */
+void W3CTraceHook::OnRequestStart(
+    RequestTrace& trace,
+    Network::Method,
+    const std::string&,
+    std::map<std::string, std::string>& headers
+) {
+    trace.start_time = std::chrono::system_clock::now();
+
+    auto parent = FindHeader(headers, "traceparent");
+    if (parent != headers.end() && ParseTraceParent(parent->second, trace)) {
+        trace.has_parent = true;
+        headers.erase(parent);
+    }
+    else {
+        RandomId(trace.trace_id);
+        trace.has_parent = false;
+        trace.trace_flags = 0x01;
+    }
+    RandomId(trace.span_id);
+
+    auto state = FindHeader(headers, "tracestate");
+    if (state != headers.end()) {
+        trace.trace_state = state->second;
+        headers.erase(state);
+    }
+    else {
+        trace.trace_state = defaultTraceState;
+    }
+
+    headers["traceparent"] = FormatTraceParent(trace);
+    if (!trace.trace_state.empty()) {
+        headers["tracestate"] = trace.trace_state;
+    }
+}
+
+/**
+ * @brief Records the finished span into the ring, dropping it if the ring is full
+ */
+void W3CTraceHook::OnRequestEnd(
+    RequestTrace& trace,
+    Network::Method method,
+    const std::string& url,
+    const Network::NetworkResponse& response
+) {
+    TraceSpan span;
+    span.trace_id = ToHex(trace.trace_id);
+    span.span_id = ToHex(trace.span_id);
+    if (trace.has_parent) {
+        span.parent_span_id = ToHex(trace.parent_span_id);
+    }
+
+    size_t hostStart = url.find("://");
+    hostStart = (hostStart == std::string::npos) ? 0 : hostStart + 3;
+    size_t hostEnd = url.find('/', hostStart);
+    span.name = std::string(Network::MethodName(method)) + " " + url.substr(hostStart, hostEnd - hostStart);
+    span.url = url;
+    span.start_time = trace.start_time;
+    span.timings = response.timings;
+    span.status_code = response.status_code;
+    span.error_type = response.error_type;
+
+    if (!spans.TryPush(std::move(span))) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+size_t W3CTraceHook::Drain(std::vector<TraceSpan>& out, size_t maxSpans) {
+    size_t drained = 0;
+    TraceSpan span;
+    while (drained < maxSpans && spans.TryPop(span)) {
+        out.push_back(std::move(span));
+        drained++;
+    }
+    return drained;
+}
+
+std::string W3CTraceHook::FormatTraceParent(const RequestTrace& trace) {
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string value = "00-" + ToHex(trace.trace_id) + "-" + ToHex(trace.span_id) + "-";
+    value += hexDigits[trace.trace_flags >> 4];
+    value += hexDigits[trace.trace_flags & 0x0f];
+    return value;
+}
+
+bool W3CTraceHook::ParseTraceParent(const std::string& value, RequestTrace& trace) {
+    // 00-<32 hex trace-id>-<16 hex parent-id>-<2 hex flags>
+    if (value.size() != 55 || value.compare(0, 3, "00-") != 0 || value[35] != '-' || value[52] != '-') {
+        return false;
+    }
+
+    std::array<uint8_t, 16> traceId;
+    std::array<uint8_t, 8> parentId;
+    int flagsHigh = HexValue(value[53]);
+    int flagsLow = HexValue(value[54]);
+    if (!FromHex(value, 3, traceId) || !FromHex(value, 36, parentId) || flagsHigh < 0 || flagsLow < 0) {
+        return false;
+    }
+
+    trace.trace_id = traceId;
+    trace.parent_span_id = parentId;
+    trace.trace_flags = static_cast<uint8_t>((flagsHigh << 4) | flagsLow);
+    return true;
+}
+
+/**
+ * @brief Installs the global trace hook
+ *
+ * @param newHook Hook to install, or nullptr to remove the current one
+ */
+void NetworkTracing::SetHook(std::shared_ptr<TraceHook> newHook) {
+    std::atomic_store(&hook, std::move(newHook));
+}
+
+std::shared_ptr<TraceHook> NetworkTracing::GetHook() {
+    return std::atomic_load(&hook);
+}
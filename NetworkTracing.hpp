@@ -0,0 +1,211 @@
+/**
+ * @file NetworkTracing.hpp
+ * @brief Distributed tracing hooks for the Network library
+ *
+ * A TraceHook is invoked when a request starts, at every phase boundary reported
+ * by WinHTTP, and on completion. The bundled W3CTraceHook injects `traceparent`
+ * and `tracestate` headers and records finished spans into a lock-free ring for
+ * an exporter to drain.
+ *
+ * Tracing is a compile-time feature: build the library with
+ * NETWORK_ENABLE_TRACING=1 to compile the hook calls into Network::Request.
+ * Without it the calls are not compiled at all and SetHook has no effect.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_TRACING_HPP
+#define NETWORK_TRACING_HPP
+
+#ifndef NETWORK_ENABLE_TRACING
+#define NETWORK_ENABLE_TRACING 0
+#endif
+
+#include "Network.hpp"
+#include "NetworkQueue.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Request phase boundaries reported to trace hooks
+ */
+enum class TracePhase {
+    RateLimited,                                                ///< Rate limit check passed
+    DnsStart,                                                   ///< Name resolution started
+    DnsEnd,                                                     ///< Name resolved
+    ConnectStart,                                               ///< TCP connect started
+    ConnectEnd,                                                 ///< TCP connection established
+    SendStart,                                                  ///< Request sending started (after TLS)
+    RequestSent,                                                ///< Request fully sent
+    FirstByte,                                                  ///< First response byte received
+    LastByte                                                    ///< Last body byte received
+};
+
+/**
+ * @brief Per-request trace context shared by all hook calls of one request
+ */
+struct RequestTrace {
+    std::array<uint8_t, 16> trace_id{};                         ///< W3C trace-id
+    std::array<uint8_t, 8> span_id{};                           ///< Span id of this request
+    std::array<uint8_t, 8> parent_span_id{};                    ///< Caller's span id, if any
+    bool has_parent = false;                                    ///< Whether the caller supplied a traceparent
+    uint8_t trace_flags = 0x01;                                 ///< W3C trace-flags (0x01 = sampled)
+    std::string trace_state;                                    ///< tracestate sent with the request
+    std::chrono::system_clock::time_point start_time;           ///< Wall-clock start for export
+    void* user_data = nullptr;                                  ///< Free for custom hooks
+};
+
+/**
+ * @brief Interface invoked by Network::Request around every request
+ */
+class TraceHook {
+public:
+    virtual ~TraceHook() = default;
+
+    /**
+     * @brief Called before the request is sent
+     * @param trace Per-request context to fill in
+     * @param method HTTP method
+     * @param url Target URL
+     * @param headers Outgoing headers; hooks may add propagation headers
+     */
+    virtual void OnRequestStart(
+        RequestTrace& trace,
+        Network::Method method,
+        const std::string& url,
+        std::map<std::string, std::string>& headers
+    ) = 0;
+
+    /**
+     * @brief Called at each phase boundary, on the requesting thread
+     * @param trace Per-request context
+     * @param phase Phase that just ended or started
+     * @param at Monotonic time of the boundary
+     */
+    virtual void OnPhase(RequestTrace& /*trace*/, TracePhase /*phase*/, std::chrono::steady_clock::time_point /*at*/) {}
+
+    /**
+     * @brief Called once the request has completed or failed
+     * @param trace Per-request context
+     * @param method HTTP method
+     * @param url Target URL
+     * @param response Completed response, including timings
+     */
+    virtual void OnRequestEnd(
+        RequestTrace& trace,
+        Network::Method method,
+        const std::string& url,
+        const Network::NetworkResponse& response
+    ) = 0;
+};
+
+/**
+ * @brief Finished span as recorded by W3CTraceHook
+ */
+struct TraceSpan {
+    std::string trace_id;                                       ///< 32 hex digits
+    std::string span_id;                                        ///< 16 hex digits
+    std::string parent_span_id;                                 ///< 16 hex digits, empty for root spans
+    std::string name;                                           ///< "METHOD host"
+    std::string url;                                            ///< Target URL
+    std::chrono::system_clock::time_point start_time;           ///< Wall-clock start
+    Network::NetworkResponse::Timings timings;                  ///< Phase breakdown
+    int status_code = 0;                                        ///< HTTP status code
+    Network::ErrorType error_type = Network::ErrorType::None;   ///< Failure class
+};
+
+/**
+ * @brief Default hook: W3C Trace Context propagation plus span recording
+ *
+ * If the caller already set a `traceparent` header, the request becomes a child
+ * span of it and the caller's `tracestate` is forwarded; otherwise a new trace is
+ * started. Spans are pushed into a bounded lock-free ring and dropped (and
+ * counted) when the exporter falls behind.
+ */
+class W3CTraceHook : public TraceHook {
+public:
+    /**
+     * @brief Create the hook
+     * @param capacity Span ring capacity
+     * @param traceState tracestate to send when the caller provides none
+     */
+    explicit W3CTraceHook(size_t capacity = 4096, std::string traceState = "");
+
+    void OnRequestStart(
+        RequestTrace& trace,
+        Network::Method method,
+        const std::string& url,
+        std::map<std::string, std::string>& headers
+    ) override;
+
+    void OnRequestEnd(
+        RequestTrace& trace,
+        Network::Method method,
+        const std::string& url,
+        const Network::NetworkResponse& response
+    ) override;
+
+    /**
+     * @brief Move recorded spans out of the ring
+     * @param spans Output vector the spans are appended to
+     * @param maxSpans Maximum number of spans to drain
+     * @return Number of spans drained
+     */
+    size_t Drain(std::vector<TraceSpan>& spans, size_t maxSpans = SIZE_MAX);
+
+    /**
+     * @brief Number of spans dropped because the ring was full
+     */
+    uint64_t DroppedSpans() const { return dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Format a traceparent header value
+     * @param trace Trace context
+     * @return "00-<trace-id>-<span-id>-<flags>"
+     */
+    static std::string FormatTraceParent(const RequestTrace& trace);
+
+    /**
+     * @brief Parse a traceparent header value
+     * @param value Header value
+     * @param trace Receives trace-id, parent span id and flags
+     * @return true if the value is a valid version-00 traceparent
+     */
+    static bool ParseTraceParent(const std::string& value, RequestTrace& trace);
+
+private:
+    BoundedQueue<TraceSpan> spans;
+    std::string defaultTraceState;
+    std::atomic<uint64_t> dropped{0};
+};
+
+/**
+ * @brief Global trace hook registration
+ */
+class NetworkTracing {
+public:
+    static constexpr bool kEnabled = NETWORK_ENABLE_TRACING != 0;  ///< Whether hooks are compiled in
+
+    /**
+     * @brief Install the hook used by all requests (nullptr to remove)
+     * @param hook Hook to install
+     */
+    static void SetHook(std::shared_ptr<TraceHook> hook);
+
+    /**
+     * @brief Currently installed hook, or nullptr
+     */
+    static std::shared_ptr<TraceHook> GetHook();
+
+private:
+    static std::shared_ptr<TraceHook> hook;                     ///< Accessed with std::atomic_load/store
+};
+
+#endif // NETWORK_TRACING_HPP
@@ -0,0 +1,230 @@
+/**
+ * @file NetworkUnixSocket.cpp
+ * @brief Implementation of the Unix domain socket connection pool
+ */
+
+// winsock2.h must precede windows.h, which Network.hpp includes
+#include <winsock2.h>
+#include <afunix.h>
+
+#include "NetworkUnixSocket.hpp"
+#include "NetworkMetrics.hpp"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+
+#pragma comment(lib, "ws2_32.lib")
+
+// Initialize static members
+std::mutex NetworkUnixSocket::poolMutex;
+std::map<std::string, std::vector<uintptr_t>> NetworkUnixSocket::idle;
+size_t NetworkUnixSocket::maxIdlePerSocket = 32;
+uint64_t NetworkUnixSocket::opened = 0;
+uint64_t NetworkUnixSocket::reusedCount = 0;
+
+static void CloseSocket(uintptr_t socket) {
+    closesocket(static_cast<SOCKET>(socket));
+    NetworkMetrics::ConnectionClosed();
+}
+
+/**
+ * @brief Whether an idle socket was closed by the server (or sent something unasked)
+ *
+ * An idle HTTP/1.1 connection has nothing to read; readability means EOF or a
+ * stray response, and either way the connection cannot carry a new request.
+ */
+static bool IsStale(uintptr_t socket) {
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(static_cast<SOCKET>(socket), &readable);
+    timeval poll = { 0, 0 };
+    return select(0, &readable, nullptr, nullptr, &poll) != 0;
+}
+
+static void SetTimeouts(uintptr_t socket, int timeoutMs) {
+    DWORD timeout = timeoutMs > 0 ? static_cast<DWORD>(timeoutMs) : 0;
+    setsockopt(static_cast<SOCKET>(socket), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+    setsockopt(static_cast<SOCKET>(socket), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+
+NetworkUnixSocket::Connection::Connection(Connection&& other) noexcept
+    : socket(other.socket), path(std::move(other.path)), reused(other.reused), timedOut(other.timedOut) {
+    other.socket = kNoSocket;
+}
+
+NetworkUnixSocket::Connection& NetworkUnixSocket::Connection::operator=(Connection&& other) noexcept {
+    if (this != &other) {
+        Close();
+        socket = other.socket;
+        path = std::move(other.path);
+        reused = other.reused;
+        timedOut = other.timedOut;
+        other.socket = kNoSocket;
+    }
+    return *this;
+}
+
+NetworkUnixSocket::Connection::~Connection() {
+    Close();
+}
+
+void NetworkUnixSocket::Connection::Close() {
+    if (socket != kNoSocket) {
+        CloseSocket(socket);
+        socket = kNoSocket;
+    }
+}
+
+bool NetworkUnixSocket::Connection::Send(const char* data, size_t size) {
+    while (size > 0) {
+        int sent = send(static_cast<SOCKET>(socket), data, static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+        if (sent <= 0) {
+            timedOut = WSAGetLastError() == WSAETIMEDOUT;
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+int NetworkUnixSocket::Connection::Receive(char* buffer, size_t capacity) {
+    int received = recv(static_cast<SOCKET>(socket), buffer, static_cast<int>(std::min<size_t>(capacity, INT_MAX)), 0);
+    if (received < 0) {
+        timedOut = WSAGetLastError() == WSAETIMEDOUT;
+        return -1;
+    }
+    return received;
+}
+
+void NetworkUnixSocket::Connection::Release() {
+    if (socket == kNoSocket) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        auto& sockets = idle[path];
+        if (sockets.size() < maxIdlePerSocket) {
+            sockets.push_back(socket);
+            socket = kNoSocket;
+        }
+    }
+    Close();
+}
+
+std::string NetworkUnixSocket::SocketPath(const std::string& host) {
+    std::string path;
+    path.reserve(host.size());
+    for (size_t i = 0; i < host.size(); i++) {
+        if (host[i] == '%' && i + 2 < host.size() &&
+            std::isxdigit(static_cast<unsigned char>(host[i + 1])) && std::isxdigit(static_cast<unsigned char>(host[i + 2]))) {
+            path += static_cast<char>(std::stoi(host.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        }
+        else {
+            path += host[i];
+        }
+    }
+    return path;
+}
+
+/**
+ * @brief Reuses the most recently idled live connection, else connects
+ *
+ * Idle connections are taken most recent first, since those are the least
+ * likely to have been closed by the server; stale ones found on the way are
+ * closed.
+ */
+bool NetworkUnixSocket::Acquire(const std::string& path, int timeoutMs, bool allowPooled, Connection& connection, std::string& error) {
+    static const bool winsockReady = []() {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+
+    connection = Connection();
+    connection.path = path;
+
+    while (allowPooled) {
+        uintptr_t socket = Connection::kNoSocket;
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            auto it = idle.find(path);
+            if (it == idle.end() || it->second.empty()) {
+                break;
+            }
+            socket = it->second.back();
+            it->second.pop_back();
+        }
+        if (IsStale(socket)) {
+            CloseSocket(socket);
+            continue;
+        }
+        SetTimeouts(socket, timeoutMs);
+        connection.socket = socket;
+        connection.reused = true;
+        std::lock_guard<std::mutex> lock(poolMutex);
+        reusedCount++;
+        return true;
+    }
+
+    if (!winsockReady) {
+        error = "Winsock initialization failed";
+        return false;
+    }
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        error = "Invalid Unix socket path: " + path;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.data(), path.size());
+
+    SOCKET socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket == INVALID_SOCKET) {
+        error = "Failed to create Unix socket (requires Windows 10 1803 or later)";
+        return false;
+    }
+    if (connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        closesocket(socket);
+        error = "Failed to connect to Unix socket: " + path;
+        return false;
+    }
+    NetworkMetrics::ConnectionOpened();
+    SetTimeouts(socket, timeoutMs);
+    connection.socket = socket;
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    opened++;
+    return true;
+}
+
+void NetworkUnixSocket::SetMaxIdlePerSocket(size_t connections) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    maxIdlePerSocket = connections;
+}
+
+void NetworkUnixSocket::CloseIdle() {
+    std::map<std::string, std::vector<uintptr_t>> closing;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        closing.swap(idle);
+    }
+    for (const auto& [path, sockets] : closing) {
+        for (uintptr_t socket : sockets) {
+            CloseSocket(socket);
+        }
+    }
+}
+
+NetworkUnixSocket::Stats NetworkUnixSocket::GetStats() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    Stats stats;
+    for (const auto& [path, sockets] : idle) {
+        stats.idle_connections += sockets.size();
+    }
+    stats.connections_opened = opened;
+    stats.connections_reused = reusedCount;
+    return stats;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file NetworkUnixSocket.hpp
+ * @brief Unix domain socket transport for local sidecars
+ *
+ * WinHTTP only connects over TCP. Requests to a `http+unix://` URL are sent
+ * by Network itself, as HTTP/1.1 over an AF_UNIX stream socket taken from
+ * the pool kept here, which skips the TCP/IP stack of the loopback path.
+ *
+ * The socket path is the URL's host, percent-encoded, as with Docker's and
+ * requests-unixsocket's URLs; `unix://` is accepted as an alias:
+ *
+ * @code
+ * auto response = Network::Get("http+unix://%2Fvar%2Frun%2Fsidecar.sock/v1/health");
+ * auto config = Network::Get("http+unix://C:%5CProgramData%5Cmesh%5Cproxy.sock/config");
+ * @endcode
+ *
+ * Connections are kept alive and reused like WinHTTP's pooled connections:
+ * one that the server closed while idle is detected before reuse. AF_UNIX
+ * needs Windows 10 1803 or later.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef NETWORK_UNIX_SOCKET_HPP
+#define NETWORK_UNIX_SOCKET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Pool of AF_UNIX connections keyed by socket path
+ */
+class NetworkUnixSocket {
+public:
+    /**
+     * @brief Pool counters
+     */
+    struct Stats {
+        size_t idle_connections = 0;                            ///< Connections waiting in the pool
+        uint64_t connections_opened = 0;                        ///< Connections established
+        uint64_t connections_reused = 0;                        ///< Requests sent on a pooled connection
+    };
+
+    /**
+     * @brief One connection, closed on destruction unless released to the pool
+     */
+    class Connection {
+    public:
+        Connection() = default;
+        Connection(Connection&& other) noexcept;
+        Connection& operator=(Connection&& other) noexcept;
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+        ~Connection();
+
+        explicit operator bool() const { return socket != kNoSocket; }
+        bool Reused() const { return reused; }                  ///< Taken from the pool rather than opened
+        bool TimedOut() const { return timedOut; }              ///< The last failed call hit the timeout
+
+        /**
+         * @brief Send all bytes
+         * @return false if the connection failed or timed out
+         */
+        bool Send(const char* data, size_t size);
+
+        /**
+         * @brief Receive up to capacity bytes
+         * @return Bytes received, 0 if the peer closed the connection, -1 on error or timeout
+         */
+        int Receive(char* buffer, size_t capacity);
+
+        /**
+         * @brief Return the connection to the pool for the next request to the same socket
+         */
+        void Release();
+
+    private:
+        friend class NetworkUnixSocket;
+        static const uintptr_t kNoSocket = ~static_cast<uintptr_t>(0);
+
+        void Close();
+
+        uintptr_t socket = kNoSocket;                           // SOCKET, kept opaque so winsock2.h stays out of this header
+        std::string path;
+        bool reused = false;
+        bool timedOut = false;
+    };
+
+    /**
+     * @brief Whether a URL protocol selects this transport ("http+unix" or "unix")
+     */
+    static bool IsUnixScheme(const std::string& protocol) { return protocol == "http+unix" || protocol == "unix"; }
+
+    /**
+     * @brief Socket path encoded in a URL host
+     * @param host Percent-encoded socket path
+     * @return Decoded path
+     */
+    static std::string SocketPath(const std::string& host);
+
+    /**
+     * @brief Take an idle connection to a socket, or open a new one
+     * @param path Socket path
+     * @param timeoutMs Send and receive timeout (0 = none)
+     * @param allowPooled Whether an idle connection may be used
+     * @param connection Receives the connection
+     * @param error Receives the reason on failure
+     * @return false if the socket could not be connected
+     */
+    static bool Acquire(const std::string& path, int timeoutMs, bool allowPooled, Connection& connection, std::string& error);
+
+    /**
+     * @brief Set how many idle connections are kept per socket
+     * @param connections Idle connections kept (default 32)
+     */
+    static void SetMaxIdlePerSocket(size_t connections);
+
+    /**
+     * @brief Close every idle connection
+     */
+    static void CloseIdle();
+
+    static Stats GetStats();
+
+private:
+    static std::mutex poolMutex;
+    static std::map<std::string, std::vector<uintptr_t>> idle;  ///< Idle sockets per path, most recent last
+    static size_t maxIdlePerSocket;
+    static uint64_t opened;
+    static uint64_t reusedCount;
+};
+
+#endif // NETWORK_UNIX_SOCKET_HPP
@@ -0,0 +1,134 @@
+/**
+ * @file adaptive_limit_benchmark.cpp
+ * @brief NetworkLimiter against a loopback server whose capacity changes mid-test
+ *
+ * The server processes a limited number of requests at once and queues the
+ * rest, so its latency rises when it is overloaded. Its capacity starts at 8,
+ * rises to 32 and then drops to 4 while 64 workers send requests as fast as
+ * they can. The run is repeated with adaptive limits off and on; each line
+ * reports the host limit, throughput, latency and rejections of one interval.
+ *
+ * Build: link with Network.cpp, NetworkLimiter.cpp, NetworkScheduler.cpp and NetworkMetrics.cpp
+ */
+
+// Must precede Network.hpp so that winsock2.h is included before windows.h
+#include "loopback_server.hpp"
+
+#include "Network.hpp"
+#include "NetworkLimiter.hpp"
+#include "NetworkMetrics.hpp"
+#include "NetworkScheduler.hpp"
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const int kWorkers = 64;
+static const int kServiceTimeMs = 10;
+static const int kIntervalMs = 500;
+static const int kIntervalsPerPhase = 6;
+static const int kCapacities[] = { 8, 32, 4 };
+
+static void runTest(const std::string& name, LoopbackServer& server, const std::string& url) {
+    std::cout << "\n" << name << std::endl;
+    std::cout << std::setw(8) << "time s" << std::setw(10) << "capacity" << std::setw(10) << "limit"
+              << std::setw(10) << "req/s" << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms"
+              << std::setw(10) << "rejected" << std::endl;
+
+    std::mutex histogramMutex;
+    LatencyHistogram interval;
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<bool> stop{false};
+
+    server.SetCapacity(kCapacities[0]);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < kWorkers; i++) {
+        workers.emplace_back([&]() {
+            while (!stop.load()) {
+                auto response = Network::Get(url);
+                if (response.error_type == Network::ErrorType::ResourceLimit) {
+                    rejected++;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
+                }
+                uint64_t micros = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(response.timings.Total()).count());
+                std::lock_guard<std::mutex> lock(histogramMutex);
+                interval.Record(micros);
+                completed++;
+            }
+        });
+    }
+
+    int tick = 0;
+    for (int capacity : kCapacities) {
+        server.SetCapacity(capacity);
+        for (int i = 0; i < kIntervalsPerPhase; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(kIntervalMs));
+            tick++;
+
+            LatencyHistogram snapshot;
+            {
+                std::lock_guard<std::mutex> lock(histogramMutex);
+                snapshot = interval;
+                interval = LatencyHistogram();
+            }
+            double limit = 0.0;
+            for (const auto& host : NetworkLimiter::GetStats()) {
+                limit = host.limit;
+            }
+
+            std::cout << std::fixed << std::setprecision(1)
+                      << std::setw(8) << tick * kIntervalMs / 1000.0
+                      << std::setw(10) << capacity
+                      << std::setw(10) << limit
+                      << std::setw(10) << completed.exchange(0) * 1000.0 / kIntervalMs
+                      << std::setw(10) << snapshot.Percentile(0.50) / 1000.0
+                      << std::setw(10) << snapshot.Percentile(0.99) / 1000.0
+                      << std::setw(10) << rejected.exchange(0) << std::endl;
+        }
+    }
+
+    stop = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int main() {
+    LoopbackServer::Options options;
+    options.body_size = 256;
+    options.latency_ms = kServiceTimeMs;
+    LoopbackServer server(options);
+    if (!server.Start()) {
+        std::cerr << "Failed to start loopback server" << std::endl;
+        return 1;
+    }
+    if (!Network::Initialize()) {
+        std::cerr << "Failed to initialize network" << std::endl;
+        return 1;
+    }
+
+    // Let every worker reach the limiter rather than queue in the scheduler
+    NetworkScheduler::SetMaxConcurrency(kWorkers);
+
+    std::string url = "http://127.0.0.1:" + std::to_string(server.Port()) + "/";
+    std::cout << "=== Adaptive Concurrency Benchmark ===" << std::endl;
+    std::cout << kWorkers << " workers, " << kServiceTimeMs << "ms service time; capacity 8 -> 32 -> 4" << std::endl;
+
+    runTest("Static (limiter disabled)", server, url);
+
+    NetworkLimiter::Options limiterOptions;
+    limiterOptions.queue_timeout_ms = 1000;
+    NetworkLimiter::Enable(limiterOptions);
+    runTest("Adaptive", server, url);
+    NetworkLimiter::Disable();
+
+    Network::Cleanup();
+    server.Stop();
+    return 0;
+}
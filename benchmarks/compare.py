@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""Compare two benchmark JSON files and flag regressions.
+
+Works with the output of encoding_benchmark --json and with Google Benchmark's
+--benchmark_out JSON. Benchmarks are matched by name; aggregate rows (mean,
+median, stddev) are ignored except for the median, which replaces its
+iteration rows when present.
+
+Usage: compare.py BASELINE.json CONTENDER.json [--threshold PERCENT] [--metric real_time|cpu_time]
+
+Exits with status 1 if any benchmark got slower by more than the threshold.
+"""
+
+import argparse
+import json
+import sys
+
+TIME_UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    with open(path) as f:
+        data = json.load(f)
+
+    times = {}
+    medians = {}
+    for bench in data.get("benchmarks", []):
+        value = bench[metric] * TIME_UNITS.get(bench.get("time_unit", "ns"), 1.0)
+        if bench.get("run_type") == "aggregate":
+            if bench.get("aggregate_name") == "median":
+                medians[bench.get("run_name", bench["name"])] = value
+            continue
+        # Repeated runs without aggregates: keep the fastest
+        name = bench["name"]
+        times[name] = min(value, times.get(name, value))
+    times.update(medians)
+    return times
+
+
+def format_ns(value):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if value >= scale:
+            return "%.2f %s" % (value / scale, unit)
+    return "%.1f ns" % value
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flag benchmark regressions between two runs")
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="percent slowdown that counts as a regression (default 5)")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="real_time")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline, args.metric)
+    contender = load(args.contender, args.metric)
+
+    names = [name for name in baseline if name in contender]
+    width = max([len(name) for name in names] + [9])
+    print("%-*s %14s %14s %9s" % (width, "Benchmark", "Baseline", "Contender", "Change"))
+    print("-" * (width + 40))
+
+    regressions = []
+    for name in names:
+        before, after = baseline[name], contender[name]
+        change = (after - before) / before * 100.0 if before > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions.append(name)
+        elif change < -args.threshold:
+            flag = "  improved"
+        print("%-*s %14s %14s %+8.1f%%%s" % (width, name, format_ns(before), format_ns(after), change, flag))
+
+    for name in sorted(set(baseline) ^ set(contender)):
+        side = "baseline" if name in baseline else "contender"
+        print("%-*s only in %s" % (width, name, side))
+
+    if regressions:
+        print("\n%d regression(s) above %.1f%%" % (len(regressions), args.threshold))
+        return 1
+    print("\nNo regressions above %.1f%%" % args.threshold)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,135 @@
+/**
+ * @file consistent_hash_benchmark.cpp
+ * @brief Measures Maglev routing in NetworkLoadBalancer
+ *
+ * Reports, for several endpoint counts:
+ *  - lookup cost of NetworkLoadBalancer::Acquire with Maglev routing versus
+ *    power-of-two-choices,
+ *  - how evenly keys spread over the endpoints,
+ *  - the share of keys that move when an endpoint is added or removed,
+ *    against the ideal 1/N.
+ *
+ * No requests are sent; endpoints are never contacted.
+ *
+ * Build: link with Network.cpp and NetworkLoadBalancer.cpp
+ */
+
+#include "NetworkLoadBalancer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static const int kKeys = 200000;
+static const int kLookups = 2000000;
+
+static std::vector<std::string> makeEndpoints(int count, int skip = -1) {
+    std::vector<std::string> endpoints;
+    for (int i = 0; i < count; i++) {
+        if (i != skip) {
+            endpoints.push_back("http://10.0." + std::to_string(i / 256) + "." + std::to_string(i % 256) + ":8080");
+        }
+    }
+    return endpoints;
+}
+
+static void registerService(const std::vector<std::string>& endpoints, NetworkLoadBalancer::RoutingPolicy policy) {
+    NetworkLoadBalancer::ServiceConfig config;
+    config.policy = policy;
+    NetworkLoadBalancer::RegisterService("cache", endpoints, config);
+}
+
+/**
+ * @brief Endpoint host chosen for each key
+ */
+static std::vector<std::string> route(const std::vector<std::string>& keys) {
+    std::vector<std::string> hosts;
+    hosts.reserve(keys.size());
+    for (const auto& key : keys) {
+        auto lease = NetworkLoadBalancer::Acquire("cache", key);
+        hosts.push_back(lease.Host());
+    }
+    return hosts;
+}
+
+static double movedShare(const std::vector<std::string>& before, const std::vector<std::string>& after) {
+    size_t moved = 0;
+    for (size_t i = 0; i < before.size(); i++) {
+        if (before[i] != after[i]) {
+            moved++;
+        }
+    }
+    return 100.0 * moved / before.size();
+}
+
+static double lookupNanos(const std::vector<std::string>& keys, bool withKey) {
+    static const std::string noKey;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kLookups; i++) {
+        auto lease = NetworkLoadBalancer::Acquire("cache", withKey ? keys[i % keys.size()] : noKey);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / kLookups;
+}
+
+int main() {
+    using Policy = NetworkLoadBalancer::RoutingPolicy;
+
+    std::cout << "=== Consistent Hash Routing Benchmark ===" << std::endl;
+    std::cout << kKeys << " keys, " << kLookups << " lookups per measurement\n" << std::endl;
+
+    std::vector<std::string> keys;
+    keys.reserve(kKeys);
+    for (int i = 0; i < kKeys; i++) {
+        keys.push_back("user:" + std::to_string(i * 7919));
+    }
+
+    std::cout << std::left << std::setw(10) << "Endpoints"
+              << std::right << std::setw(12) << "Maglev ns" << std::setw(12) << "P2C ns"
+              << std::setw(12) << "Min share" << std::setw(12) << "Max share"
+              << std::setw(12) << "Add moved" << std::setw(12) << "Del moved" << std::setw(10) << "Ideal" << std::endl;
+
+    for (int count : { 3, 10, 50, 200 }) {
+        auto endpoints = makeEndpoints(count);
+
+        registerService(endpoints, Policy::PowerOfTwoChoices);
+        double p2cNanos = lookupNanos(keys, false);
+
+        registerService(endpoints, Policy::Maglev);
+        double maglevNanos = lookupNanos(keys, true);
+        auto base = route(keys);
+
+        std::vector<std::string> sorted = base;
+        std::sort(sorted.begin(), sorted.end());
+        size_t minRun = sorted.size(), maxRun = 0;
+        for (size_t i = 0; i < sorted.size();) {
+            size_t j = i;
+            while (j < sorted.size() && sorted[j] == sorted[i]) j++;
+            minRun = std::min(minRun, j - i);
+            maxRun = std::max(maxRun, j - i);
+            i = j;
+        }
+        double fair = static_cast<double>(kKeys) / count;
+
+        registerService(makeEndpoints(count + 1), Policy::Maglev);
+        double added = movedShare(base, route(keys));
+
+        registerService(makeEndpoints(count, count / 2), Policy::Maglev);
+        double removed = movedShare(base, route(keys));
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::left << std::setw(10) << count
+                  << std::right << std::setw(12) << maglevNanos << std::setw(12) << p2cNanos
+                  << std::setw(11) << 100.0 * minRun / fair << "%" << std::setw(11) << 100.0 * maxRun / fair << "%"
+                  << std::setw(11) << added << "%" << std::setw(11) << removed << "%"
+                  << std::setw(9) << 100.0 / (count + 1) << "%" << std::endl;
+    }
+
+    std::cout << "\nShares are relative to an even split; moved is the share of keys whose endpoint changed." << std::endl;
+    std::cout << "Ideal is 1/(N+1) when adding; removing one endpoint ideally moves 1/N." << std::endl;
+
+    NetworkLoadBalancer::UnregisterService("cache");
+    return 0;
+}
@@ -0,0 +1,267 @@
+/**
+ * @file encoding_benchmark.cpp
+ * @brief Microbenchmarks for URL parsing, encoding and response header parsing
+ *
+ * Covers Network::ParseUrl, UrlEncode, Base64Encode and ParseResponseHeaders
+ * across input sizes and character distributions. Each benchmark is calibrated
+ * to run for at least --min-time seconds and repeated; the median repetition
+ * is reported.
+ *
+ * Usage: encoding_benchmark [--filter SUBSTRING] [--min-time S] [--repetitions N] [--json FILE]
+ *
+ * --json writes results in Google Benchmark's JSON layout, so compare.py works
+ * on these results and on Google Benchmark output alike:
+ *
+ *   encoding_benchmark --json before.json
+ *   (apply change, rebuild)
+ *   encoding_benchmark --json after.json
+ *   python benchmarks/compare.py before.json after.json
+ *
+ * Build: link with Network.cpp and NetworkMetrics.cpp
+ */
+
+#include "Network.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BenchmarkResult {
+    std::string name;
+    uint64_t iterations = 0;
+    double ns_per_op = 0.0;
+    double bytes_per_second = 0.0;
+};
+
+struct BenchmarkOptions {
+    std::string filter;
+    double min_time = 0.2;
+    int repetitions = 5;
+    std::string json_path;
+};
+
+// Keeps results alive so the optimizer cannot drop the measured call
+static volatile size_t sink;
+
+/**
+ * @brief Runs one benchmark: calibrates an iteration count, then reports the median repetition
+ */
+static BenchmarkResult runBenchmark(
+    const std::string& name,
+    size_t bytesPerOp,
+    const BenchmarkOptions& options,
+    const std::function<size_t()>& body
+) {
+    using Clock = std::chrono::steady_clock;
+    auto timeIterations = [&](uint64_t iterations) {
+        size_t total = 0;
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            total += body();
+        }
+        sink = total;
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    // Grow the iteration count until one repetition takes at least min_time
+    uint64_t iterations = 1;
+    double elapsed = timeIterations(iterations);
+    while (elapsed < options.min_time && iterations < (1ull << 40)) {
+        double scale = (elapsed > 0.0) ? options.min_time * 1.2 / elapsed : 10.0;
+        iterations = std::max<uint64_t>(iterations + 1, static_cast<uint64_t>(iterations * std::min(scale, 10.0)));
+        elapsed = timeIterations(iterations);
+    }
+
+    std::vector<double> samples;
+    for (int r = 0; r < options.repetitions; r++) {
+        samples.push_back(timeIterations(iterations) * 1e9 / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.ns_per_op = samples[samples.size() / 2];
+    result.bytes_per_second = bytesPerOp ? bytesPerOp * 1e9 / result.ns_per_op : 0.0;
+    return result;
+}
+
+/**
+ * @brief Generates reproducible input text from a character distribution
+ * @param distribution "alnum" (unreserved only), "mixed" (about a third reserved), "binary" (any byte)
+ */
+static std::string makeInput(const std::string& distribution, size_t size) {
+    static const char alnum[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_.~";
+    static const char reserved[] = " !\"#$%&'()*+,/:;=?@[]";
+    std::mt19937 random(static_cast<unsigned>(size * 31 + distribution.size()));
+    std::string input(size, '\0');
+    for (char& c : input) {
+        if (distribution == "binary") {
+            c = static_cast<char>(random() & 0xff);
+        }
+        else if (distribution == "mixed" && random() % 3 == 0) {
+            c = reserved[random() % (sizeof(reserved) - 1)];
+        }
+        else {
+            c = alnum[random() % (sizeof(alnum) - 1)];
+        }
+    }
+    return input;
+}
+
+/**
+ * @brief Builds a raw header block as WinHTTP returns it
+ */
+static std::wstring makeHeaders(int count, size_t valueSize) {
+    std::wstring raw = L"HTTP/1.1 200 OK\r\n";
+    for (int i = 0; i < count; i++) {
+        raw += L"X-Header-" + std::to_wstring(i) + L": " + std::wstring(valueSize, L'v') + L"\r\n";
+    }
+    raw += L"\r\n";
+    return raw;
+}
+
+static void printResult(const BenchmarkResult& result) {
+    std::cout << std::left << std::setw(44) << result.name << std::right
+              << std::setw(14) << std::fixed << std::setprecision(1) << result.ns_per_op << " ns"
+              << std::setw(14) << result.iterations;
+    if (result.bytes_per_second > 0.0) {
+        std::cout << std::setw(12) << std::setprecision(1) << result.bytes_per_second / (1024.0 * 1024.0) << " MB/s";
+    }
+    std::cout << std::endl;
+}
+
+static std::string jsonEscape(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+static bool writeJson(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"executable\": \"encoding_benchmark\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "\n"
+        << "  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        out << "    {\n"
+            << "      \"name\": \"" << jsonEscape(result.name) << "\",\n"
+            << "      \"run_type\": \"iteration\",\n"
+            << "      \"iterations\": " << result.iterations << ",\n"
+            << std::setprecision(3) << std::fixed
+            << "      \"real_time\": " << result.ns_per_op << ",\n"
+            << "      \"cpu_time\": " << result.ns_per_op << ",\n"
+            << "      \"time_unit\": \"ns\"";
+        if (result.bytes_per_second > 0.0) {
+            out << ",\n      \"bytes_per_second\": " << std::setprecision(0) << result.bytes_per_second;
+        }
+        out << "\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) options.filter = argv[++i];
+        else if (arg == "--min-time" && i + 1 < argc) options.min_time = std::atof(argv[++i]);
+        else if (arg == "--repetitions" && i + 1 < argc) options.repetitions = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc) options.json_path = argv[++i];
+        else {
+            std::cout << "Usage: encoding_benchmark [--filter SUBSTRING] [--min-time S] [--repetitions N] [--json FILE]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    auto run = [&](const std::string& name, size_t bytesPerOp, const std::function<size_t()>& body) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+            return;
+        }
+        results.push_back(runBenchmark(name, bytesPerOp, options, body));
+        printResult(results.back());
+    };
+
+    std::cout << std::left << std::setw(44) << "Benchmark" << std::right
+              << std::setw(17) << "Time" << std::setw(14) << "Iterations" << std::setw(17) << "Throughput" << std::endl;
+    std::cout << std::string(92, '-') << std::endl;
+
+    // UrlEncode
+    for (const char* distribution : { "alnum", "mixed", "binary" }) {
+        for (size_t size : { 16, 256, 4096, 65536 }) {
+            std::string input = makeInput(distribution, size);
+            run("UrlEncode/" + std::string(distribution) + "/" + std::to_string(size), size, [&input]() {
+                return Network::UrlEncode(input).size();
+            });
+        }
+    }
+
+    // Base64Encode
+    for (const char* distribution : { "alnum", "binary" }) {
+        for (size_t size : { 3, 64, 1024, 65536, 1048576 }) {
+            std::string input = makeInput(distribution, size);
+            run("Base64Encode/" + std::string(distribution) + "/" + std::to_string(size), size, [&input]() {
+                return Network::Base64Encode(input).size();
+            });
+        }
+    }
+
+    // ParseUrl
+    const std::vector<std::pair<std::string, std::string>> urls = {
+        { "short", "http://a.io" },
+        { "typical", "https://api.example.com:8443/v1/items?id=42&sort=desc" },
+        { "long_query", "https://api.example.com/search?q=" + makeInput("alnum", 2048) },
+    };
+    for (const auto& [label, url] : urls) {
+        run("ParseUrl/" + label, url.size(), [&url]() {
+            std::string protocol, host, path;
+            int port;
+            Network::ParseUrl(url, protocol, host, path, port);
+            return path.size() + static_cast<size_t>(port);
+        });
+    }
+
+    // ParseResponseHeaders
+    const std::vector<std::pair<int, size_t>> headerShapes = { { 5, 16 }, { 20, 32 }, { 50, 256 } };
+    for (const auto& [count, valueSize] : headerShapes) {
+        std::wstring raw = makeHeaders(count, valueSize);
+        run("ParseResponseHeaders/" + std::to_string(count) + "x" + std::to_string(valueSize), raw.size() * sizeof(wchar_t), [&raw]() {
+            std::map<std::string, std::string> headers;
+            Network::ParseResponseHeaders(raw, headers);
+            return headers.size();
+        });
+    }
+
+    if (!options.json_path.empty()) {
+        if (!writeJson(options.json_path, results)) {
+            std::cerr << "Failed to write " << options.json_path << std::endl;
+            return 1;
+        }
+        std::cout << "\nWrote " << results.size() << " results to " << options.json_path << std::endl;
+    }
+    return 0;
+}
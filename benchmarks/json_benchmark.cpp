@@ -0,0 +1,232 @@
+/**
+ * @file json_benchmark.cpp
+ * @brief On-demand JSON decoding of large API responses versus copy-and-DOM parsing
+ *
+ * Generates order-listing responses of several sizes and runs one query on
+ * each (sum of order ids, count of shipped orders, total of item prices):
+ *
+ * - index:     NetworkResponse::json() alone (stage 1 and grammar check)
+ * - on-demand: json() plus the query, reading values in place
+ * - dom:       copy of the body parsed into a std::map/std::vector tree, then
+ *              the query, as with a conventional DOM library
+ *
+ * Each case is repeated and the fastest run is reported, in MB/s of body.
+ *
+ * Build: link with NetworkJson.cpp
+ */
+
+#include "Network.hpp"
+#include "NetworkJson.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+static const int kRepetitions = 7;
+
+static std::string generateOrders(int count) {
+    static const char* statuses[] = { "pending", "shipped", "delivered", "cancelled" };
+    std::mt19937 random(42);
+    std::string json = "{\"page\":1,\"total\":" + std::to_string(count) + ",\"orders\":[";
+    for (int i = 0; i < count; i++) {
+        if (i > 0) json += ',';
+        json += "{\"id\":" + std::to_string(100000 + i) +
+                ",\"status\":\"" + statuses[random() % 4] + "\"" +
+                ",\"customer\":{\"name\":\"Customer " + std::to_string(random() % 10000) +
+                "\",\"email\":\"user" + std::to_string(i) + "@example.com\",\"vip\":" + (random() % 10 == 0 ? "true" : "false") + "}" +
+                ",\"note\":\"Leave at the \\\"back door\\\"\\nRing twice\",\"items\":[";
+        int items = 1 + random() % 5;
+        for (int j = 0; j < items; j++) {
+            if (j > 0) json += ',';
+            json += "{\"sku\":\"SKU-" + std::to_string(random() % 100000) + "\",\"quantity\":" + std::to_string(1 + random() % 9) +
+                    ",\"price\":" + std::to_string(random() % 10000) + "." + std::to_string(10 + random() % 90) + "}";
+        }
+        json += "]}";
+    }
+    json += "]}";
+    return json;
+}
+
+struct QueryResult {
+    int64_t idSum = 0;
+    int shipped = 0;
+    double priceTotal = 0.0;
+};
+
+static QueryResult queryOnDemand(const Network::NetworkResponse& response) {
+    QueryResult result;
+    JsonDocument document = response.json();
+    for (JsonValue order : document.Root()["orders"].Elements()) {
+        result.idSum += order["id"].AsInt64().value_or(0);
+        if (order["status"].RawString() == std::string_view("shipped")) {
+            result.shipped++;
+        }
+        for (JsonValue item : order["items"].Elements()) {
+            result.priceTotal += item["price"].AsDouble().value_or(0.0);
+        }
+    }
+    return result;
+}
+
+// Minimal conventional DOM: every value materialized, strings unescaped and copied
+struct DomValue {
+    enum class Kind { Null, Bool, Number, String, Array, Object } kind = Kind::Null;
+    double number = 0.0;
+    bool boolean = false;
+    std::string string;
+    std::vector<DomValue> array;
+    std::map<std::string, DomValue> object;
+};
+
+struct DomParser {
+    const std::string& text;
+    size_t position = 0;
+
+    void skip() { while (position < text.size() && std::strchr(" \t\r\n", text[position]) && text[position]) position++; }
+
+    std::string parseString() {
+        std::string out;
+        position++;
+        while (text[position] != '"') {
+            char c = text[position++];
+            if (c == '\\') {
+                char e = text[position++];
+                switch (e) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'u': out += '?'; position += 4; break;
+                    default:  out += e; break;
+                }
+            }
+            else {
+                out += c;
+            }
+        }
+        position++;
+        return out;
+    }
+
+    DomValue parse() {
+        skip();
+        DomValue value;
+        char c = text[position];
+        if (c == '{') {
+            value.kind = DomValue::Kind::Object;
+            position++;
+            skip();
+            while (text[position] != '}') {
+                std::string key = parseString();
+                skip();
+                position++;  // ':'
+                value.object.emplace(std::move(key), parse());
+                skip();
+                if (text[position] == ',') { position++; skip(); }
+            }
+            position++;
+        }
+        else if (c == '[') {
+            value.kind = DomValue::Kind::Array;
+            position++;
+            skip();
+            while (text[position] != ']') {
+                value.array.push_back(parse());
+                skip();
+                if (text[position] == ',') position++;
+                skip();
+            }
+            position++;
+        }
+        else if (c == '"') {
+            value.kind = DomValue::Kind::String;
+            value.string = parseString();
+        }
+        else if (c == 't' || c == 'f') {
+            value.kind = DomValue::Kind::Bool;
+            value.boolean = c == 't';
+            position += value.boolean ? 4 : 5;
+        }
+        else if (c == 'n') {
+            position += 4;
+        }
+        else {
+            value.kind = DomValue::Kind::Number;
+            auto result = std::from_chars(text.data() + position, text.data() + text.size(), value.number);
+            position = result.ptr - text.data();
+        }
+        return value;
+    }
+};
+
+static QueryResult queryDom(const Network::NetworkResponse& response) {
+    QueryResult result;
+    std::string copy = response.body;
+    DomParser parser{ copy };
+    DomValue root = parser.parse();
+    for (const DomValue& order : root.object["orders"].array) {
+        result.idSum += static_cast<int64_t>(order.object.at("id").number);
+        if (order.object.at("status").string == "shipped") {
+            result.shipped++;
+        }
+        for (const DomValue& item : order.object.at("items").array) {
+            result.priceTotal += item.object.at("price").number;
+        }
+    }
+    return result;
+}
+
+template<typename Function>
+static double bestSeconds(Function&& function) {
+    double best = 1e9;
+    for (int i = 0; i < kRepetitions; i++) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+int main() {
+    std::cout << "=== JSON Decoding Benchmark ===" << std::endl;
+    std::cout << std::setw(10) << "orders" << std::setw(10) << "MB" << std::setw(14) << "index MB/s"
+              << std::setw(16) << "on-demand MB/s" << std::setw(12) << "dom MB/s" << std::setw(10) << "speedup" << std::endl;
+
+    for (int orders : { 1000, 10000, 100000 }) {
+        Network::NetworkResponse response;
+        response.body = generateOrders(orders);
+        double megabytes = response.body.size() / (1024.0 * 1024.0);
+
+        QueryResult onDemand, dom;
+        double indexSeconds = bestSeconds([&]() {
+            JsonDocument document = response.json();
+            if (!document.Valid()) {
+                std::cerr << "Invalid document: " << document.Error() << std::endl;
+            }
+        });
+        double onDemandSeconds = bestSeconds([&]() { onDemand = queryOnDemand(response); });
+        double domSeconds = bestSeconds([&]() { dom = queryDom(response); });
+
+        if (onDemand.idSum != dom.idSum || onDemand.shipped != dom.shipped) {
+            std::cerr << "Query results differ" << std::endl;
+            return 1;
+        }
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(10) << orders
+                  << std::setw(10) << megabytes
+                  << std::setw(14) << megabytes / indexSeconds
+                  << std::setw(16) << megabytes / onDemandSeconds
+                  << std::setw(12) << megabytes / domSeconds
+                  << std::setw(9) << domSeconds / onDemandSeconds << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file json_writer_benchmark.cpp
+ * @brief JsonWriter request serialization versus string concatenation
+ *
+ * Serializes batches of orders as a request body would be built and sent:
+ *
+ * - concat: std::string concatenation with std::to_string and a per-character
+ *           escape, then the copy made when the string is passed as a payload
+ * - writer: JsonWriter with JsonKey literals, then its blocks handed out with
+ *           NextBlock as Network sends them
+ *
+ * Each case is repeated and the fastest run is reported, in MB/s of body.
+ *
+ * Build: link with NetworkJsonWriter.cpp and NetworkJson.cpp
+ */
+
+#include "Network.hpp"
+#include "NetworkJson.hpp"
+#include "NetworkJsonWriter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static const int kRepetitions = 7;
+
+struct Item {
+    std::string sku;
+    int quantity = 0;
+    double price = 0.0;
+};
+
+struct Order {
+    int64_t id = 0;
+    std::string status;
+    std::string customer;
+    std::string note;
+    bool vip = false;
+    std::vector<Item> items;
+};
+
+static std::vector<Order> generateOrders(int count) {
+    static const char* statuses[] = { "pending", "shipped", "delivered", "cancelled" };
+    std::mt19937 random(42);
+    std::vector<Order> orders(count);
+    for (int i = 0; i < count; i++) {
+        Order& order = orders[i];
+        order.id = 100000 + i;
+        order.status = statuses[random() % 4];
+        order.customer = "Customer " + std::to_string(random() % 10000);
+        order.note = "Leave at the \"back door\"\nRing twice";
+        order.vip = random() % 10 == 0;
+        int items = 1 + random() % 5;
+        for (int j = 0; j < items; j++) {
+            order.items.push_back({ "SKU-" + std::to_string(random() % 100000), static_cast<int>(1 + random() % 9),
+                                    (random() % 1000000) / 100.0 });
+        }
+    }
+    return orders;
+}
+
+static std::string quote(const std::string& value) {
+    std::string result = "\"";
+    for (char c : value) {
+        switch (c) {
+        case '"': result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n"; break;
+        case '\r': result += "\\r"; break;
+        case '\t': result += "\\t"; break;
+        default: result += c; break;
+        }
+    }
+    return result + "\"";
+}
+
+static std::string serializeConcat(const std::vector<Order>& orders) {
+    std::string json = "{\"orders\":[";
+    for (size_t i = 0; i < orders.size(); i++) {
+        const Order& order = orders[i];
+        if (i > 0) json += ',';
+        json += "{\"id\":" + std::to_string(order.id) +
+                ",\"status\":" + quote(order.status) +
+                ",\"customer\":" + quote(order.customer) +
+                ",\"note\":" + quote(order.note) +
+                ",\"vip\":" + (order.vip ? "true" : "false") + ",\"items\":[";
+        for (size_t j = 0; j < order.items.size(); j++) {
+            const Item& item = order.items[j];
+            if (j > 0) json += ',';
+            json += "{\"sku\":" + quote(item.sku) + ",\"quantity\":" + std::to_string(item.quantity) +
+                    ",\"price\":" + std::to_string(item.price) + "}";
+        }
+        json += "]}";
+    }
+    json += "]}";
+    return json;
+}
+
+static void serializeWriter(const std::vector<Order>& orders, JsonWriter& json) {
+    static const JsonKey kId("id"), kStatus("status"), kCustomer("customer"), kNote("note"), kVip("vip"),
+        kItems("items"), kSku("sku"), kQuantity("quantity"), kPrice("price");
+
+    json.BeginObject().Key("orders").BeginArray();
+    for (const Order& order : orders) {
+        json.BeginObject()
+            .Key(kId).Int(order.id)
+            .Key(kStatus).String(order.status)
+            .Key(kCustomer).String(order.customer)
+            .Key(kNote).String(order.note)
+            .Key(kVip).Bool(order.vip)
+            .Key(kItems).BeginArray();
+        for (const Item& item : order.items) {
+            json.BeginObject()
+                .Key(kSku).String(item.sku)
+                .Key(kQuantity).Int(item.quantity)
+                .Key(kPrice).Double(item.price)
+                .EndObject();
+        }
+        json.EndArray().EndObject();
+    }
+    json.EndArray().EndObject();
+}
+
+template<typename Function>
+static double bestSeconds(Function&& function) {
+    double best = 1e9;
+    for (int i = 0; i < kRepetitions; i++) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+int main() {
+    std::cout << "=== JSON Serialization Benchmark ===" << std::endl;
+    std::cout << std::setw(10) << "orders" << std::setw(10) << "MB" << std::setw(14) << "concat MB/s"
+              << std::setw(14) << "writer MB/s" << std::setw(10) << "speedup" << std::endl;
+
+    for (int count : { 1000, 10000, 100000 }) {
+        std::vector<Order> orders = generateOrders(count);
+
+        size_t concatBytes = 0;
+        double concatSeconds = bestSeconds([&]() {
+            std::string body = serializeConcat(orders);
+            std::string payload = body;  // The copy a by-value payload costs on its way to the request
+            concatBytes = payload.size();
+        });
+
+        JsonWriter json;
+        uint64_t sentBytes = 0;
+        double writerSeconds = bestSeconds([&]() {
+            json.Clear();
+            serializeWriter(orders, json);
+            sentBytes = 0;
+            std::string_view block;
+            while (json.NextBlock(block), !block.empty()) {
+                sentBytes += block.size();
+            }
+            json.Done();
+        });
+
+        std::string text = json.ToString();
+        JsonDocument document = JsonDocument::Parse(text);
+        if (!document.Valid() || sentBytes != json.Length() ||
+            document.Root()["orders"].Size() != static_cast<size_t>(count)) {
+            std::cerr << "Writer produced an invalid document" << std::endl;
+            return 1;
+        }
+
+        double megabytes = json.Length() / (1024.0 * 1024.0);
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(10) << count
+                  << std::setw(10) << megabytes
+                  << std::setw(14) << (concatBytes / (1024.0 * 1024.0)) / concatSeconds
+                  << std::setw(14) << megabytes / writerSeconds
+                  << std::setw(9) << concatSeconds / writerSeconds << "x" << std::endl;
+    }
+    return 0;
+}
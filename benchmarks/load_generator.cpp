@@ -0,0 +1,308 @@
+/**
+ * @file load_generator.cpp
+ * @brief wrk-style load generator for the Network library with an embedded test server
+ *
+ * Starts a LoopbackServer (unless --url is given), drives it from N concurrent
+ * workers calling Network::Request, and reports throughput and latency
+ * percentiles. Everything runs on one machine without internet access.
+ *
+ * Usage: load_generator [options]
+ *
+ *   -c, --connections N   Concurrent workers (default 8)
+ *   -d, --duration S      Test duration in seconds (default 10)
+ *   -n, --requests N      Stop after N requests instead of after the duration
+ *   -w, --warmup S        Seconds of load before recording starts (default 1)
+ *   --url URL             Load an external server instead of the embedded one
+ *   --method M            GET, POST, PUT, PATCH or DELETE (default GET)
+ *   --payload N           Request body size in bytes for POST/PUT/PATCH
+ *
+ * Embedded server options (also used by --serve):
+ *
+ *   --port N              Listen port (default: any free port)
+ *   --body N              Response body size in bytes (default 1024)
+ *   --max-body N          Random body sizes in [--body, --max-body]
+ *   --latency MS          Injected server latency
+ *   --jitter MS           Uniform random extra latency
+ *   --chunked             Chunked transfer encoding
+ *   --no-keepalive        Close the connection after every response
+ *   --serve               Only run the server, on all interfaces, until Enter is
+ *                         pressed; builds on any platform, so the server can run
+ *                         on a separate Linux box
+ *
+ * Build: link with Network.cpp and NetworkMetrics.cpp (Windows); on other
+ * platforms only --serve is available.
+ */
+
+// Must precede Network.hpp so that winsock2.h is included before windows.h
+#include "loopback_server.hpp"
+
+#ifdef _WIN32
+#include "Network.hpp"
+#include "NetworkMetrics.hpp"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct LoadOptions {
+    int connections = 8;
+    int duration_seconds = 10;
+    uint64_t requests = 0;
+    int warmup_seconds = 1;
+    std::string url;
+    std::string method = "GET";
+    size_t payload_size = 0;
+    bool serve_only = false;
+    LoopbackServer::Options server;
+};
+
+static void printUsage() {
+    std::cout << "Usage: load_generator [-c connections] [-d seconds] [-n requests] [-w warmup]\n"
+              << "                      [--url URL] [--method M] [--payload N]\n"
+              << "                      [--port N] [--body N] [--max-body N] [--latency MS] [--jitter MS]\n"
+              << "                      [--chunked] [--no-keepalive] [--serve]" << std::endl;
+}
+
+static bool parseArguments(int argc, char* argv[], LoadOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            return (i + 1 < argc) ? argv[++i] : "";
+        };
+
+        if (arg == "-c" || arg == "--connections") options.connections = std::max(1, std::atoi(value()));
+        else if (arg == "-d" || arg == "--duration") options.duration_seconds = std::atoi(value());
+        else if (arg == "-n" || arg == "--requests") options.requests = std::strtoull(value(), nullptr, 10);
+        else if (arg == "-w" || arg == "--warmup") options.warmup_seconds = std::atoi(value());
+        else if (arg == "--url") options.url = value();
+        else if (arg == "--method") options.method = value();
+        else if (arg == "--payload") options.payload_size = std::strtoull(value(), nullptr, 10);
+        else if (arg == "--port") options.server.port = std::atoi(value());
+        else if (arg == "--body") options.server.body_size = std::strtoull(value(), nullptr, 10);
+        else if (arg == "--max-body") options.server.max_body_size = std::strtoull(value(), nullptr, 10);
+        else if (arg == "--latency") options.server.latency_ms = std::atoi(value());
+        else if (arg == "--jitter") options.server.latency_jitter_ms = std::atoi(value());
+        else if (arg == "--chunked") options.server.chunked = true;
+        else if (arg == "--no-keepalive") options.server.keep_alive = false;
+        else if (arg == "--serve") options.serve_only = true;
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int serve(const LoadOptions& options) {
+    LoopbackServer::Options serverOptions = options.server;
+    serverOptions.listen_any = true;
+    LoopbackServer server(serverOptions);
+    if (!server.Start()) {
+        std::cerr << "Failed to start server" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Serving on port " << server.Port() << ", press Enter to stop" << std::endl;
+    std::cin.get();
+    server.Stop();
+    std::cout << "Served " << server.RequestsServed() << " requests on "
+              << server.ConnectionsAccepted() << " connections" << std::endl;
+    return 0;
+}
+
+#ifdef _WIN32
+
+struct WorkerResult {
+    LatencyHistogram latency;
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    uint64_t httpErrors = 0;
+    uint64_t bytes = 0;
+    uint64_t reused = 0;
+};
+
+static std::optional<Network::Method> parseMethod(const std::string& name) {
+    if (name == "GET") return Network::Method::HTTP_GET;
+    if (name == "POST") return Network::Method::HTTP_POST;
+    if (name == "PUT") return Network::Method::HTTP_PUT;
+    if (name == "PATCH") return Network::Method::HTTP_PATCH;
+    if (name == "DELETE") return Network::Method::HTTP_DELETE;
+    return std::nullopt;
+}
+
+static std::string formatMicros(uint64_t micros) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    if (micros >= 1000000) out << micros / 1000000.0 << "s";
+    else if (micros >= 1000) out << micros / 1000.0 << "ms";
+    else out << micros << "us";
+    return out.str();
+}
+
+static std::string formatBytes(double bytes) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    if (bytes >= 1024.0 * 1024.0) out << bytes / (1024.0 * 1024.0) << "MB";
+    else if (bytes >= 1024.0) out << bytes / 1024.0 << "KB";
+    else out << bytes << "B";
+    return out.str();
+}
+
+static int runLoad(const LoadOptions& options) {
+    auto method = parseMethod(options.method);
+    if (!method) {
+        std::cerr << "Unknown method: " << options.method << std::endl;
+        return 1;
+    }
+
+    LoopbackServer server(options.server);
+    std::string url = options.url;
+    if (url.empty()) {
+        if (!server.Start()) {
+            std::cerr << "Failed to start loopback server" << std::endl;
+            return 1;
+        }
+        url = "http://127.0.0.1:" + std::to_string(server.Port()) + "/";
+    }
+
+    if (!Network::Initialize()) {
+        std::cerr << "Failed to initialize network" << std::endl;
+        return 1;
+    }
+
+    std::optional<std::string> payload;
+    if (options.payload_size > 0) {
+        payload = std::string(options.payload_size, 'p');
+    }
+
+    Network::RequestConfig config;
+    config.timeout_seconds = 30;
+
+    std::cout << "Running " << (options.requests ? std::to_string(options.requests) + " requests" : std::to_string(options.duration_seconds) + "s test")
+              << " @ " << url << std::endl;
+    std::cout << "  " << options.connections << " connections";
+    if (options.url.empty()) {
+        std::cout << ", body " << options.server.body_size;
+        if (options.server.max_body_size > options.server.body_size) std::cout << "-" << options.server.max_body_size;
+        std::cout << " bytes, latency " << options.server.latency_ms << "ms";
+        if (options.server.latency_jitter_ms) std::cout << "+" << options.server.latency_jitter_ms << "ms";
+        std::cout << (options.server.chunked ? ", chunked" : "") << (options.server.keep_alive ? ", keep-alive" : ", no keep-alive");
+    }
+    std::cout << std::endl;
+
+    std::atomic<bool> recording{options.warmup_seconds <= 0};
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> issued{0};
+    std::vector<WorkerResult> results(options.connections);
+    std::vector<std::thread> workers;
+
+    for (int w = 0; w < options.connections; w++) {
+        workers.emplace_back([&, w]() {
+            WorkerResult& result = results[w];
+            while (!stop.load(std::memory_order_relaxed)) {
+                bool counted = recording.load(std::memory_order_relaxed);
+                if (counted && options.requests && issued.fetch_add(1, std::memory_order_relaxed) >= options.requests) {
+                    break;
+                }
+
+                auto response = Network::Request(*method, url, payload, config);
+                if (!counted) {
+                    continue;
+                }
+
+                result.requests++;
+                result.latency.Record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(response.timings.Total()).count()));
+                result.bytes += response.body.size();
+                if (response.timings.connection_reused) {
+                    result.reused++;
+                }
+                if (response.error_type == Network::ErrorType::Http) {
+                    result.httpErrors++;
+                }
+                else if (!response.success) {
+                    result.errors++;
+                }
+            }
+        });
+    }
+
+    if (options.warmup_seconds > 0) {
+        std::this_thread::sleep_for(std::chrono::seconds(options.warmup_seconds));
+        recording = true;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (!options.requests) {
+        std::this_thread::sleep_for(std::chrono::seconds(options.duration_seconds));
+        stop = true;
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    WorkerResult total;
+    for (const auto& result : results) {
+        total.latency.Merge(result.latency);
+        total.requests += result.requests;
+        total.errors += result.errors;
+        total.httpErrors += result.httpErrors;
+        total.bytes += result.bytes;
+        total.reused += result.reused;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Latency     p50 " << formatMicros(total.latency.Percentile(0.50))
+              << "   p99 " << formatMicros(total.latency.Percentile(0.99))
+              << "   p999 " << formatMicros(total.latency.Percentile(0.999))
+              << "   max " << formatMicros(total.latency.MaxMicros()) << std::endl;
+    if (total.requests > 0) {
+        std::cout << "  Mean        " << formatMicros(total.latency.SumMicros() / total.requests) << std::endl;
+    }
+    std::cout << "  " << total.requests << " requests in " << elapsed << "s, "
+              << formatBytes(static_cast<double>(total.bytes)) << " read" << std::endl;
+    std::cout << "  Connection reuse: " << (total.requests ? 100.0 * total.reused / total.requests : 0.0) << "%";
+    if (options.url.empty()) {
+        std::cout << " (" << server.ConnectionsAccepted() << " connections accepted)";
+    }
+    std::cout << std::endl;
+    if (total.errors || total.httpErrors) {
+        std::cout << "  Errors: " << total.errors << " transport, " << total.httpErrors << " non-2xx" << std::endl;
+    }
+    std::cout << "Requests/sec: " << total.requests / elapsed << std::endl;
+    std::cout << "Transfer/sec: " << formatBytes(total.bytes / elapsed) << std::endl;
+
+    Network::Cleanup();
+    server.Stop();
+    return 0;
+}
+
+#endif // _WIN32
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    if (options.serve_only) {
+        return serve(options);
+    }
+
+#ifdef _WIN32
+    return runLoad(options);
+#else
+    std::cerr << "The Network client requires Windows; use --serve to run only the server" << std::endl;
+    return 1;
+#endif
+}
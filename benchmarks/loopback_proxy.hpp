@@ -0,0 +1,491 @@
+/**
+ * @file loopback_proxy.hpp
+ * @brief Embedded forward proxy for offline proxy benchmarks
+ *
+ * A stand-in for a production egress proxy on the loopback interface. One
+ * port speaks both protocols, told apart by the first byte a client sends:
+ *
+ * - SOCKS5 (RFC 1928) CONNECT, with optional username/password (RFC 1929)
+ * - HTTP CONNECT tunnels, and plain requests in absolute form
+ *   (`GET http://host:port/path`), which are forwarded in origin form
+ *
+ * Each client connection is bound to one upstream connection, opened for the
+ * target of its first request, and bytes are relayed both ways until either
+ * side closes. TunnelsOpened() therefore counts the tunnels a client had to
+ * set up, which is what connection reuse through a proxy should keep low.
+ *
+ * Builds on Winsock and POSIX sockets like LoopbackServer. On Windows include
+ * this header before Network.hpp so that winsock2.h precedes windows.h.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef LOOPBACK_PROXY_HPP
+#define LOOPBACK_PROXY_HPP
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Loopback HTTP and SOCKS5 forward proxy
+ */
+class LoopbackProxy {
+public:
+#ifdef _WIN32
+    using Socket = SOCKET;
+    static constexpr Socket kInvalidSocket = INVALID_SOCKET;
+#else
+    using Socket = int;
+    static constexpr Socket kInvalidSocket = -1;
+#endif
+
+    /**
+     * @brief Proxy settings
+     */
+    struct Options {
+        int port = 0;                                           ///< Listen port (0 = pick a free one)
+        std::string username;                                   ///< Required credentials (empty = no authentication)
+        std::string password;
+    };
+
+    LoopbackProxy() = default;
+    explicit LoopbackProxy(const Options& options) : options(options) {}
+
+    ~LoopbackProxy() {
+        Stop();
+    }
+
+    LoopbackProxy(const LoopbackProxy&) = delete;
+    LoopbackProxy& operator=(const LoopbackProxy&) = delete;
+
+    /**
+     * @brief Bind, listen and start accepting connections
+     * @return true if the proxy is listening
+     */
+    bool Start() {
+#ifdef _WIN32
+        WSADATA wsaData;
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+            return false;
+        }
+        wsaStarted = true;
+#endif
+        listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listenSocket == kInvalidSocket) {
+            return false;
+        }
+
+        int reuse = 1;
+        setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<unsigned short>(options.port));
+        if (bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listenSocket, SOMAXCONN) != 0) {
+            CloseSocket(listenSocket);
+            listenSocket = kInvalidSocket;
+            return false;
+        }
+
+        socklen_t length = sizeof(address);
+        getsockname(listenSocket, reinterpret_cast<sockaddr*>(&address), &length);
+        boundPort = ntohs(address.sin_port);
+
+        running = true;
+        acceptThread = std::thread(&LoopbackProxy::AcceptLoop, this);
+        return true;
+    }
+
+    /**
+     * @brief Stop accepting, close all tunnels and join all threads
+     */
+    void Stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+
+        ShutdownSocket(listenSocket);
+        CloseSocket(listenSocket);
+        listenSocket = kInvalidSocket;
+        if (acceptThread.joinable()) {
+            acceptThread.join();
+        }
+
+        // Connection threads are detached; wake them and wait for the last one to leave
+        std::unique_lock<std::mutex> lock(connectionMutex);
+        for (Socket socket : sockets) {
+            ShutdownSocket(socket);
+        }
+        connectionsClosed.wait(lock, [this]() { return connections == 0; });
+        lock.unlock();
+#ifdef _WIN32
+        if (wsaStarted) {
+            WSACleanup();
+            wsaStarted = false;
+        }
+#endif
+    }
+
+    int Port() const { return boundPort; }                      ///< Port the proxy listens on
+    uint64_t ConnectionsAccepted() const { return accepted.load(std::memory_order_relaxed); }
+    uint64_t TunnelsOpened() const { return tunnels.load(std::memory_order_relaxed); }   ///< Upstream connections opened
+    uint64_t Rejected() const { return rejected.load(std::memory_order_relaxed); }       ///< Failed authentications and handshakes
+
+private:
+    void AcceptLoop() {
+        while (running) {
+            Socket client = accept(listenSocket, nullptr, nullptr);
+            if (client == kInvalidSocket) {
+                if (!running) {
+                    break;
+                }
+                continue;
+            }
+
+            int noDelay = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+            accepted.fetch_add(1, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(connectionMutex);
+            if (!running) {
+                CloseSocket(client);
+                break;
+            }
+            sockets.insert(client);
+            connections++;
+            std::thread(&LoopbackProxy::ServeConnection, this, client).detach();
+        }
+    }
+
+    void ServeConnection(Socket client) {
+        unsigned char version = 0;
+        Socket upstream = kInvalidSocket;
+        std::string forward;  // Bytes to send upstream once connected
+        if (recv(client, reinterpret_cast<char*>(&version), 1, MSG_PEEK) == 1) {
+            upstream = version == 0x05 ? Socks5Handshake(client) : HttpHandshake(client, forward);
+        }
+        if (upstream == kInvalidSocket) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            Disconnect(client, kInvalidSocket);
+            return;
+        }
+
+        if (SendAll(upstream, forward.data(), forward.size())) {
+            std::thread downstream([client, upstream]() {
+                Pipe(upstream, client);
+                ShutdownSocket(client);
+            });
+            Pipe(client, upstream);
+            ShutdownSocket(upstream);
+            downstream.join();
+        }
+        Disconnect(client, upstream);
+    }
+
+    Socket Socks5Handshake(Socket client) {
+        unsigned char greeting[2];
+        unsigned char methods[255];
+        if (!ReceiveAll(client, greeting, 2) || !ReceiveAll(client, methods, greeting[1])) {
+            return kInvalidSocket;
+        }
+        unsigned char wanted = options.username.empty() ? 0x00 : 0x02;
+        bool offered = std::find(methods, methods + greeting[1], wanted) != methods + greeting[1];
+        unsigned char choice[2] = { 0x05, static_cast<unsigned char>(offered ? wanted : 0xFF) };
+        if (!SendAll(client, reinterpret_cast<const char*>(choice), 2) || choice[1] == 0xFF) {
+            return kInvalidSocket;
+        }
+
+        if (wanted == 0x02) {
+            unsigned char length = 0;
+            std::string username, password;
+            unsigned char version = 0;
+            bool read = ReceiveAll(client, &version, 1) && ReceiveAll(client, &length, 1) &&
+                        ReceiveString(client, username, length) && ReceiveAll(client, &length, 1) &&
+                        ReceiveString(client, password, length);
+            bool valid = read && username == options.username && password == options.password;
+            unsigned char status[2] = { 0x01, static_cast<unsigned char>(valid ? 0x00 : 0x01) };
+            SendAll(client, reinterpret_cast<const char*>(status), 2);
+            if (!valid) {
+                return kInvalidSocket;
+            }
+        }
+
+        unsigned char request[4];
+        std::string host;
+        unsigned char port[2];
+        if (!ReceiveAll(client, request, 4) || request[1] != 0x01) {
+            return kInvalidSocket;
+        }
+        if (request[3] == 0x03) {
+            unsigned char length = 0;
+            if (!ReceiveAll(client, &length, 1) || !ReceiveString(client, host, length)) {
+                return kInvalidSocket;
+            }
+        }
+        else if (request[3] == 0x01) {
+            unsigned char address[4];
+            if (!ReceiveAll(client, address, 4)) {
+                return kInvalidSocket;
+            }
+            host = std::to_string(address[0]) + "." + std::to_string(address[1]) + "." +
+                   std::to_string(address[2]) + "." + std::to_string(address[3]);
+        }
+        else {
+            return kInvalidSocket;  // IPv6 targets are not needed on loopback
+        }
+        if (!ReceiveAll(client, port, 2)) {
+            return kInvalidSocket;
+        }
+
+        Socket upstream = Connect(host, (port[0] << 8) | port[1]);
+        unsigned char reply[10] = { 0x05, static_cast<unsigned char>(upstream == kInvalidSocket ? 0x05 : 0x00), 0x00, 0x01, 0, 0, 0, 0, 0, 0 };
+        SendAll(client, reinterpret_cast<const char*>(reply), sizeof(reply));
+        return upstream;
+    }
+
+    Socket HttpHandshake(Socket client, std::string& forward) {
+        std::string buffer;
+        size_t headerEnd;
+        char chunk[4096];
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            int received = static_cast<int>(recv(client, chunk, sizeof(chunk), 0));
+            if (received <= 0 || buffer.size() > 64 * 1024) {
+                return kInvalidSocket;
+            }
+            buffer.append(chunk, received);
+        }
+
+        size_t methodEnd = buffer.find(' ');
+        size_t targetEnd = methodEnd == std::string::npos ? std::string::npos : buffer.find(' ', methodEnd + 1);
+        if (targetEnd == std::string::npos || targetEnd > headerEnd) {
+            return kInvalidSocket;
+        }
+        std::string method = buffer.substr(0, methodEnd);
+        std::string target = buffer.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+        bool tunnel = method == "CONNECT";
+
+        if (!options.username.empty() &&
+            HeaderValue(buffer.substr(0, headerEnd), "proxy-authorization") != "Basic " + Base64(options.username + ":" + options.password)) {
+            static const char required[] = "HTTP/1.1 407 Proxy Authentication Required\r\n"
+                                           "Proxy-Authenticate: Basic realm=\"loopback\"\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            SendAll(client, required, sizeof(required) - 1);
+            return kInvalidSocket;
+        }
+
+        // CONNECT host:port, or http://host[:port]/path
+        std::string authority = target;
+        std::string path;
+        if (!tunnel) {
+            if (target.compare(0, 7, "http://") != 0) {
+                return kInvalidSocket;
+            }
+            size_t pathStart = target.find('/', 7);
+            authority = target.substr(7, pathStart == std::string::npos ? std::string::npos : pathStart - 7);
+            path = pathStart == std::string::npos ? "/" : target.substr(pathStart);
+        }
+        size_t colon = authority.rfind(':');
+        std::string host = colon == std::string::npos ? authority : authority.substr(0, colon);
+        int port = colon == std::string::npos ? 80 : std::atoi(authority.c_str() + colon + 1);
+
+        Socket upstream = Connect(host, port);
+        if (upstream == kInvalidSocket) {
+            static const char badGateway[] = "HTTP/1.1 502 Bad Gateway\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            SendAll(client, badGateway, sizeof(badGateway) - 1);
+            return kInvalidSocket;
+        }
+
+        if (tunnel) {
+            static const char established[] = "HTTP/1.1 200 Connection Established\r\n\r\n";
+            SendAll(client, established, sizeof(established) - 1);
+            forward = buffer.substr(headerEnd + 4);
+        }
+        else {
+            forward = method + " " + path + buffer.substr(targetEnd);
+        }
+        return upstream;
+    }
+
+    Socket Connect(const std::string& host, int port) {
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+            return kInvalidSocket;
+        }
+        Socket upstream = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+        if (upstream != kInvalidSocket &&
+            connect(upstream, addresses->ai_addr, static_cast<int>(addresses->ai_addrlen)) != 0) {
+            CloseSocket(upstream);
+            upstream = kInvalidSocket;
+        }
+        freeaddrinfo(addresses);
+        if (upstream == kInvalidSocket) {
+            return kInvalidSocket;
+        }
+
+        int noDelay = 1;
+        setsockopt(upstream, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        sockets.insert(upstream);
+        if (!running) {
+            ShutdownSocket(upstream);
+        }
+        tunnels.fetch_add(1, std::memory_order_relaxed);
+        return upstream;
+    }
+
+    static void Pipe(Socket from, Socket to) {
+        char buffer[64 * 1024];
+        while (true) {
+            int received = static_cast<int>(recv(from, buffer, sizeof(buffer), 0));
+            if (received <= 0 || !SendAll(to, buffer, static_cast<size_t>(received))) {
+                return;
+            }
+        }
+    }
+
+    void Disconnect(Socket client, Socket upstream) {
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        for (Socket socket : { client, upstream }) {
+            if (socket != kInvalidSocket) {
+                sockets.erase(socket);
+                CloseSocket(socket);  // Under the lock so Stop() never shuts down a reused descriptor
+            }
+        }
+        connections--;
+        connectionsClosed.notify_all();  // Still under the lock, so Stop() cannot return while *this is in use
+    }
+
+    static bool ReceiveAll(Socket socket, unsigned char* data, size_t size) {
+        while (size > 0) {
+            int received = static_cast<int>(recv(socket, reinterpret_cast<char*>(data), static_cast<int>(std::min<size_t>(size, INT_MAX)), 0));
+            if (received <= 0) {
+                return false;
+            }
+            data += received;
+            size -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    static bool ReceiveString(Socket socket, std::string& value, size_t size) {
+        value.resize(size);
+        return ReceiveAll(socket, reinterpret_cast<unsigned char*>(&value[0]), size);
+    }
+
+    static std::string Base64(const std::string& value) {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string encoded;
+        for (size_t i = 0; i < value.size(); i += 3) {
+            uint32_t group = static_cast<unsigned char>(value[i]) << 16;
+            if (i + 1 < value.size()) group |= static_cast<unsigned char>(value[i + 1]) << 8;
+            if (i + 2 < value.size()) group |= static_cast<unsigned char>(value[i + 2]);
+            encoded += alphabet[(group >> 18) & 0x3F];
+            encoded += alphabet[(group >> 12) & 0x3F];
+            encoded += i + 1 < value.size() ? alphabet[(group >> 6) & 0x3F] : '=';
+            encoded += i + 2 < value.size() ? alphabet[group & 0x3F] : '=';
+        }
+        return encoded;
+    }
+
+    static std::string HeaderValue(const std::string& head, const char* name) {
+        size_t nameLength = std::strlen(name);
+        size_t position = head.find("\r\n");
+        while (position != std::string::npos) {
+            size_t lineStart = position + 2;
+            size_t lineEnd = head.find("\r\n", lineStart);
+            std::string line = head.substr(lineStart, lineEnd == std::string::npos ? std::string::npos : lineEnd - lineStart);
+            if (line.size() > nameLength && line[nameLength] == ':') {
+                bool match = true;
+                for (size_t i = 0; i < nameLength && match; i++) {
+                    match = std::tolower(static_cast<unsigned char>(line[i])) == name[i];
+                }
+                if (match) {
+                    size_t valueStart = line.find_first_not_of(' ', nameLength + 1);
+                    return valueStart == std::string::npos ? "" : line.substr(valueStart);
+                }
+            }
+            position = lineEnd;
+        }
+        return "";
+    }
+
+    static bool SendAll(Socket socket, const char* data, size_t size) {
+        while (size > 0) {
+#ifdef _WIN32
+            int sent = send(socket, data, static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+#else
+            ssize_t sent = send(socket, data, size, MSG_NOSIGNAL);
+#endif
+            if (sent <= 0) {
+                return false;
+            }
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    static void ShutdownSocket(Socket socket) {
+        if (socket == kInvalidSocket) return;
+#ifdef _WIN32
+        shutdown(socket, SD_BOTH);
+#else
+        shutdown(socket, SHUT_RDWR);
+#endif
+    }
+
+    static void CloseSocket(Socket socket) {
+        if (socket == kInvalidSocket) return;
+#ifdef _WIN32
+        closesocket(socket);
+#else
+        close(socket);
+#endif
+    }
+
+    Options options;
+    Socket listenSocket = kInvalidSocket;
+    int boundPort = 0;
+    std::atomic<bool> running{false};
+    std::thread acceptThread;
+    std::mutex connectionMutex;
+    std::condition_variable connectionsClosed;
+    std::set<Socket> sockets;                                   // Client and upstream sockets of live connections
+    size_t connections = 0;                                     // Guarded by connectionMutex
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> tunnels{0};
+    std::atomic<uint64_t> rejected{0};
+#ifdef _WIN32
+    bool wsaStarted = false;
+#endif
+};
+
+#endif // LOOPBACK_PROXY_HPP
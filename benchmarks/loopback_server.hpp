@@ -0,0 +1,623 @@
+/**
+ * @file loopback_server.hpp
+ * @brief Embedded HTTP/1.1 test server for offline benchmarks
+ *
+ * A small thread-per-connection server on the loopback interface. Response
+ * shape is configurable globally through LoopbackServer::Options and per
+ * request through query parameters:
+ *
+ * - `size=N`      body size in bytes
+ * - `delay=MS`    latency injected before the response is sent
+ * - `chunked=0|1` Transfer-Encoding: chunked instead of Content-Length
+ * - `close=1`     close the connection after the response
+ * - `grpc=N`      gRPC-style response: N length-prefixed messages of `size`
+ *                 bytes and a grpc-status trailer (`grpc-status=K`, default 0)
+ * - `redirect=N`  redirect N times (`redirect-status=K`, default 302) to the
+ *                 same path with `redirect=N-1`, then respond normally
+ *
+ * A capacity limit makes excess requests queue inside the server, so its
+ * latency rises under overload like a real backend's; SetCapacity changes it
+ * while the server runs.
+ *
+ * Setting `unix_path` serves on a Unix domain socket instead of TCP, for
+ * http+unix:// clients.
+ *
+ * Request bodies, with Content-Length or chunked, are read and discarded as
+ * they arrive; the trailers of the last chunked body are kept. Builds on
+ * Winsock and POSIX sockets, so the server can also run stand-alone on a Linux
+ * box (see load_generator --serve). On Windows include this header before
+ * Network.hpp so that winsock2.h precedes windows.h.
+ *
+ * @author Jxint
+ * @date December 2024
+ */
+
+#ifndef LOOPBACK_SERVER_HPP
+#define LOOPBACK_SERVER_HPP
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <afunix.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Loopback HTTP/1.1 server with configurable response shape
+ */
+class LoopbackServer {
+public:
+#ifdef _WIN32
+    using Socket = SOCKET;
+    static constexpr Socket kInvalidSocket = INVALID_SOCKET;
+#else
+    using Socket = int;
+    static constexpr Socket kInvalidSocket = -1;
+#endif
+
+    /**
+     * @brief Default response shape
+     */
+    struct Options {
+        int port = 0;                                           ///< Listen port (0 = pick a free one)
+        std::string unix_path;                                  ///< Listen on this Unix domain socket instead of TCP
+        bool listen_any = false;                                ///< Listen on all interfaces instead of 127.0.0.1
+        size_t body_size = 1024;                                ///< Body size in bytes
+        size_t max_body_size = 0;                               ///< If larger than body_size, sizes are uniform in [body_size, max_body_size]
+        int latency_ms = 0;                                     ///< Latency injected before each response
+        int latency_jitter_ms = 0;                              ///< Uniform random extra latency
+        bool chunked = false;                                   ///< Use chunked transfer encoding
+        size_t chunk_size = 16 * 1024;                          ///< Chunk size when chunked
+        bool keep_alive = true;                                 ///< Keep connections open between requests
+        int capacity = 0;                                       ///< Requests processed at once; others queue (0 = unlimited)
+    };
+
+    LoopbackServer() = default;
+    explicit LoopbackServer(const Options& options) : options(options), capacity(options.capacity) {}
+
+    ~LoopbackServer() {
+        Stop();
+    }
+
+    LoopbackServer(const LoopbackServer&) = delete;
+    LoopbackServer& operator=(const LoopbackServer&) = delete;
+
+    /**
+     * @brief Bind, listen and start accepting connections
+     * @return true if the server is listening
+     */
+    bool Start() {
+#ifdef _WIN32
+        WSADATA wsaData;
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+            return false;
+        }
+        wsaStarted = true;
+#endif
+        if (!options.unix_path.empty()) {
+            if (!ListenUnix()) {
+                return false;
+            }
+            body.assign(std::max(options.body_size, options.max_body_size), 'x');
+            running = true;
+            acceptThread = std::thread(&LoopbackServer::AcceptLoop, this);
+            return true;
+        }
+
+        listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listenSocket == kInvalidSocket) {
+            return false;
+        }
+
+        int reuse = 1;
+        setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(options.listen_any ? INADDR_ANY : INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<unsigned short>(options.port));
+        if (bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listenSocket, SOMAXCONN) != 0) {
+            CloseSocket(listenSocket);
+            listenSocket = kInvalidSocket;
+            return false;
+        }
+
+        socklen_t length = sizeof(address);
+        getsockname(listenSocket, reinterpret_cast<sockaddr*>(&address), &length);
+        boundPort = ntohs(address.sin_port);
+
+        body.assign(std::max(options.body_size, options.max_body_size), 'x');
+        running = true;
+        acceptThread = std::thread(&LoopbackServer::AcceptLoop, this);
+        return true;
+    }
+
+    /**
+     * @brief Stop accepting, close all connections and join all threads
+     */
+    void Stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+
+        ShutdownSocket(listenSocket);
+        CloseSocket(listenSocket);
+        listenSocket = kInvalidSocket;
+        if (acceptThread.joinable()) {
+            acceptThread.join();
+        }
+
+        {
+            std::lock_guard<std::mutex> capacityLock(capacityMutex);
+            capacityFreed.notify_all();
+        }
+
+        // Connection threads are detached; wake them and wait for the last one to leave
+        std::unique_lock<std::mutex> lock(connectionMutex);
+        for (Socket client : clients) {
+            ShutdownSocket(client);
+        }
+        connectionsClosed.wait(lock, [this]() { return clients.empty(); });
+        lock.unlock();
+        if (!options.unix_path.empty()) {
+            RemoveSocketFile();
+        }
+#ifdef _WIN32
+        if (wsaStarted) {
+            WSACleanup();
+            wsaStarted = false;
+        }
+#endif
+    }
+
+    /**
+     * @brief Change how many requests are processed at once
+     * @param requests New capacity (0 = unlimited)
+     */
+    void SetCapacity(int requests) {
+        std::lock_guard<std::mutex> lock(capacityMutex);
+        capacity = requests;
+        capacityFreed.notify_all();
+    }
+
+    int Port() const { return boundPort; }                      ///< Port the server listens on
+    const std::string& UnixPath() const { return options.unix_path; }  ///< Socket path, when serving on a Unix socket
+    uint64_t RequestsServed() const { return served.load(std::memory_order_relaxed); }
+    uint64_t ConnectionsAccepted() const { return accepted.load(std::memory_order_relaxed); }
+    uint64_t BodyBytesReceived() const { return bodyBytesReceived.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Trailer lines of the most recent chunked request body, one per line
+     */
+    std::string LastRequestTrailers() {
+        std::lock_guard<std::mutex> lock(trailerMutex);
+        return lastTrailers;
+    }
+
+private:
+    struct RequestShape {
+        size_t body_size;
+        int latency_ms;
+        bool chunked;
+        bool close;
+        int grpc_messages;                                      // gRPC-style response with this many messages (-1 = plain)
+        int grpc_status;
+        int redirects;                                          // Redirects still to send before the response
+        int redirect_status;
+        std::string location;                                   // Target of the redirect, the request with redirects - 1
+    };
+
+    // Binds options.unix_path, replacing a socket file left by an earlier run
+    bool ListenUnix() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (options.unix_path.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        std::memcpy(address.sun_path, options.unix_path.data(), options.unix_path.size());
+
+        listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenSocket == kInvalidSocket) {
+            return false;
+        }
+        RemoveSocketFile();
+        if (bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listenSocket, SOMAXCONN) != 0) {
+            CloseSocket(listenSocket);
+            listenSocket = kInvalidSocket;
+            return false;
+        }
+        return true;
+    }
+
+    void RemoveSocketFile() {
+#ifdef _WIN32
+        DeleteFileA(options.unix_path.c_str());
+#else
+        unlink(options.unix_path.c_str());
+#endif
+    }
+
+    void AcceptLoop() {
+        while (running) {
+            Socket client = accept(listenSocket, nullptr, nullptr);
+            if (client == kInvalidSocket) {
+                if (!running) {
+                    break;
+                }
+                continue;
+            }
+
+            if (options.unix_path.empty()) {
+                int noDelay = 1;
+                setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+            }
+            accepted.fetch_add(1, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(connectionMutex);
+            if (!running) {
+                CloseSocket(client);
+                break;
+            }
+            clients.insert(client);
+            std::thread(&LoopbackServer::ServeConnection, this, client).detach();
+        }
+    }
+
+    void ServeConnection(Socket client) {
+        std::mt19937 random(static_cast<unsigned>(std::hash<std::thread::id>()(std::this_thread::get_id())));
+        std::string buffer;
+        char chunk[16 * 1024];
+
+        while (running) {
+            // Read the request head
+            size_t headerEnd;
+            while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+                int received = recv(client, chunk, sizeof(chunk), 0);
+                if (received <= 0) {
+                    Disconnect(client);
+                    return;
+                }
+                buffer.append(chunk, received);
+            }
+            std::string head = buffer.substr(0, headerEnd);
+            buffer.erase(0, headerEnd + 4);
+
+            // Discard the request body as it arrives, so large uploads are not buffered
+            std::string transferEncoding = HeaderValue(head, "transfer-encoding");
+            bool bodyRead = (transferEncoding.find("chunked") != std::string::npos)
+                ? DiscardChunkedBody(client, buffer)
+                : DiscardBody(client, buffer, static_cast<uint64_t>(std::strtoull(HeaderValue(head, "content-length").c_str(), nullptr, 10)));
+            if (!bodyRead) {
+                Disconnect(client);
+                return;
+            }
+
+            RequestShape shape = ShapeFor(head, random);
+            {
+                std::unique_lock<std::mutex> lock(capacityMutex);
+                capacityFreed.wait(lock, [this]() { return !running || capacity <= 0 || busy < capacity; });
+                busy++;
+            }
+            if (shape.latency_ms > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(shape.latency_ms));
+            }
+            bool sent = SendResponse(client, shape);
+            {
+                std::lock_guard<std::mutex> lock(capacityMutex);
+                busy--;
+                capacityFreed.notify_one();
+            }
+            served.fetch_add(1, std::memory_order_relaxed);
+            if (!sent || shape.close) {
+                break;
+            }
+        }
+        Disconnect(client);
+    }
+
+    RequestShape ShapeFor(const std::string& head, std::mt19937& random) const {
+        RequestShape shape;
+        shape.body_size = options.body_size;
+        if (options.max_body_size > options.body_size) {
+            shape.body_size = std::uniform_int_distribution<size_t>(options.body_size, options.max_body_size)(random);
+        }
+        shape.latency_ms = options.latency_ms;
+        if (options.latency_jitter_ms > 0) {
+            shape.latency_ms += std::uniform_int_distribution<int>(0, options.latency_jitter_ms)(random);
+        }
+        shape.chunked = options.chunked;
+        shape.grpc_messages = -1;
+        shape.grpc_status = 0;
+        shape.redirects = 0;
+        shape.redirect_status = 302;
+
+        std::string connection = HeaderValue(head, "connection");
+        std::transform(connection.begin(), connection.end(), connection.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        shape.close = !options.keep_alive || connection == "close" ||
+                      (head.find(" HTTP/1.0\r\n") != std::string::npos && connection != "keep-alive");
+
+        // Query parameters override the defaults
+        size_t lineEnd = head.find("\r\n");
+        std::string target = head.substr(0, lineEnd);
+        size_t query = target.find('?');
+        if (query != std::string::npos) {
+            size_t targetEnd = target.find(' ', query);
+            std::string params = target.substr(query + 1, targetEnd - query - 1);
+            std::string forwarded;
+            size_t position = 0;
+            while (position < params.size()) {
+                size_t next = params.find('&', position);
+                if (next == std::string::npos) next = params.size();
+                std::string param = params.substr(position, next - position);
+                size_t equals = param.find('=');
+                std::string key = param.substr(0, equals);
+                std::string value = (equals == std::string::npos) ? "1" : param.substr(equals + 1);
+                if (key == "size") shape.body_size = std::min(static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10)), body.size());
+                else if (key == "delay") shape.latency_ms = std::atoi(value.c_str());
+                else if (key == "chunked") shape.chunked = value != "0";
+                else if (key == "close") shape.close = value != "0";
+                else if (key == "grpc") shape.grpc_messages = std::atoi(value.c_str());
+                else if (key == "grpc-status") shape.grpc_status = std::atoi(value.c_str());
+                else if (key == "redirect") shape.redirects = std::atoi(value.c_str());
+                else if (key == "redirect-status") shape.redirect_status = std::atoi(value.c_str());
+                forwarded += (forwarded.empty() ? "" : "&") +
+                             (key == "redirect" ? "redirect=" + std::to_string(shape.redirects - 1) : param);
+                position = next + 1;
+            }
+            size_t pathStart = target.find(' ') + 1;
+            shape.location = target.substr(pathStart, query - pathStart) + "?" + forwarded;
+        }
+        return shape;
+    }
+
+    bool SendResponse(Socket client, const RequestShape& shape) {
+        if (shape.redirects > 0) {
+            static const char redirectBody[] = "Redirecting";
+            std::string head = "HTTP/1.1 " + std::to_string(shape.redirect_status) + " Redirect\r\nLocation: " + shape.location +
+                               "\r\nContent-Length: " + std::to_string(sizeof(redirectBody) - 1) + "\r\n";
+            head += shape.close ? "Connection: close\r\n\r\n" : "Connection: keep-alive\r\n\r\n";
+            return SendAll(client, head.data(), head.size()) && SendAll(client, redirectBody, sizeof(redirectBody) - 1);
+        }
+        if (shape.grpc_messages >= 0) {
+            return SendGrpcResponse(client, shape);
+        }
+
+        std::string head = "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n";
+        head += shape.close ? "Connection: close\r\n" : "Connection: keep-alive\r\n";
+        if (shape.chunked) {
+            head += "Transfer-Encoding: chunked\r\n\r\n";
+        }
+        else {
+            head += "Content-Length: " + std::to_string(shape.body_size) + "\r\n\r\n";
+        }
+        if (!SendAll(client, head.data(), head.size())) {
+            return false;
+        }
+
+        if (!shape.chunked) {
+            return SendAll(client, body.data(), shape.body_size);
+        }
+
+        for (size_t offset = 0; offset < shape.body_size; offset += options.chunk_size) {
+            size_t length = std::min(options.chunk_size, shape.body_size - offset);
+            char sizeLine[32];
+            int sizeLength = std::snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", length);
+            if (!SendAll(client, sizeLine, sizeLength) ||
+                !SendAll(client, body.data() + offset, length) ||
+                !SendAll(client, "\r\n", 2)) {
+                return false;
+            }
+        }
+        return SendAll(client, "0\r\n\r\n", 5);
+    }
+
+    // Length-prefixed messages of body_size bytes, one per chunk, with grpc-status in the trailers.
+    // The status is repeated in the headers because WinHTTP reports trailers over HTTP/2 only
+    bool SendGrpcResponse(Socket client, const RequestShape& shape) {
+        std::string status = std::to_string(shape.grpc_status);
+        std::string head = "HTTP/1.1 200 OK\r\nContent-Type: application/grpc\r\ngrpc-status: " + status + "\r\n";
+        head += shape.close ? "Connection: close\r\n" : "Connection: keep-alive\r\n";
+        head += "Transfer-Encoding: chunked\r\nTrailer: grpc-status\r\n\r\n";
+        if (!SendAll(client, head.data(), head.size())) {
+            return false;
+        }
+
+        for (int i = 0; i < shape.grpc_messages; i++) {
+            char prefix[48];
+            uint32_t length = static_cast<uint32_t>(shape.body_size);
+            int sizeLength = std::snprintf(prefix, sizeof(prefix), "%zx\r\n", shape.body_size + 5);
+            prefix[sizeLength++] = 0;
+            prefix[sizeLength++] = static_cast<char>(length >> 24);
+            prefix[sizeLength++] = static_cast<char>(length >> 16);
+            prefix[sizeLength++] = static_cast<char>(length >> 8);
+            prefix[sizeLength++] = static_cast<char>(length);
+            if (!SendAll(client, prefix, sizeLength) ||
+                !SendAll(client, body.data(), shape.body_size) ||
+                !SendAll(client, "\r\n", 2)) {
+                return false;
+            }
+        }
+
+        std::string trailer = "0\r\ngrpc-status: " + status + "\r\n";
+        if (shape.grpc_status != 0) {
+            trailer += "grpc-message: stub%20status%20" + status + "\r\n";
+        }
+        trailer += "\r\n";
+        return SendAll(client, trailer.data(), trailer.size());
+    }
+
+    // Reads and drops length body bytes; bytes past them stay in buffer
+    bool DiscardBody(Socket client, std::string& buffer, uint64_t length) {
+        char chunk[16 * 1024];
+        uint64_t discarded = std::min<uint64_t>(length, buffer.size());
+        buffer.erase(0, static_cast<size_t>(discarded));
+        while (discarded < length) {
+            int received = recv(client, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                return false;
+            }
+            size_t bodyBytes = static_cast<size_t>(std::min<uint64_t>(static_cast<uint64_t>(received), length - discarded));
+            discarded += bodyBytes;
+            buffer.append(chunk + bodyBytes, received - bodyBytes);
+        }
+        bodyBytesReceived.fetch_add(length, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Takes the next CRLF-terminated line out of buffer
+    bool ReadLine(Socket client, std::string& buffer, std::string& line) {
+        char chunk[4096];
+        size_t lineEnd;
+        while ((lineEnd = buffer.find("\r\n")) == std::string::npos) {
+            int received = recv(client, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                return false;
+            }
+            buffer.append(chunk, received);
+        }
+        line = buffer.substr(0, lineEnd);
+        buffer.erase(0, lineEnd + 2);
+        return true;
+    }
+
+    // Drops a chunked body and keeps its trailer section for LastRequestTrailers
+    bool DiscardChunkedBody(Socket client, std::string& buffer) {
+        std::string line;
+        for (;;) {
+            if (!ReadLine(client, buffer, line)) {
+                return false;
+            }
+            uint64_t chunkSize = std::strtoull(line.c_str(), nullptr, 16);
+            if (chunkSize == 0) {
+                break;
+            }
+            if (!DiscardBody(client, buffer, chunkSize) || !ReadLine(client, buffer, line)) {
+                return false;
+            }
+        }
+
+        std::string trailers;
+        while (ReadLine(client, buffer, line)) {
+            if (line.empty()) {
+                std::lock_guard<std::mutex> lock(trailerMutex);
+                lastTrailers = trailers;
+                return true;
+            }
+            trailers += line + "\n";
+        }
+        return false;
+    }
+
+    void Disconnect(Socket client) {
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        clients.erase(client);
+        CloseSocket(client);  // Under the lock so Stop() never shuts down a reused descriptor
+        connectionsClosed.notify_all();  // Still under the lock, so Stop() cannot return while *this is in use
+    }
+
+    static std::string HeaderValue(const std::string& head, const char* name) {
+        size_t nameLength = std::strlen(name);
+        size_t position = head.find("\r\n");
+        while (position != std::string::npos) {
+            size_t lineStart = position + 2;
+            size_t lineEnd = head.find("\r\n", lineStart);
+            std::string line = head.substr(lineStart, lineEnd == std::string::npos ? std::string::npos : lineEnd - lineStart);
+            if (line.size() > nameLength && line[nameLength] == ':') {
+                bool match = true;
+                for (size_t i = 0; i < nameLength && match; i++) {
+                    match = std::tolower(static_cast<unsigned char>(line[i])) == name[i];
+                }
+                if (match) {
+                    size_t valueStart = line.find_first_not_of(' ', nameLength + 1);
+                    return valueStart == std::string::npos ? "" : line.substr(valueStart);
+                }
+            }
+            position = lineEnd;
+        }
+        return "";
+    }
+
+    static bool SendAll(Socket client, const char* data, size_t size) {
+        while (size > 0) {
+#ifdef _WIN32
+            int sent = send(client, data, static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+#else
+            ssize_t sent = send(client, data, size, MSG_NOSIGNAL);
+#endif
+            if (sent <= 0) {
+                return false;
+            }
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    static void ShutdownSocket(Socket socket) {
+        if (socket == kInvalidSocket) return;
+#ifdef _WIN32
+        shutdown(socket, SD_BOTH);
+#else
+        shutdown(socket, SHUT_RDWR);
+#endif
+    }
+
+    static void CloseSocket(Socket socket) {
+        if (socket == kInvalidSocket) return;
+#ifdef _WIN32
+        closesocket(socket);
+#else
+        close(socket);
+#endif
+    }
+
+    Options options;
+    std::string body;                                           // Shared response body; query sizes are clamped to it
+    Socket listenSocket = kInvalidSocket;
+    int boundPort = 0;
+    std::atomic<bool> running{false};
+    std::thread acceptThread;
+    std::mutex connectionMutex;
+    std::condition_variable connectionsClosed;
+    std::set<Socket> clients;
+    std::mutex capacityMutex;
+    std::condition_variable capacityFreed;
+    int capacity = 0;                                           // Guarded by capacityMutex
+    int busy = 0;                                               // Requests being processed
+    std::atomic<uint64_t> served{0};
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> bodyBytesReceived{0};
+    std::mutex trailerMutex;
+    std::string lastTrailers;                                   // Guarded by trailerMutex
+#ifdef _WIN32
+    bool wsaStarted = false;
+#endif
+};
+
+#endif // LOOPBACK_SERVER_HPP
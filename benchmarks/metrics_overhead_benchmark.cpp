@@ -0,0 +1,100 @@
+/**
+ * @file metrics_overhead_benchmark.cpp
+ * @brief Measures the per-request cost of NetworkMetrics with recording on and off
+ *
+ * Runs the exact bookkeeping Network::Request performs around each request
+ * (in-flight guard, enabled check, RecordRequest) on several threads without
+ * touching the network, and reports nanoseconds per request. A scrape runs
+ * concurrently in the "on" case to show that recording never waits on it.
+ *
+ * Build: link with NetworkMetrics.cpp and Network.cpp
+ */
+
+#include "Network.hpp"
+#include "NetworkMetrics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const int kThreads = 4;
+static const int kIterations = 2000000;
+
+// Mirrors the metrics bookkeeping in Network::Request
+static void simulateRequest(const std::string& host, Network::NetworkResponse& response) {
+    NetworkMetrics::InFlight inFlight;
+    if (NetworkMetrics::IsEnabled()) {
+        NetworkMetrics::RecordRequest(host, Network::Method::HTTP_GET, response, 128);
+    }
+}
+
+static double runThreads(bool scrapeConcurrently) {
+    std::atomic<bool> done{false};
+    std::thread scraper;
+    if (scrapeConcurrently) {
+        scraper = std::thread([&done]() {
+            while (!done) {
+                std::string exposition;
+                NetworkMetrics::RenderPrometheus(exposition);
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([t]() {
+            std::string host = "host" + std::to_string(t % 2) + ".example.com";
+            Network::NetworkResponse response;
+            response.success = true;
+            response.status_code = 200;
+            response.body.assign(512, 'x');
+            for (int i = 0; i < kIterations; i++) {
+                response.timings.start = std::chrono::steady_clock::now();
+                response.timings.last_byte = response.timings.start + std::chrono::microseconds(i % 5000);
+                simulateRequest(host, response);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    done = true;
+    if (scraper.joinable()) {
+        scraper.join();
+    }
+
+    // CPU time per request: wall time times the cores actually in use, over all requests
+    unsigned cores = std::max(1u, std::min<unsigned>(kThreads, std::thread::hardware_concurrency()));
+    double totalNs = std::chrono::duration<double, std::nano>(end - start).count();
+    return totalNs * cores / (static_cast<double>(kThreads) * kIterations);
+}
+
+int main() {
+    std::cout << "=== NetworkMetrics Overhead ===" << std::endl;
+    std::cout << kThreads << " threads x " << kIterations << " requests" << std::endl;
+
+    NetworkMetrics::SetEnabled(false);
+    double offNs = runThreads(false);
+    std::cout << "Metrics off: " << offNs << " ns/request" << std::endl;
+
+    NetworkMetrics::SetEnabled(true);
+    double onNs = runThreads(true);
+    std::cout << "Metrics on:  " << onNs << " ns/request (scraping every 10ms)" << std::endl;
+    std::cout << "Overhead:    " << (onNs - offNs) << " ns/request" << std::endl;
+
+    std::string exposition;
+    NetworkMetrics::RenderPrometheus(exposition);
+    std::cout << "\nExposition size: " << exposition.size() << " bytes" << std::endl;
+
+    LatencyHistogram histogram = NetworkMetrics::GetLatencyHistogram("host0.example.com", Network::Method::HTTP_GET);
+    std::cout << "host0 p50/p99/p999: " << histogram.Percentile(0.50) << "/"
+              << histogram.Percentile(0.99) << "/" << histogram.Percentile(0.999) << " us" << std::endl;
+    return 0;
+}
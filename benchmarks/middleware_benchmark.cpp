@@ -0,0 +1,69 @@
+/**
+ * @file middleware_benchmark.cpp
+ * @brief Compares a direct transport call with the same call through middleware pipelines
+ *
+ * Uses an in-memory transport that returns a canned response, so only the cost
+ * of the chain itself is measured. An empty Pipeline should be indistinguishable
+ * from calling the transport directly.
+ *
+ * Build: header-only apart from Network.cpp (for the Network types)
+ */
+
+#include "Network.hpp"
+#include "NetworkMiddleware.hpp"
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+
+static const int kIterations = 5000000;
+
+// Terminal that never touches the network
+struct StubTransport {
+    Network::NetworkResponse operator()(OutgoingRequest& request) const {
+        Network::NetworkResponse response;
+        response.success = true;
+        response.status_code = 200 + static_cast<int>(request.url.size() & 1);
+        return response;
+    }
+};
+
+template<typename Call>
+static double measure(Call&& call) {
+    OutgoingRequest request;
+    request.url = "https://api.example.com/v1/items";
+    request.config.oauth_token = "token";
+    request.config.additional_headers["Authorization"] = "Bearer token";
+    request.config.additional_headers["Accept"] = "application/json";
+
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+        sink = sink + call(request).status_code;
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / kIterations;
+}
+
+int main() {
+    std::cout << "=== Middleware Overhead ===" << std::endl;
+
+    StubTransport transport;
+    Pipeline<StubTransport> emptyChain;
+    Pipeline<StubTransport, AuthLayer, DefaultHeadersLayer> authChain(
+        StubTransport(), AuthLayer(), DefaultHeadersLayer(std::map<std::string, std::string>{ { "Accept", "application/json" } }));
+
+    // Warm up caches and branch predictors
+    measure([&](OutgoingRequest& request) { return transport(request); });
+
+    double direct = measure([&](OutgoingRequest& request) { return transport(request); });
+    double empty = measure([&](OutgoingRequest& request) { return emptyChain(request); });
+    double auth = measure([&](OutgoingRequest& request) { return authChain(request); });
+
+    std::cout << "Direct call:           " << direct << " ns/request" << std::endl;
+    std::cout << "Empty pipeline:        " << empty << " ns/request ("
+              << (empty - direct) << " ns overhead)" << std::endl;
+    std::cout << "Auth + headers layers: " << auth << " ns/request ("
+              << (auth - direct) << " ns overhead)" << std::endl;
+    return 0;
+}
@@ -334,9 +334,11 @@ private:
         std::cout << "\nLatency Test Results:" << std::endl;
         std::cout << std::setw(40) << std::left << "Endpoint"
                   << std::setw(15) << "Latency(ms)"
-                  << std::setw(15) << "Status"
+                  << std::setw(10) << "TTFB(ms)"
+                  << std::setw(8) << "Reused"
+                  << std::setw(10) << "Status"
                   << "Response Size" << std::endl;
-        std::cout << std::string(80, '-') << std::endl;
+        std::cout << std::string(100, '-') << std::endl;
 
         for (const auto& endpoint : endpoints) {
             auto start = std::chrono::high_resolution_clock::now();
@@ -344,9 +346,13 @@ private:
             auto end = std::chrono::high_resolution_clock::now();
             auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
 
+            auto ttfb = std::chrono::duration_cast<std::chrono::milliseconds>(response.timings.TimeToFirstByte());
+
             std::cout << std::setw(40) << std::left << endpoint
                       << std::setw(15) << duration.count()
-                      << std::setw(15) << response.status_code
+                      << std::setw(10) << ttfb.count()
+                      << std::setw(8) << (response.timings.connection_reused ? "yes" : "no")
+                      << std::setw(10) << response.status_code
                       << response.body.size() << " bytes" << std::endl;
 
             bool success = response.status_code == 200;
@@ -1,4 +1,5 @@
 #include "../net/Network.hpp"
+#include "../net/NetworkMiddleware.hpp"
 #include <iostream>
 #include <chrono>
 #include <thread>
@@ -13,6 +14,22 @@ double measureTime(Func&& func) {
     return std::chrono::duration<double, std::milli>(end - start).count();
 }
 
+// Helper function to convert a phase duration to milliseconds
+double toMs(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Helper function to print the per-phase breakdown of a response
+void printTimings(const Network::NetworkResponse& response) {
+    const auto& t = response.timings;
+    std::cout << "  dns " << toMs(t.Dns()) << "ms"
+              << ", connect " << toMs(t.Connect()) << "ms"
+              << ", tls " << toMs(t.Tls()) << "ms"
+              << ", ttfb " << toMs(t.TimeToFirstByte()) << "ms"
+              << ", download " << toMs(t.Download()) << "ms"
+              << (t.connection_reused ? " (reused connection)" : " (new connection)") << std::endl;
+}
+
 int main() {
     if (!Network::Initialize()) {
         std::cerr << "Failed to initialize network" << std::endl;
@@ -31,6 +48,7 @@ int main() {
             double time = measureTime([&]() {
                 auto response = Network::Get("https://api.github.com/zen");
                 std::cout << "Request " << i + 1 << " status: " << response.status_code << std::endl;
+                printTimings(response);
             });
             
             times.push_back(time);
@@ -96,11 +114,10 @@ int main() {
         config.retry_delay_ms = 1000;
         
         // Test with an unreliable endpoint
-        auto response = Network::Get("https://httpbin.org/status/500", config);
+        auto client = MakePipeline(RetryLayer());
+        auto response = client.Request(Network::Method::HTTP_GET, "https://httpbin.org/status/500", std::nullopt, config);
         std::cout << "Final status after retries: " << response.status_code << std::endl;
-        std::cout << "Attempts made: " << (response.headers.count("X-Retry-Count") ? 
-                                         response.headers.at("X-Retry-Count") : "unknown") 
-                  << std::endl;
+        std::cout << "Retries made: " << response.retries << std::endl;
     }
 
     // Parallel Connections Example
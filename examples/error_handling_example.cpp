@@ -84,7 +84,8 @@ int main() {
         Network::RequestConfig config;
         config.max_redirects = 2;  // Only allow 2 redirects
         auto response = Network::Get("https://httpbin.org/redirect/5", config);
-        printResponse(response);
+        printResponse(response);  // The third redirect, with "Too many redirects"
+        std::cout << "Redirects followed: " << response.redirects << " (stopped at " << response.final_url << ")" << std::endl;
     }
 
     Network::Cleanup();
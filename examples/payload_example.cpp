@@ -1,4 +1,7 @@
 #include "Network.hpp"
+#include "NetworkJsonWriter.hpp"
+#include "NetworkMultipart.hpp"
+#include <algorithm>
 #include <iostream>
 #include <map>
 
@@ -45,24 +48,29 @@ int main() {
     {
         std::cout << "\n=== JSON Payload Example ===" << std::endl;
         
-        // Create JSON payload
-        std::string jsonPayload = R"({
-            "user": {
-                "name": "John Doe",
-                "age": 30,
-                "email": "john@example.com",
-                "preferences": {
-                    "newsletter": true,
-                    "theme": "dark"
-                },
-                "interests": ["programming", "networking", "security"]
-            }
-        })";
+        // Serialize the payload straight into the request body
+        JsonWriter json;
+        json.BeginObject()
+            .Key("user").BeginObject()
+                .Key("name").String("John Doe")
+                .Key("age").Int(30)
+                .Key("email").String("john@example.com")
+                .Key("preferences").BeginObject()
+                    .Key("newsletter").Bool(true)
+                    .Key("theme").String("dark")
+                .EndObject()
+                .Key("interests").BeginArray();
+        for (const char* interest : { "programming", "networking", "security" }) {
+            json.String(interest);
+        }
+        json.EndArray()
+            .EndObject()
+        .EndObject();
         
         auto response = Network::Post(
             "https://httpbin.org/post",
-            jsonPayload,
-            "application/json"
+            json,
+            JsonWriter::ContentType()
         );
         
         std::cout << "JSON submission status: " << response.status_code << std::endl;
@@ -76,25 +84,20 @@ int main() {
         // Simulate file content
         std::string fileContent = "This is the content of the file\nLine 2\nLine 3";
         
-        // Create multipart form data
-        std::string boundary = "------------------------boundary123456789";
-        std::string multipartPayload = 
-            "--" + boundary + "\r\n"
-            "Content-Disposition: form-data; name=\"file\"; filename=\"test.txt\"\r\n"
-            "Content-Type: text/plain\r\n"
-            "\r\n" +
-            fileContent + "\r\n"
-            "--" + boundary + "--\r\n";
-        
-        Network::RequestConfig config;
-        config.additional_headers["Content-Type"] = "multipart/form-data; boundary=" + boundary;
-        
-        auto response = Network::Post(
-            "https://httpbin.org/post",
-            multipartPayload,
-            "",  // Content-Type is set in headers
-            config
-        );
+        // Compose the multipart body; parts are encoded while the request is sent.
+        // Use AddFile to stream a file from disk without loading it into memory.
+        NetworkMultipart form;
+        form.AddField("description", "Example upload");
+        form.AddStream("file", "test.txt", "text/plain",
+            [&fileContent, offset = size_t(0)](char* buffer, size_t capacity, size_t& bytesWritten) mutable {
+                bytesWritten = std::min(capacity, fileContent.size() - offset);
+                std::copy_n(fileContent.data() + offset, bytesWritten, buffer);
+                offset += bytesWritten;
+                return true;
+            },
+            fileContent.size());
+        
+        auto response = Network::Post("https://httpbin.org/post", form, form.ContentType());
         
         std::cout << "File upload status: " << response.status_code << std::endl;
         std::cout << "Response: " << response.body << std::endl;
@@ -60,7 +60,8 @@ int main() {
         
         std::cout << "\n=== Redirect Following Example ===" << std::endl;
         auto response = Network::Get("https://httpbin.org/redirect/3", config);
-        std::cout << "Final status: " << response.status_code << std::endl;
+        std::cout << "Final status: " << response.status_code << " from " << response.final_url
+                  << " after " << response.redirects << " redirects" << std::endl;
     }
 
     Network::Cleanup();
@@ -0,0 +1,51 @@
+#include "Network.hpp"
+#include "NetworkReplay.hpp"
+#include <iostream>
+#include <string>
+
+static void fetchAll() {
+    const char* urls[] = {
+        "https://httpbin.org/get",
+        "https://httpbin.org/bytes/2048",
+        "https://httpbin.org/status/404",
+    };
+    for (const char* url : urls) {
+        auto response = Network::Get(url);
+        std::cout << "  " << url << " -> " << response.status_code
+                  << " (" << response.body.size() << " bytes, "
+                  << response.timings.Total().count() / 1000000.0 << "ms)" << std::endl;
+    }
+}
+
+int main() {
+    if (!Network::Initialize()) {
+        std::cerr << "Failed to initialize network" << std::endl;
+        return 1;
+    }
+
+    // Record live traffic
+    std::cout << "=== Recording ===" << std::endl;
+    if (!NetworkReplay::StartRecording("traffic.nwtrace")) {
+        std::cerr << "Cannot create trace file" << std::endl;
+        return 1;
+    }
+    fetchAll();
+    NetworkReplay::StopRecording();
+
+    // Replay offline at 10x speed
+    std::cout << "\n=== Replaying at 10x ===" << std::endl;
+    std::string error;
+    if (!NetworkReplay::StartReplay("traffic.nwtrace", 10.0, error)) {
+        std::cerr << "Cannot load trace: " << error << std::endl;
+        return 1;
+    }
+    fetchAll();
+
+    // Unrecorded requests fail instead of reaching the network
+    auto missing = Network::Get("https://httpbin.org/uuid");
+    std::cout << "  Unrecorded: " << missing.error_message << std::endl;
+
+    NetworkReplay::StopReplay();
+    Network::Cleanup();
+    return 0;
+}
@@ -0,0 +1,55 @@
+// Build the library with NETWORK_ENABLE_TRACING=1 for the hooks to be invoked
+#include "Network.hpp"
+#include "NetworkTracing.hpp"
+#include <iostream>
+#include <memory>
+#include <vector>
+
+int main() {
+    if (!Network::Initialize()) {
+        std::cerr << "Failed to initialize network" << std::endl;
+        return 1;
+    }
+
+    if (!NetworkTracing::kEnabled) {
+        std::cout << "Tracing is compiled out; rebuild with NETWORK_ENABLE_TRACING=1" << std::endl;
+    }
+
+    auto tracer = std::make_shared<W3CTraceHook>(1024, "myvendor=client");
+    NetworkTracing::SetHook(tracer);
+
+    // New trace
+    {
+        std::cout << "=== New Trace ===" << std::endl;
+        auto response = Network::Get("https://httpbin.org/headers");
+        std::cout << "Status: " << response.status_code << std::endl;
+        std::cout << "Echoed headers: " << response.body << std::endl;
+    }
+
+    // Continue an incoming trace
+    {
+        std::cout << "\n=== Child Span ===" << std::endl;
+        Network::RequestConfig config;
+        config.additional_headers["traceparent"] = "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+        auto response = Network::Get("https://httpbin.org/headers", config);
+        std::cout << "Status: " << response.status_code << std::endl;
+    }
+
+    // Export recorded spans
+    {
+        std::cout << "\n=== Recorded Spans ===" << std::endl;
+        std::vector<TraceSpan> spans;
+        tracer->Drain(spans);
+        for (const auto& span : spans) {
+            std::cout << span.name << " trace=" << span.trace_id << " span=" << span.span_id
+                      << " parent=" << (span.parent_span_id.empty() ? "-" : span.parent_span_id)
+                      << " status=" << span.status_code
+                      << " total=" << span.timings.Total().count() / 1000000.0 << "ms" << std::endl;
+        }
+        std::cout << "Dropped spans: " << tracer->DroppedSpans() << std::endl;
+    }
+
+    NetworkTracing::SetHook(nullptr);
+    Network::Cleanup();
+    return 0;
+}